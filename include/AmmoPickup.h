@@ -16,10 +16,13 @@ public:
     const SDL_Rect& getRect();
     int getAmmo();
     const Weapon& getWeapon();
+    int getSpawnIndex();
+    void setSpawnIndex(const int spawn_index);
 
 private:
     SDL_Texture* texture;
     SDL_Rect rect;
+    int spawn_index = -1;
     int ammo;
     Weapon weapon;
 };
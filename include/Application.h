@@ -1,13 +1,29 @@
 #ifndef APPLICATION_H
 #define APPLICATION_H
 
-#include "Debug.h"
-
+#include "Log.h"
+#include "Profiler.h"
+#include "FlightRecorder.h"
+#include "FramePacer.h"
+#include "InputFrame.h"
+#include "Telemetry.h"
+#include "Memory.h"
+#include "Replay.h"
+#include "RenderSnapshot.h"
+#include "ResolutionScaler.h"
+#include "RotationCache.h"
+#include "SPSCQueue.h"
+#include "TripleBuffer.h"
+
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <map>
 #include <vector>
 #include <memory>
+#include <thread>
 
 #include <SDL.h>
 #include <SDL_image.h>
@@ -16,6 +32,8 @@
 
 #include <tinyxml2.h>
 
+class GlyphAtlas;
+
 /**
 * This namespace is used to contain all of the important game information. It is
 * responsible for handling resources, game states, and the main game loop.
@@ -32,7 +50,8 @@ namespace Application
         IMG,
         TTF,
         Mix,
-        XML
+        XML,
+        Level
     };
 
     /**
@@ -49,11 +68,52 @@ namespace Application
         virtual void shutDown() = 0;
     };
 
+    /**
+    * This struct holds how long each part of the last frame took, in microseconds. The
+    * frame time is from the start of the previous frame to the start of the last one, and
+    * the pacing error is how much later the last frame started than the frame rate limit
+    * had it due.
+    * Draw is the time spent recording the frame into a render snapshot, and present is
+    * the time spent drawing a snapshot and presenting it. When the game is threaded the
+    * snapshots are presented on the main thread, so present is the last time it took there.
+    * The draw calls, batches and culled sprites come from the last render snapshot, and
+    * the resolution scale is what its world was drawn at. The resolution budget is the
+    * frame time dynamic resolution keeps frames under, in milliseconds, or 0 if it is off.
+    * Input latency is how long the oldest input the last frame with input handled took to
+    * be presented, and aim latency is how long the mouse position the last frame where
+    * the mouse moved was drawn with took to be presented.
+    */
+    struct FrameTimings
+    {
+        float frame = 0.0;
+        float pacing_error = 0.0;
+        float events = 0.0;
+        float update = 0.0;
+        float draw = 0.0;
+        float present = 0.0;
+        int draw_calls = 0;
+        int batches = 0;
+        int culled = 0;
+        float resolution_scale = 1.0;
+        float resolution_budget = 0.0;
+        float input_latency = 0.0;
+        float aim_latency = 0.0;
+        int input_events = 0;
+        int mouse_motions = 0;
+    };
+
     /**
     * This typedef is a map of every state that can be in the game.
     */
     typedef std::map<std::string, std::shared_ptr<BaseState>> StateMap;
 
+    // The most events that can be waiting to be passed to the simulation thread.
+    const std::size_t EVENT_QUEUE_SIZE = 1024;
+
+    // How long, in milliseconds, the game waits for an event while it is idle before
+    // checking whether it should still be idle.
+    const int IDLE_WAIT_TIME = 250;
+
     /**
     * This anonymous namespace holds all of the objects and variables for the
     * game. It holds the window, renderer, resource maps, states and more. Functions
@@ -64,7 +124,7 @@ namespace Application
         // SDL objects.
         extern SDL_Window* window;
         extern SDL_Renderer* renderer;
-        extern SDL_Event event;
+        extern InputFrame input_frame;
         extern SDL_Point window_size;
         extern SDL_Point camera;
         extern SDL_Point mouse_position;
@@ -75,9 +135,21 @@ namespace Application
         extern std::shared_ptr<BaseState> current_state;
 
         // Resource maps.
-        extern std::map<std::string, SDL_Texture*> textures;
-        extern std::map<std::string, Mix_Chunk*> sounds;
-        extern std::map<std::string, std::map<int, TTF_Font*>> fonts;
+        extern Memory::Map<std::string, SDL_Texture*, Memory::Tag::Resource> textures;
+        extern Memory::Map<std::string, Mix_Chunk*, Memory::Tag::Resource> sounds;
+        extern Memory::Map<std::string, Memory::Map<int, TTF_Font*, Memory::Tag::Resource>, Memory::Tag::Resource> fonts;
+        extern Memory::Map<TTF_Font*, std::unique_ptr<GlyphAtlas>, Memory::Tag::Resource> glyph_atlases;
+
+        // Sprites. A sprite id is a texture's index in sprites, and ids that have been
+        // removed are reused.
+        extern Memory::Vector<SDL_Texture*, Memory::Tag::Resource> sprites;
+        extern Memory::Vector<std::uint16_t, Memory::Tag::Resource> free_sprites;
+        extern std::unique_ptr<RotationCache> rotation_cache;
+
+        // Resolution. The world is drawn into world_target when it is drawn at a lower
+        // resolution than the window.
+        extern ResolutionScaler resolution_scaler;
+        extern SDL_Texture* world_target;
 
         // Config variables.
         extern std::map<std::string, std::map<std::string, std::string>> config;
@@ -85,12 +157,47 @@ namespace Application
         extern std::vector<std::string> catagory_order;
         extern std::vector<std::string> setting_order;
 
+        // Threading. When the game is threaded, states are updated and drawn on the
+        // simulation thread, while the main thread handles SDL events and presents the
+        // render snapshots the simulation publishes.
+        extern bool threaded;
+        extern std::thread::id main_thread_id;
+        extern SPSCQueue<SDL_Event, EVENT_QUEUE_SIZE> event_queue;
+        extern TripleBuffer<RenderSnapshot> render_snapshots;
+        extern RenderSnapshot* render_snapshot;
+        extern std::atomic<std::uint64_t> tick;
+        extern std::atomic<std::uint64_t> oldest_drawable_tick;
+        extern std::atomic<float> present_time;
+
+        // Idling. While the game is paused, or its window is hidden or unfocused, nothing is
+        // updated and the game sleeps until an event arrives.
+        extern std::atomic<bool> paused;
+        extern std::atomic<bool> window_active;
+        extern std::atomic<bool> window_exposed;
+        extern bool pause_when_unfocused;
+
+        // Input latency. Times are SDL ticks, and 0 means there isn't one. The main thread
+        // keeps the newest mouse position it has seen in latest_mouse, packed with its time.
+        extern bool late_latch;
+        extern SDL_Point draw_mouse_position;
+        extern std::uint32_t input_time;
+        extern std::uint32_t mouse_time;
+        extern std::atomic<std::uint64_t> latest_mouse;
+        extern std::atomic<float> input_latency;
+        extern std::atomic<float> aim_latency;
+        extern std::uint64_t presented_tick;
+
         // Miscellaneous variables.
-        extern bool running;
+        extern std::atomic<bool> running;
         extern float delta_time;
         extern int frame_rate_limit;
+        extern FramePacer frame_pacer;
+        extern float fixed_delta_time;
+        extern bool headless;
         extern int frame_rate;
         extern std::string window_title;
+        extern FrameTimings frame_timings;
+        extern std::string render_dump_file;
     }
 
     /**
@@ -137,9 +244,53 @@ namespace Application
 
     /**
     * This function loads a texture and then caches it, so that the next time the texture is
-    * needed it is available immediately.
+    * needed it is available immediately. The file name is a string_view so that looking up a
+    * texture that is already cached never allocates.
+    */
+    SDL_Texture* getTexture(const std::string_view file_name);
+
+    /**
+    * This function turns an image that has already been loaded into a texture and caches
+    * it under its file name, unless that file is already cached. This lets images be
+    * decoded on another thread, since textures can only be made on the main thread.
+    */
+    SDL_Texture* addTexture(const std::string& file_name, SDL_Surface* surface);
+
+    /**
+    * This function returns roughly how much video memory a texture uses, assuming that
+    * every pixel takes four bytes.
+    */
+    std::int64_t getTextureBytes(SDL_Texture* texture);
+
+    /**
+    * This function returns the file name a texture was cached under, or an empty string
+    * if the texture isn't in the cache.
+    */
+    std::string getTextureName(SDL_Texture* texture);
+
+    /**
+    * This function gives a texture a sprite id, so that render snapshots can draw it.
+    * Every texture the Application namespace loads is given one, but textures made
+    * anywhere else have to be added here, and removed before they are destroyed. Both
+    * can only be done on the main thread.
     */
-    SDL_Texture* getTexture(const std::string& file_name);
+    std::uint16_t addSprite(SDL_Texture* texture);
+
+    /**
+    * This function frees a texture's sprite id so that it can be given to another texture.
+    */
+    void removeSprite(SDL_Texture* texture);
+
+    /**
+    * This function returns the texture for a sprite id.
+    */
+    SDL_Texture* getSprite(const std::uint16_t sprite);
+
+    /**
+    * This function returns a texture's sprite id, or RenderSnapshot::NO_SPRITE if it
+    * hasn't been added.
+    */
+    std::uint16_t getSpriteId(SDL_Texture* texture);
 
     /**
     * This function loads a sound and then caches it, so that the next time the sound is
@@ -154,6 +305,12 @@ namespace Application
     */
     TTF_Font* getFont(const std::string& file_name, const int font_size);
 
+    /**
+    * This function returns the glyph atlas for a font, creating it the first time it is
+    * needed. Since fonts are cached by name and size, there is one atlas for each of them.
+    */
+    GlyphAtlas& getGlyphAtlas(TTF_Font* font);
+
     /**
     * This function returns the game window.
     */
@@ -165,9 +322,10 @@ namespace Application
     SDL_Renderer* getRenderer();
 
     /**
-    * This function returns to the game's event.
+    * This function returns the input for this frame. States should handle it in their
+    * handleEvents method, which is called once a frame.
     */
-    const SDL_Event& getEvent();
+    const InputFrame& getInput();
 
     /**
     * This function returns an SDL_Point of the window's size.
@@ -179,6 +337,14 @@ namespace Application
     */
     const SDL_Point& getMousePosition();
 
+    /**
+    * This function returns the position of the mouse to draw with. With late latching it
+    * is read again just before the frame is drawn, so it can be newer than the position
+    * from getMousePosition. It isn't recorded in replays, so it must only be used for
+    * drawing and never to change the game.
+    */
+    const SDL_Point& getDrawMousePosition();
+
     /**
     * This function returns the game camera for drawing and editing.
     */
@@ -200,6 +366,112 @@ namespace Application
     */
     float getDeltaTime();
 
+    /**
+    * This function makes every frame step the game by the same amount of time, no matter
+    * how long the frame really took, so that the game plays out the same every time. A
+    * delta time of 0 goes back to using the real time between frames.
+    */
+    void setFixedDeltaTime(const float delta_time);
+
+    /**
+    * This function sets the most frames that are run each second. A limit of 0 runs frames
+    * as fast as possible.
+    */
+    void setFrameRateLimit(const int fps_limit);
+
+    /**
+    * This function hides the window and stops drawing anything, so that the game only
+    * updates. The renderer is still made, since levels need it to load.
+    */
+    void setHeadless(const bool headless);
+
+    /**
+    * This function sets whether states are updated on their own simulation thread, so
+    * that the simulation and drawing don't hold each other up. It must be set before run
+    * is called, and is ignored when the game is headless.
+    */
+    void setThreaded(const bool threaded);
+
+    /**
+    * This function sets whether the game stops updating and drawing while its window is
+    * hidden, minimised or doesn't have focus. It carries on as soon as the window is back.
+    */
+    void setPauseWhenUnfocused(const bool pause_when_unfocused);
+
+    /**
+    * This function pauses or unpauses the game. States are still drawn on the frame the
+    * game is paused, but aren't updated, and then the game sleeps until it is unpaused.
+    */
+    void setPaused(const bool paused);
+
+    /**
+    * This function returns true if the game is paused.
+    */
+    bool isPaused();
+
+    /**
+    * This function sets whether the mouse is read again just before each frame is drawn,
+    * after the frame rate limit and the update, rather than only when its events are
+    * handled. It makes what is drawn follow the mouse more closely without drawing more
+    * often. Replays are always drawn with the mouse from their events.
+    */
+    void setLateLatch(const bool late_latch);
+
+    /**
+    * This function sets how many angles rotated sprites are rendered at ahead of time, so
+    * that they can be drawn without being rotated every frame. This is much faster with
+    * SDL's software renderer. An angle count of 0 turns it off, and every rotated sprite
+    * is rotated as it is drawn.
+    */
+    void setSpriteRotations(const int angle_count);
+
+    /**
+    * This function sets the resolution the world is drawn at, as a fraction of the window's,
+    * while the weapon icon and the interface are always drawn at the window's resolution.
+    * If the budget is more than 0, the scale changes between min_scale and max_scale to
+    * keep the time each frame takes under the budget, in milliseconds. It must be called
+    * on the main thread before run is called.
+    */
+    void setResolutionScale(const float max_scale, const float min_scale, const float budget);
+
+    /**
+    * This function runs a task on the main thread and waits for it to finish. Anything
+    * that uses the renderer, like making textures, has to be run this way, since the
+    * renderer can only be used from the main thread. Errors thrown by the task are thrown
+    * again on the calling thread. On the main thread the task is just run.
+    */
+    void runOnMainThread(const std::function<void()>& task);
+
+    /**
+    * This function draws a texture on a layer, rotated about its centre by an angle in
+    * degrees clockwise. Like every function below, it records a command into the frame's
+    * render snapshot rather than drawing straight away, and it can only be used while a
+    * state is drawing.
+    */
+    void drawTexture(const RenderSnapshot::Layer layer, SDL_Texture* texture, const SDL_Rect& destination, const float angle = 0.0);
+
+    /**
+    * This function draws triangles from a texture on a layer, such as a line of text.
+    */
+    void drawGeometry(const RenderSnapshot::Layer layer, SDL_Texture* texture, const SDL_Vertex* vertices, const int vertex_count,
+                      const int* indices, const int index_count);
+
+    /**
+    * This function draws filled rects in one colour on a layer, blended by the colour's alpha.
+    */
+    void fillRects(const RenderSnapshot::Layer layer, const SDL_Rect* rects, const int count, const SDL_Color& colour);
+
+    /**
+    * This function draws a line in one colour on a layer.
+    */
+    void drawLine(const RenderSnapshot::Layer layer, const SDL_Point& start, const SDL_Point& end, const SDL_Color& colour);
+
+    /**
+    * This function writes the next frame's render snapshot to a file once it has been
+    * recorded, so that it can be looked at or drawn again by the RenderBenchmark tool.
+    */
+    void dumpRenderSnapshot(const std::string& file_name);
+
     /**
     * This function ends the game by stopping the main loop.
     */
@@ -219,6 +491,11 @@ namespace Application
     * This function gets the current frame rate for the game.
     */
     int getFrameRate();
+
+    /**
+    * This function returns how long each part of the last frame took.
+    */
+    const FrameTimings& getFrameTimings();
 }
 
 #endif // APPLICATION_H
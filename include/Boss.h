@@ -11,8 +11,9 @@ public:
 
 private:
     static constexpr float ATTACK_TIME = 1.0;
+    static constexpr int VOLLEY_SIZE = 3;
+    static constexpr int VOLLEY_SPREAD = 25;
 
-    float attack_timer = 0.0;
 };
 
 #endif // BOSS_H
@@ -2,13 +2,18 @@
 #define ENEMY_H
 
 #include "Application.h"
+#include "Maths.h"
 #include "Tools.h"
 
-#include <deque>
-
 class Level;
 class Player;
 
+/**
+* This type is a path of tiles for an enemy to follow, with the next tile at the back.
+* It is a vector rather than a deque so that its memory is kept when it is refilled.
+*/
+typedef Memory::Vector<SDL_Point, Memory::Tag::Path> TilePath;
+
 /**
 * This class is a base class for every enemy in the game. It handles health
 * and AI.
@@ -22,8 +27,22 @@ public:
     Enemy(const SDL_Rect& rect, SDL_Texture* texture, const int speed, const int health);
 
     /**
-    * This method needs to know about the level and where the player is. This
-    * method handles all collisions and AI (not pathfinding however).
+    * This method spots the player and follows the enemy's path. It fills in the points the
+    * enemy faces from and towards, which are its centre, the centre of the next node in its
+    * path and the centre of the player, so that Level::update can work out the directions
+    * for every enemy at once.
+    */
+    void think(Level* level, Player& player, Maths::Vec2& centre, Maths::Vec2& node_centre, Maths::Vec2& player_centre);
+
+    /**
+    * This method sets which way the enemy faces and moves, from the directions to the points
+    * that think filled in.
+    */
+    void setDirections(const Maths::Vec2& node_direction, const Maths::Vec2& player_direction);
+
+    /**
+    * This method moves the enemy and handles its collisions. think and setDirections have to
+    * be called first.
     */
     virtual void update(Level* level, Player& player);
 
@@ -47,6 +66,37 @@ public:
     */
     const SDL_Rect& getRect();
 
+    /**
+    * This struct holds everything about an enemy that changes while a level is being
+    * played, so that it can be saved and restored. spawn_index is the object in the
+    * level file that the enemy was spawned from.
+    */
+    struct State
+    {
+        int spawn_index;
+        SDL_Rect rect, node_rect;
+        int health;
+        float ai_time, ai_timer, attack_timer;
+        bool alerted, dead, facing_player;
+        Maths::Vec2 facing, normal;
+        std::vector<SDL_Point> path;
+    };
+
+    /**
+    * This method gets the current state of the enemy.
+    */
+    State getState();
+
+    /**
+    * This method sets the state of the enemy.
+    */
+    void setState(const State& state);
+
+    /**
+    * This method sets which object in the level file the enemy was spawned from.
+    */
+    void setSpawnIndex(const int spawn_index);
+
 protected:
     static const int NODE_SIZE = 10;
     static constexpr float AI_TIME_MINIMUM = 0.3;
@@ -55,17 +105,19 @@ protected:
     int speed;
     int health;
     float ai_time, ai_timer = 0.0;
+    float attack_timer = 0.0;
+    int spawn_index = -1;
     bool alerted = false;
     bool dead = false;
-    int angle = 0;
     bool facing_player = false;
+    bool moving = false;
 
     SDL_Texture* texture;
     SDL_Rect rect, node_rect;
-    std::deque<SDL_Point> current_path;
-    Tools::FloatVector normal = {0.0, 0.0};
-
-    int x1, y1, x2, y2;
+    TilePath current_path;
+    Memory::Vector<SDL_Rect, Memory::Tag::Enemy> solids;
+    Maths::Vec2 facing = {1.0, 0.0};
+    Maths::Vec2 normal = {0.0, 0.0};
 };
 
 #endif // ENEMY_H
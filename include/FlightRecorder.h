@@ -0,0 +1,62 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include "Profiler.h"
+
+#include <string>
+#include <string_view>
+
+/**
+* This namespace keeps the zones and counters of the last few hundred frames recorded by
+* the profiler in a ring buffer. When a frame takes longer than the frame budget the ring
+* is written to a file, in the same Chrome trace format as a profiler capture, along with
+* notes about what the game was doing (such as the current level). Recording a frame only
+* copies it into the ring, so it is always on. Writing the ring copies it and the notes,
+* and a writer thread writes the copy, so the game doesn't wait on the file during the
+* frame that was already too slow. Nothing is recorded if PROFILER_ENABLED isn't defined.
+*/
+namespace FlightRecorder
+{
+    const int FRAME_COUNT = 300;
+    const int MAX_ZONES = 48;
+    const int MAX_COUNTERS = 16;
+
+    /**
+    * This function sets how long a frame can take, in milliseconds, before the recorder is
+    * written to a file. A budget of 0 turns dumping off.
+    */
+    void setFrameBudget(const float milliseconds);
+
+    /**
+    * This function sets a note that is written with the recorder, such as the current level.
+    * Changing a note that is already set doesn't allocate unless the value gets longer.
+    * It can be called from any thread.
+    */
+    void setNote(const std::string_view name, const std::string_view value);
+
+    /**
+    * This function adds a frame to the ring, replacing the oldest frame. If the frame is
+    * over budget the ring is written to a file, unless it was already written within the
+    * last FRAME_COUNT frames.
+    */
+    void recordFrame(const Profiler::Frame& frame);
+
+    /**
+    * This function starts the writer thread, which writes the recorder to a file whenever
+    * it is dumped. Until it is started, dumps are written on the thread that asks for them.
+    */
+    void startUp();
+
+    /**
+    * This function copies every frame in the ring and the notes, and queues the copy to
+    * be written to a file. If the last dump is still being written this one is skipped.
+    */
+    void dump(const std::string& file_name);
+
+    /**
+    * This function writes any queued dump and stops the writer thread.
+    */
+    void shutDown();
+}
+
+#endif // FLIGHTRECORDER_H
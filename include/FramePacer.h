@@ -0,0 +1,71 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <SDL.h>
+
+/**
+* This class holds frames to a steady rate using SDL's performance counter. Each frame is
+* due a whole number of periods after the schedule started, rather than a period after the
+* last frame, so that a frame that starts a little late doesn't push every frame after it
+* back. The wait until a frame is due is mostly slept, a millisecond at a time, and the
+* last part is spun, since a sleep can overshoot by a whole scheduler quantum. How long a
+* sleep really takes is tracked, so that the pacer only spins for as long as it needs to
+* on the machine it runs on. When the game falls more than a frame behind, the schedule is
+* started again instead of running frames back to back to catch up.
+*/
+class FramePacer
+{
+public:
+    /**
+    * This method sets how many frames should run each second. A rate of 0 runs frames as
+    * fast as possible.
+    */
+    void setRate(const int frame_rate);
+
+    /**
+    * This method starts the schedule again, so that the next frame is due a period from now.
+    * It should be called after the game has stopped running frames for a while.
+    */
+    void reset();
+
+    /**
+    * This method waits until the next frame is due.
+    */
+    void wait();
+
+    /**
+    * This method returns how late, in microseconds, the last frame started compared to when
+    * it was due.
+    */
+    float getError() const;
+
+    /**
+    * This method returns how many times the game has fallen so far behind that the
+    * schedule was started again.
+    */
+    int getMissedFrames() const;
+
+private:
+    /**
+    * This method records how long a one millisecond sleep took, in microseconds.
+    */
+    void addSleep(const double sleep_time);
+
+    // How much of each new sleep time goes into the averages.
+    static constexpr double SMOOTHING = 0.05;
+
+    // How many deviations longer than the average a sleep has to be allowed to take before
+    // the pacer spins instead.
+    static constexpr double SLEEP_DEVIATIONS = 3.0;
+
+    double ticks_per_microsecond = 0.0;
+    double period = 0.0;
+    Uint64 schedule_start = 0;
+    Uint64 frame_index = 0;
+    double sleep_average = 2000.0;
+    double sleep_deviation = 500.0;
+    float error = 0.0;
+    int missed_frames = 0;
+};
+
+#endif // FRAMEPACER_H
@@ -0,0 +1,44 @@
+#ifndef GAMESNAPSHOT_H
+#define GAMESNAPSHOT_H
+
+#include "Level.h"
+#include "Player.h"
+#include "Projectile.h"
+
+/**
+* This struct is a snapshot of everything that changes while a level is played. It is
+* kept in memory for checkpoints, so that respawning doesn't have to load the level
+* again, and it can be written to a file for quicksaves.
+*/
+struct GameSnapshot
+{
+    std::string level_file;
+    Player::State player;
+    Level::State level;
+    std::vector<Projectile::State> projectiles;
+
+    /**
+    * This method writes the snapshot to a file. Textures are stored by the file name
+    * they were loaded from.
+    */
+    void write(const std::string& file_name) const;
+
+    /**
+    * This method writes the snapshot to a stream, in the same format as a snapshot file.
+    */
+    void write(std::ostream& file) const;
+
+    /**
+    * This method returns a 64 bit FNV-1a hash of the snapshot, as it would be written to
+    * a file. Two snapshots with the same hash are the same down to the last bit.
+    */
+    std::uint64_t getHash() const;
+
+    /**
+    * This method reads a snapshot from a file. It returns false if the file doesn't
+    * exist or isn't a snapshot from this version of the game.
+    */
+    bool read(const std::string& file_name);
+};
+
+#endif // GAMESNAPSHOT_H
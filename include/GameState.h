@@ -2,31 +2,75 @@
 #define GAMESTATE_H
 
 #include "Application.h"
+#include "GameSnapshot.h"
 #include "Level.h"
+#include "LevelLoader.h"
+#include "PerfOverlay.h"
 #include "Player.h"
 #include "Projectile.h"
+#include "Text.h"
 
 class GameState : public Application::BaseState
 {
 public:
+    /**
+    * This constructor plays the levels in Resources/Levels/Levels.xml.
+    */
+    GameState() = default;
+
+    /**
+    * This constructor plays the given levels instead of the normal level sequence.
+    */
+    explicit GameState(const std::vector<std::string>& level_sequence);
+
     void startUp() override;
     void handleEvents() override;
     void update() override;
     void draw() override;
     void shutDown() override;
 
+    /**
+    * This method switches to a level in the level sequence and starts prefetching the
+    * level after it.
+    */
+    void changeLevel(const int index);
+
 private:
     void updateWindowTitle();
 
+    /**
+    * This method takes a snapshot of the player, the level and every projectile.
+    */
+    GameSnapshot takeSnapshot();
+
+    /**
+    * This method puts the game back to how it was when a snapshot was taken. The level
+    * is only loaded again if the snapshot is from a different level.
+    */
+    void restoreSnapshot(const GameSnapshot& snapshot);
+
 private:
     static constexpr float TITLE_UPDATE_TIME = 1.0;
     static constexpr float BFS_UPDATE_TIME = 0.5;
+    static constexpr int SHOTGUN_PELLETS = 5;
+    static constexpr int SHOTGUN_SPREAD = 25;
+    static constexpr const char* QUICKSAVE_FILE = "quicksave.sav";
+    static constexpr const char* TRACE_FILE = "trace.json";
+    static constexpr const char* RENDER_DUMP_FILE = "frame.rcmd";
 
     Level level;
+    LevelLoader level_loader;
+    std::vector<std::string> level_sequence;
+    int level_index = 0;
     Player player;
-    std::vector<Projectile> projectiles;
+    ProjectileVector projectiles;
+    GameSnapshot checkpoint;
+    PerfOverlay perf_overlay;
+    Text pause_text{Application::getFont("Resources/Fonts/GameFont.ttf", 48), "Paused", Application::getWindowSize().x / 2,
+                    Application::getWindowSize().y / 2, true};
     float fps_timer = 0.0;
     float ai_timer = 0.0;
+    std::string window_title;
 
     std::vector<SDL_Rect> solids;
 };
@@ -0,0 +1,64 @@
+#ifndef GLYPHATLAS_H
+#define GLYPHATLAS_H
+
+#include "Application.h"
+
+/**
+* This class renders every printable ASCII character of a font into a single texture
+* once, so that text can be drawn from the cached glyphs without rendering with
+* SDL_ttf or creating textures. An atlas should be got from Application::getGlyphAtlas
+* so that there is only one for each font and size.
+*/
+class GlyphAtlas
+{
+public:
+    /**
+    * This struct is where a glyph is in the atlas texture and how to place it.
+    */
+    struct Glyph
+    {
+        SDL_Rect source;
+        int advance;
+    };
+
+    static const char FIRST_GLYPH = ' ';
+    static const char LAST_GLYPH = '~';
+
+    GlyphAtlas(TTF_Font* font);
+    ~GlyphAtlas();
+
+    GlyphAtlas(const GlyphAtlas&) = delete;
+    GlyphAtlas& operator=(const GlyphAtlas&) = delete;
+
+    /**
+    * This method returns a glyph. Characters that aren't in the atlas are drawn as '?'.
+    */
+    const Glyph& getGlyph(const char character) const;
+
+    /**
+    * This method returns the distance to move the pen between two characters, including
+    * any kerning between them.
+    */
+    int getAdvance(const char previous, const char character) const;
+
+    /**
+    * This method returns the distance between two lines of text.
+    */
+    int getLineSkip() const;
+
+    SDL_Texture* getTexture() const;
+    int getWidth() const;
+    int getHeight() const;
+
+private:
+    static const int ATLAS_WIDTH = 512;
+
+    TTF_Font* font;
+    SDL_Texture* texture = nullptr;
+    int width = ATLAS_WIDTH;
+    int height = 0;
+    int line_skip = 0;
+    Glyph glyphs[LAST_GLYPH - FIRST_GLYPH + 1];
+};
+
+#endif // GLYPHATLAS_H
@@ -10,10 +10,13 @@ public:
     void draw();
     SDL_Rect& getRect();
     int getHealth();
+    int getSpawnIndex();
+    void setSpawnIndex(const int spawn_index);
 
 private:
     SDL_Texture* texture;
     SDL_Rect rect;
+    int spawn_index = -1;
     int health;
 };
 
@@ -12,7 +12,6 @@ public:
 private:
     static constexpr float ATTACK_TIME = 1.0;
 
-    float attack_timer = 0.0;
     SDL_Rect melee_rect;
 };
 
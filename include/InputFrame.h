@@ -0,0 +1,76 @@
+#ifndef INPUTFRAME_H
+#define INPUTFRAME_H
+
+#include "Memory.h"
+
+#include <SDL.h>
+
+/**
+* This class is the input for one frame. The event queue is drained into it once a frame,
+* and every mouse motion event is folded into where the mouse ended up and how far it moved
+* over the frame, since gaming mice can send thousands of motion events a second and only
+* the last one matters. Every other event, such as keys, mouse buttons and the wheel, is
+* kept in the order it happened. Its memory is kept when it is cleared, so that draining
+* the queue doesn't allocate.
+*/
+class InputFrame
+{
+public:
+    /**
+    * This method empties the input for a new frame, starting from where the mouse was at
+    * the end of the last one.
+    */
+    void clear(const SDL_Point& mouse_position);
+
+    /**
+    * This method adds an event to the frame.
+    */
+    void add(const SDL_Event& event);
+
+    /**
+    * This method returns every event that isn't mouse motion, in the order they happened.
+    */
+    const Memory::Vector<SDL_Event, Memory::Tag::General>& getEvents() const;
+
+    /**
+    * This method returns true if the mouse moved during the frame.
+    */
+    bool hasMouseMotion() const;
+
+    /**
+    * This method returns a single motion event that stands for all of the frame's motion.
+    * It has the final position and time of the mouse, and the relative motion of every
+    * motion event added together.
+    */
+    const SDL_Event& getMouseMotion() const;
+
+    /**
+    * This method returns where the mouse was at the end of the frame.
+    */
+    SDL_Point getMousePosition() const;
+
+    /**
+    * This method returns how far the mouse moved over the frame.
+    */
+    SDL_Point getMouseDelta() const;
+
+    /**
+    * This method returns how many events were added, including the motion events that
+    * were folded together.
+    */
+    int getEventCount() const;
+
+    /**
+    * This method returns how many mouse motion events were added.
+    */
+    int getMotionCount() const;
+
+private:
+    SDL_Point start_position = {0, 0};
+    SDL_Event mouse_motion = {};
+    int event_count = 0;
+    int motion_count = 0;
+    Memory::Vector<SDL_Event, Memory::Tag::General> events;
+};
+
+#endif // INPUTFRAME_H
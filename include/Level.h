@@ -3,6 +3,9 @@
 
 #include "Application.h"
 #include "Tools.h"
+#include "LevelFile.h"
+#include "LevelCook.h"
+#include "Navigation.h"
 #include "AmmoPickup.h"
 #include "HealthPickup.h"
 #include "Zombie.h"
@@ -21,6 +24,48 @@
 */
 typedef AmmoPickup WeaponPickup;
 
+/**
+* This type is a vector whose memory is counted as part of the level.
+*/
+template <typename T>
+using LevelVector = Memory::Vector<T, Memory::Tag::Level>;
+
+/**
+* This struct holds everything about a level that doesn't change while it is being
+* played: the level file, the walls, the grid used for pathfinding, the paths from the
+* player's start and the decoded tile images. It doesn't use the renderer, so it can be
+* made on any thread (see Level::prepare and LevelLoader).
+*/
+struct LevelLayout
+{
+    std::string file_name;
+    LevelFile::Data data;
+    Navigation::Grid grid;
+    std::vector<SDL_Rect> wall_rects;
+
+    // The tile the player starts on and a breadth first search from it.
+    SDL_Point start_tile = {-1, -1};
+    std::vector<int> start_paths;
+
+    // The image for every tile used in the level, ready to be turned into textures.
+    std::map<std::string, SDL_Surface*> tile_surfaces;
+
+    /**
+    * This destructor frees the tile images.
+    */
+    ~LevelLayout();
+};
+
+/**
+* This struct is a checkpoint in a level. When the player reaches it the game is saved
+* in memory, and the player respawns from there when they die.
+*/
+struct Checkpoint
+{
+    SDL_Rect rect;
+    int spawn_index;
+};
+
 /**
 * This class loads a level from a file. It renders the level into a single
 * texture for drawing and also loads all of the information needed for a level, such
@@ -32,12 +77,30 @@ public:
     /**
     * This method loads all of the data for a level from a file. It does not
     * render the level, it only parses the file and gathers all of the information
-    * needed to render the level.
+    * needed to render the level. Both ".lvl" and compiled ".lvlb" files can be loaded.
     */
     void load(const std::string& file_name);
 
     /**
-    * This method renders the level so that it can be drawn to the screen.
+    * This method loads everything about a level that doesn't need the renderer. It can
+    * be called from any thread.
+    */
+    static std::shared_ptr<const LevelLayout> prepare(const std::string& file_name);
+
+    /**
+    * This method switches to a level made by prepare. It spawns the level's enemies and
+    * pickups, but like load it doesn't render the level.
+    */
+    void setLayout(std::shared_ptr<const LevelLayout> layout);
+
+    /**
+    * This method returns the layout of the current level.
+    */
+    std::shared_ptr<const LevelLayout> getLayout();
+
+    /**
+    * This method renders the level so that it can be drawn to the screen. Tile images
+    * decoded by prepare are turned into textures here.
     */
     void render();
 
@@ -71,41 +134,74 @@ public:
     */
     const std::vector<SDL_Rect>& getWallRects();
 
+    /**
+    * This method returns whether or not a line between two points, in pixels, misses
+    * every wall in the level.
+    */
+    bool hasLineOfSight(const SDL_Point& from, const SDL_Point& to);
+
+    /**
+    * This method removes every projectile that has hit a wall.
+    */
+    void removeProjectilesInWalls(ProjectileVector& projectiles);
+
     /**
     * This method returns a vector of every ammo pickup in the level.
     */
-    std::vector<AmmoPickup>& getAmmoPickups();
+    LevelVector<AmmoPickup>& getAmmoPickups();
 
     /**
     * This method returns a vector of every weapon pickup in the level.
     */
-    std::vector<WeaponPickup>& getWeaponPickups();
+    LevelVector<WeaponPickup>& getWeaponPickups();
 
     /**
     * This method returns a vector of every health pickup in the level.
     */
-    std::vector<HealthPickup>& getHealthPickups();
+    LevelVector<HealthPickup>& getHealthPickups();
 
     /**
     * This method returns a vector of every enemy in the level.
     */
-    std::vector<std::shared_ptr<Enemy>>& getEnemies();
+    LevelVector<std::shared_ptr<Enemy>>& getEnemies();
 
     /**
     * This method returns a vector of all projectiles fired by enemies.
     */
-    std::vector<Projectile>& getEnemyProjectiles();
+    ProjectileVector& getEnemyProjectiles();
 
     /**
-    * This destructor is needed to destroy the current map texture.
+    * This method returns a vector of every checkpoint in the level that hasn't been reached.
     */
-    ~Level();
+    LevelVector<Checkpoint>& getCheckpoints();
+
+    /**
+    * This struct holds everything about a level that changes while it is being played,
+    * so that it can be saved and restored. Pickups and checkpoints can't change, so only
+    * the objects in the level file that they were spawned from are stored.
+    */
+    struct State
+    {
+        std::vector<int> objects;
+        std::vector<Enemy::State> enemies;
+        std::vector<Projectile::State> enemy_projectiles;
+    };
+
+    /**
+    * This method gets the current state of the level.
+    */
+    State getState();
+
+    /**
+    * This method sets the state of the level. The layout of the level must be the one
+    * the state was taken from.
+    */
+    void setState(const State& state);
 
     /**
-    * This method generates the grid used for pathfinding. It simply makes a grid
-    * which stores walls and non-walls.
+    * This destructor is needed to destroy the current map texture.
     */
-    void generateAIGrid();
+    ~Level();
 
     /**
     * This method generates a map of every tile in the grid. Any point in this map
@@ -114,21 +210,32 @@ public:
     void breadthFirstSearch(const SDL_Point& start_tile);
 
     /**
-    * This method returns a list of each tile from end_tile to start_tile.
+    * This method returns how long the last breadth first search took, in microseconds.
+    */
+    float getBFSTime();
+
+    /**
+    * This method returns how many tiles the last breadth first search reached.
     */
-    std::deque<SDL_Point> getPathToTile(const SDL_Point& end_tile);
+    int getBFSTilesReached();
+
+    /**
+    * This method fills path with each tile from end_tile to start_tile. The path is
+    * filled in place so that its memory can be reused.
+    */
+    void getPathToTile(const SDL_Point& end_tile, TilePath& path);
 
 private:
     /**
     * This method processes all of the objects in the level, such as weapon pickups
     * and player starting position.
     */
-    void processObjects(std::string& object_text);
+    void processObjects();
 
     /**
-    * This method processes all of the layers in the level.
+    * This method spawns a single object from the level file.
     */
-    void processLayers(std::string& layer_text);
+    void spawnObject(const int index);
 
     /**
     * This method just clears all of the previous level data such
@@ -136,39 +243,38 @@ private:
     */
     void clearPreviousLevelData();
 
-    /**
-    * This method checks an individual tile in the AI grid and sees if
-    * it is traversable. If it is, and it has not been visited before,
-    * it adds it the came_from map.
-    */
-    void checkTile(std::queue<SDL_Point>& frontier, const int x, const int y, const int orig_x, const int orig_y);
-
 public:
     static const int TILE_SIZE = 50;
 
 private:
-    SDL_Texture* map_texture;
+    SDL_Texture* map_texture = nullptr;
     SDL_Rect map_rect;
 
     // Map data.
-    std::string file_name;
-    std::string title;
-    int width, height;
-    std::vector<std::vector<std::string>> map_data;
+    std::shared_ptr<const LevelLayout> layout;
 
     // Object data.
     SDL_Rect player_rect;
-    std::vector<SDL_Rect> wall_rects;
-    std::vector<AmmoPickup> ammo_pickups;
-    std::vector<WeaponPickup> weapon_pickups;
-    std::vector<HealthPickup> health_pickups;
-    std::vector<std::shared_ptr<Enemy>> enemies;
-    std::vector<Projectile> enemy_projectiles;
+    LevelVector<AmmoPickup> ammo_pickups;
+    LevelVector<WeaponPickup> weapon_pickups;
+    LevelVector<HealthPickup> health_pickups;
+    LevelVector<std::shared_ptr<Enemy>> enemies;
+
+    // The points every enemy faces between and the directions to them, kept between frames
+    // so that they don't have to allocate every time.
+    Memory::Vector<Maths::Vec2, Memory::Tag::Enemy> enemy_centres;
+    Memory::Vector<Maths::Vec2, Memory::Tag::Enemy> node_centres;
+    Memory::Vector<Maths::Vec2, Memory::Tag::Enemy> player_centres;
+    Memory::Vector<Maths::Vec2, Memory::Tag::Enemy> node_directions;
+    Memory::Vector<Maths::Vec2, Memory::Tag::Enemy> player_directions;
+    ProjectileVector enemy_projectiles;
+    LevelVector<Checkpoint> checkpoints;
 
     // AI data.
-    std::vector<std::vector<char>> grid;
-    std::map<std::pair<int, int>, std::pair<int, int>> came_from;
+    std::vector<int> came_from;
     SDL_Point start_tile;
+    float bfs_time = 0.0;
+    int bfs_tiles_reached = 0;
 };
 
 #endif // LEVEL_H
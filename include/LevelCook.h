@@ -0,0 +1,85 @@
+#ifndef LEVELCOOK_H
+#define LEVELCOOK_H
+
+#include "LevelFile.h"
+#include "Navigation.h"
+
+/**
+* This namespace builds, reads and writes cooked level data. Cooked data is what loading
+* a level would otherwise work out from its tiles: the merged wall rects, the walkable
+* grid and the paths from the player's start. It is stored in a sidecar file next to the
+* level (see getSidecarName), with the walkable grid packed into one bit per tile.
+*/
+namespace LevelCook
+{
+    /**
+    * This value in start_directions means that the tile can't be reached from the start.
+    */
+    const std::uint8_t UNREACHABLE = 0xFF;
+
+    /**
+    * This struct is all of the cooked data for one level.
+    */
+    struct Data
+    {
+        std::uint64_t level_hash = 0;
+        Navigation::Grid grid;
+
+        // Wall rects, in tiles.
+        std::vector<SDL_Rect> walls;
+
+        // The player's start and the direction (see Navigation::getDirection) each tile
+        // was reached from in a breadth first search from it.
+        SDL_Point start_tile = {-1, -1};
+        std::vector<std::uint8_t> start_directions;
+    };
+
+    /**
+    * This function returns the name of the sidecar file for a level. The same sidecar is
+    * used for both the ".lvl" and ".lvlb" versions of a level.
+    */
+    std::string getSidecarName(const std::string& level_file_name);
+
+    /**
+    * This function hashes the tiles and objects of a level, so that a sidecar that was
+    * cooked from a different version of the level is not used.
+    */
+    std::uint64_t hashLevel(const LevelFile::Data& level);
+
+    /**
+    * This function returns the tile the player starts on, which is the first player
+    * object in the level, or (-1, -1) if there isn't one.
+    */
+    SDL_Point findStart(const LevelFile::Data& level);
+
+    /**
+    * This function works out all of the cooked data for a level.
+    */
+    void cook(const LevelFile::Data& level, Data& cooked);
+
+    /**
+    * This function turns the stored paths from the player's start back into a came_from
+    * map, exactly as Navigation::breadthFirstSearch would have made it.
+    */
+    void getStartPaths(const Data& cooked, std::vector<int>& came_from);
+
+    /**
+    * This function checks that a level and the data cooked from it can be played. It
+    * returns a list of problems, which is empty if the level is fine.
+    */
+    std::vector<std::string> validate(const LevelFile::Data& level, const Data& cooked);
+
+    /**
+    * This function writes cooked data to a file.
+    */
+    void write(const std::string& file_name, const Data& cooked);
+
+    /**
+    * This function reads cooked data for a level. It returns false if there is no sidecar,
+    * if it was cooked from a different version of the level or if it is corrupt, so that
+    * the data is worked out from the level instead.
+    */
+    bool read(const std::string& file_name, const LevelFile::Data& level, Data& cooked);
+}
+
+#endif // LEVELCOOK_H
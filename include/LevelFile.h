@@ -0,0 +1,162 @@
+#ifndef LEVELFILE_H
+#define LEVELFILE_H
+
+#include "Application.h"
+
+#include <cstdint>
+
+/**
+* This namespace reads and writes level files. A level can either be stored in the
+* hand-written XML format (".lvl") or in the compiled binary format (".lvlb"). Binary
+* levels are memory mapped and their tile layers are used in place, so they do not
+* need to be parsed at all.
+*/
+namespace LevelFile
+{
+    /**
+    * This class memory maps a whole file as read only. The file stays mapped until the
+    * object is destroyed.
+    */
+    class MappedFile
+    {
+    public:
+        MappedFile(const std::string& file_name);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+        * This method returns the start of the mapped file.
+        */
+        const char* getData() const;
+
+        /**
+        * This method returns the size of the mapped file in bytes.
+        */
+        std::size_t getSize() const;
+
+    private:
+        const char* data = nullptr;
+        std::size_t size = 0;
+
+#ifdef _WIN32
+        void* file_handle = nullptr;
+        void* mapping_handle = nullptr;
+#endif // _WIN32
+    };
+
+    /**
+    * This struct is a single object in a level, such as the player's start, an
+    * enemy or a pickup. The type is the character used in the objects section of a
+    * ".lvl" file (see "Map Items.txt").
+    */
+    struct Object
+    {
+        int x, y;
+        char type;
+    };
+
+    /**
+    * This struct holds everything that is stored in a level file. The tiles are stored
+    * as one plane of width * height bytes per layer, one byte per tile. The planes either
+    * live in tile_buffer or, for binary levels, directly inside the mapped file.
+    */
+    struct Data
+    {
+        std::string title;
+        int width = 0;
+        int height = 0;
+        int layer_count = 0;
+        std::vector<Object> objects;
+
+        std::vector<char> tile_buffer;
+        std::shared_ptr<MappedFile> mapping;
+        std::size_t mapping_offset = 0;
+
+        /**
+        * This method returns the start of a tile layer. The layer is stored row by row.
+        */
+        const char* getLayer(const int layer) const;
+
+        /**
+        * This method returns a single tile from a layer.
+        */
+        char getTile(const int layer, const int x, const int y) const;
+    };
+
+    /**
+    * This is the header at the start of every binary level. All of the offsets are in
+    * bytes from the start of the file. The layers are stored back to back straight after
+    * each other and the object table is an array of BinaryObject. Everything is stored
+    * in the byte order of the machine that compiled the level.
+    */
+    struct BinaryHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t layer_count;
+        std::uint32_t object_count;
+        std::uint32_t title_offset;
+        std::uint32_t title_length;
+        std::uint32_t layers_offset;
+        std::uint32_t objects_offset;
+    };
+
+    /**
+    * This is a single entry in the object table of a binary level.
+    */
+    struct BinaryObject
+    {
+        std::uint32_t x;
+        std::uint32_t y;
+        char type;
+        char padding[3];
+    };
+
+    const char BINARY_MAGIC[4] = {'L', 'V', 'L', 'B'};
+    const std::uint32_t BINARY_VERSION = 1;
+    const char BINARY_EXTENSION[] = ".lvlb";
+
+    /**
+    * This function returns whether or not a file name is a binary level.
+    */
+    bool isBinary(const std::string& file_name);
+
+    /**
+    * This function loads a level, picking the format from the file's extension.
+    */
+    void load(const std::string& file_name, Data& data);
+
+    /**
+    * This function parses a hand-written ".lvl" file.
+    */
+    void loadText(const std::string& file_name, Data& data);
+
+    /**
+    * This function maps a ".lvlb" file into memory. Nothing is copied except for the
+    * title and the object table, the tile layers are read straight from the mapping.
+    */
+    void loadBinary(const std::string& file_name, Data& data);
+
+    /**
+    * This function writes level data out as a hand-written style ".lvl" file, in the
+    * same layout that loadText reads.
+    */
+    void writeText(const std::string& file_name, const Data& data);
+
+    /**
+    * This function writes level data out as a ".lvlb" file.
+    */
+    void writeBinary(const std::string& file_name, const Data& data);
+
+    /**
+    * This function loads a level sequence. This is an XML file that lists the file of
+    * every level in the order they are played in.
+    */
+    std::vector<std::string> loadSequence(const std::string& file_name);
+}
+
+#endif // LEVELFILE_H
@@ -0,0 +1,59 @@
+#ifndef LEVELGENERATOR_H
+#define LEVELGENERATOR_H
+
+#include "LevelFile.h"
+
+#include <cstdint>
+
+/**
+* This namespace generates levels for stress testing. Levels are made of rooms joined by
+* corridors, or a single open room, with walls scattered through the rooms and a chosen
+* number of each enemy. Everything is worked out from a seed, so the same settings always
+* make exactly the same level.
+*/
+namespace LevelGenerator
+{
+    const int MIN_SIZE = 8;
+    const int MAX_SIZE = 4096;
+    const std::uint32_t DEFAULT_SEED = 12345;
+
+    /**
+    * This struct holds the settings for a generated level. A room_count of 0 makes one open
+    * room that fills the whole level. wall_density is the chance of a floor tile inside a
+    * room being a wall, and pickup_density is the chance of a floor tile having a pickup.
+    */
+    struct Settings
+    {
+        std::string title = "Generated Level";
+        int width = 64;
+        int height = 64;
+        std::uint32_t seed = DEFAULT_SEED;
+
+        float wall_density = 0.1;
+        int room_count = 0;
+        int min_room_size = 6;
+        int max_room_size = 16;
+        int corridor_width = 2;
+
+        int zombies = 0;
+        int demons = 0;
+        int hounds = 0;
+        int bosses = 0;
+        float pickup_density = 0.0;
+    };
+
+    /**
+    * This function generates a level. Every floor tile that can't be reached from the
+    * player's start is filled in, so that the level passes the level cooker's checks. An
+    * error is thrown if the settings are out of range or there isn't room for every object.
+    */
+    void generate(const Settings& settings, LevelFile::Data& data);
+
+    /**
+    * This function generates a level and writes it out, as a ".lvl" file or as a binary
+    * level if the file name ends in ".lvlb".
+    */
+    void write(const std::string& file_name, const Settings& settings);
+}
+
+#endif // LEVELGENERATOR_H
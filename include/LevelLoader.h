@@ -0,0 +1,47 @@
+#ifndef LEVELLOADER_H
+#define LEVELLOADER_H
+
+#include "Level.h"
+
+#include <future>
+
+/**
+* This class loads levels in the background. The next level can be prefetched while
+* the current one is being played, so that switching to it only has to spawn its
+* objects and render it.
+*/
+class LevelLoader
+{
+public:
+    /**
+    * This method starts preparing a level on another thread. If a different level is
+    * already being prepared, it is finished and thrown away first.
+    */
+    void prefetch(const std::string& file_name);
+
+    /**
+    * This method returns whether or not a level has finished being prefetched.
+    */
+    bool isReady(const std::string& file_name);
+
+    /**
+    * This method returns a prepared level. If the level was prefetched it waits for it
+    * to finish, otherwise it is prepared right away on this thread. Errors from the other
+    * thread are thrown here.
+    */
+    std::shared_ptr<const LevelLayout> get(const std::string& file_name);
+
+    /**
+    * This destructor waits for any level that is still being prepared.
+    */
+    ~LevelLoader();
+
+private:
+    std::string file_name;
+    std::future<std::shared_ptr<const LevelLayout>> future;
+
+    // SDL errors are per thread, so the error from the loading thread is kept here.
+    std::string error;
+};
+
+#endif // LEVELLOADER_H
@@ -0,0 +1,163 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+
+// Comment out if no logging is wanted.
+#define LOG_ENABLED
+
+// The lowest level of message that is compiled in (0 is Trace, 4 is Error). Messages
+// below this level are removed completely, so their arguments aren't even worked out.
+#define LOG_LEVEL 1
+
+#ifdef LOG_ENABLED
+    #define LOG(level, category, out) \
+        do \
+        { \
+            if (Log::isEnabled(Log::Level::level, Log::Category::category)) \
+            { \
+                Log::Message log_message(Log::Level::level, Log::Category::category); \
+                log_message.getStream() << out; \
+            } \
+        } while (false)
+#else
+    #define LOG(level, category, out) do {} while (false)
+#endif // LOG_ENABLED
+
+#if LOG_LEVEL <= 0
+    #define LOG_TRACE(category, out) LOG(Trace, category, out)
+#else
+    #define LOG_TRACE(category, out) do {} while (false)
+#endif
+
+#if LOG_LEVEL <= 1
+    #define LOG_DEBUG(category, out) LOG(Debug, category, out)
+#else
+    #define LOG_DEBUG(category, out) do {} while (false)
+#endif
+
+#if LOG_LEVEL <= 2
+    #define LOG_INFO(category, out) LOG(Info, category, out)
+#else
+    #define LOG_INFO(category, out) do {} while (false)
+#endif
+
+#if LOG_LEVEL <= 3
+    #define LOG_WARNING(category, out) LOG(Warning, category, out)
+#else
+    #define LOG_WARNING(category, out) do {} while (false)
+#endif
+
+#if LOG_LEVEL <= 4
+    #define LOG_ERROR(category, out) LOG(Error, category, out)
+#else
+    #define LOG_ERROR(category, out) do {} while (false)
+#endif
+
+/**
+* This namespace is the game's logger. Messages are formatted straight into a fixed size,
+* lock-free ring buffer on the thread that logs them, and a writer thread writes them to
+* the console, so logging never waits on the console. Any thread can log. If the ring is
+* full the message is dropped instead of waiting for room, and messages are cut short if
+* they are longer than MAX_MESSAGE_LENGTH. Use the LOG_* macros instead of Message.
+*/
+namespace Log
+{
+    /**
+    * This enum contains every level, from the most verbose to the most important.
+    */
+    enum class Level
+    {
+        Trace,
+        Debug,
+        Info,
+        Warning,
+        Error
+    };
+
+    /**
+    * This enum contains every category. Count is the number of categories and isn't a category itself.
+    */
+    enum class Category
+    {
+        General,
+        Resource,
+        Level,
+        Save,
+        Diagnostics,
+        Count
+    };
+
+    const int MAX_MESSAGE_LENGTH = 256;
+
+    /**
+    * This function returns the name of a level.
+    */
+    const char* getName(const Level level);
+
+    /**
+    * This function returns the name of a category.
+    */
+    const char* getName(const Category category);
+
+    /**
+    * This function finds a level from its name, ignoring case. It returns false if there
+    * isn't a level with that name.
+    */
+    bool getLevelFromName(const std::string_view name, Level& level);
+
+    /**
+    * This function sets the lowest level that is logged. Levels below LOG_LEVEL are
+    * compiled out, so they can't be turned back on here.
+    */
+    void setLevel(const Level level);
+
+    /**
+    * This function turns a category on or off.
+    */
+    void setCategoryEnabled(const Category category, const bool enabled);
+
+    /**
+    * This function returns whether or not messages of a level and category are logged.
+    */
+    bool isEnabled(const Level level, const Category category);
+
+    /**
+    * This function starts the writer thread. Messages logged before this are kept until
+    * it starts, as long as the ring doesn't fill up.
+    */
+    void startUp();
+
+    /**
+    * This function writes every message that is left and stops the writer thread.
+    */
+    void shutDown();
+
+    /**
+    * This class is a single message. It claims a slot in the ring when it is made, the
+    * message is formatted into the slot through getStream, and it is handed to the writer
+    * thread when the message is destroyed.
+    */
+    class Message
+    {
+    public:
+        Message(const Level level, const Category category);
+        ~Message();
+
+        Message(const Message&) = delete;
+        Message& operator=(const Message&) = delete;
+
+        /**
+        * This method returns the stream that formats into the message.
+        */
+        std::ostream& getStream();
+
+    private:
+        std::uint64_t position;
+        bool claimed;
+    };
+}
+
+#endif // LOG_H
@@ -0,0 +1,108 @@
+#ifndef MATHS_H
+#define MATHS_H
+
+#include <cstddef>
+
+#include <SDL.h>
+
+/**
+* This namespace holds the vector maths used to move and aim everything in the game.
+* Directions are kept as unit vectors rather than angles, so moving towards something
+* never needs any trigonometry. An angle is only worked out when something is drawn,
+* because that is what SDL needs to rotate a texture.
+*/
+namespace Maths
+{
+    /**
+    * This struct is a 2D vector, such as a position, a direction or a velocity.
+    */
+    struct Vec2
+    {
+        float x, y;
+    };
+
+    inline Vec2 operator+(const Vec2& a, const Vec2& b)
+    {
+        return {a.x + b.x, a.y + b.y};
+    }
+
+    inline Vec2 operator-(const Vec2& a, const Vec2& b)
+    {
+        return {a.x - b.x, a.y - b.y};
+    }
+
+    inline Vec2 operator*(const Vec2& vector, const float scale)
+    {
+        return {vector.x * scale, vector.y * scale};
+    }
+
+    /**
+    * This function turns a point into a vector.
+    */
+    inline Vec2 toVec2(const SDL_Point& point)
+    {
+        return {static_cast<float>(point.x), static_cast<float>(point.y)};
+    }
+
+    /**
+    * This struct holds eight vectors with their x and y parts kept apart, so that the
+    * batch functions can work on all eight at once with SIMD.
+    */
+    struct alignas(16) Vec2x8
+    {
+        static constexpr std::size_t SIZE = 8;
+
+        float x[SIZE];
+        float y[SIZE];
+    };
+
+    /**
+    * This function returns a vector with a length of 1 pointing the same way. A vector
+    * with no length stays that way rather than becoming NaN.
+    */
+    Vec2 normalize(const Vec2& vector);
+
+    /**
+    * This function returns the unit vector pointing from one point to another, or a
+    * vector with no length if they are the same point.
+    */
+    Vec2 getDirection(const Vec2& from, const Vec2& to);
+
+    /**
+    * This function returns the unit vector for a whole number of degrees clockwise, which
+    * can be given to rotate. It comes from a table, so it doesn't need any trigonometry.
+    */
+    Vec2 getRotation(const int degrees);
+
+    /**
+    * This function rotates a vector by a rotation from getRotation.
+    */
+    Vec2 rotate(const Vec2& vector, const Vec2& rotation);
+
+    /**
+    * This function returns the angle of a direction in degrees clockwise, for drawing.
+    * Nothing but drawing should need this.
+    */
+    float getAngle(const Vec2& direction);
+
+    /**
+    * These functions are the same as the ones above, but work on eight vectors at once.
+    */
+    void normalize(Vec2x8& vectors);
+    void getDirections(const Vec2x8& from, const Vec2x8& to, Vec2x8& directions);
+    void rotate(Vec2x8& vectors, const Vec2x8& rotations);
+
+    /**
+    * These functions work on arrays of any length, eight vectors at a time.
+    */
+    void normalize(Vec2* vectors, const std::size_t count);
+    void getDirections(const Vec2* from, const Vec2* to, Vec2* directions, const std::size_t count);
+
+    /**
+    * This function rotates one vector by a number of degrees for each of count vectors,
+    * such as the spread of every projectile in a volley.
+    */
+    void rotate(const Vec2& vector, const int* degrees, Vec2* rotated, const std::size_t count);
+}
+
+#endif // MATHS_H
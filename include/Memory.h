@@ -0,0 +1,188 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <vector>
+
+/**
+* This namespace keeps track of how much memory the game uses. Every heap allocation goes
+* through the global operator new, which is replaced so that each allocation is tagged
+* with what it is for. An allocation's tag comes from the container it is in if the
+* container uses Memory::Allocator, and otherwise from the innermost TagScope on that
+* thread. Memory that isn't on the heap, like textures, can be added with addExternal.
+*/
+namespace Memory
+{
+    /**
+    * This enum contains every tag. Count is the number of tags and isn't a tag itself.
+    */
+    enum class Tag
+    {
+        General,
+        Level,
+        Enemy,
+        Path,
+        Projectile,
+        Resource,
+        Texture,
+        Text,
+        Render,
+        Count
+    };
+
+    /**
+    * This struct holds the memory used by a tag, in bytes, and how many allocations it
+    * has made in total.
+    */
+    struct Stats
+    {
+        std::int64_t live;
+        std::int64_t peak;
+        std::uint64_t allocations;
+    };
+
+    /**
+    * This function returns the name of a tag.
+    */
+    const char* getName(const Tag tag);
+
+    /**
+    * This function allocates memory on the heap under a tag.
+    */
+    void* allocate(const std::size_t size, const Tag tag);
+
+    /**
+    * This function frees memory allocated by allocate. The tag it was allocated under
+    * is stored with it.
+    */
+    void deallocate(void* memory);
+
+    /**
+    * This function returns the tag that allocations on this thread are made under, unless
+    * they are made through an Allocator.
+    */
+    Tag getCurrentTag();
+
+    /**
+    * This function adds memory that isn't on the heap to a tag, such as the memory used
+    * by a texture. A negative amount removes it again.
+    */
+    void addExternal(const Tag tag, const std::int64_t bytes);
+
+    /**
+    * This function returns how much memory a tag is using.
+    */
+    Stats getStats(const Tag tag);
+
+    /**
+    * This function returns how much memory is being used by every tag together.
+    */
+    Stats getTotalStats();
+
+    /**
+    * This function ends the current frame and starts counting allocations for the next one.
+    * If an allocation test is running, it fails if the frame allocated once warmed up.
+    */
+    void endFrame();
+
+    /**
+    * This function returns how many allocations were made during the last frame, on any thread.
+    */
+    std::uint32_t getFrameAllocations();
+
+    /**
+    * This function writes how much memory every tag is using.
+    */
+    void writeReport(std::ostream& out);
+
+    /**
+    * This function starts an allocation test. After warmup_frames frames, any frame that
+    * allocates fails the test. The test finishes after another test_frames frames.
+    */
+    void startAllocationTest(const int warmup_frames, const int test_frames);
+
+    /**
+    * This function returns whether or not the allocation test has finished.
+    */
+    bool isAllocationTestFinished();
+
+    /**
+    * This function returns whether or not the allocation test has failed.
+    */
+    bool hasAllocationTestFailed();
+
+    /**
+    * This class sets the tag for every allocation on this thread that isn't made through a
+    * Memory::Allocator, until it is destroyed.
+    */
+    class TagScope
+    {
+    public:
+        TagScope(const Tag tag);
+        ~TagScope();
+
+        TagScope(const TagScope&) = delete;
+        TagScope& operator=(const TagScope&) = delete;
+
+    private:
+        Tag previous_tag;
+    };
+
+    /**
+    * This class is an allocator for standard containers that tags everything the container
+    * allocates.
+    */
+    template <typename T, Tag TAG>
+    class Allocator
+    {
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind
+        {
+            typedef Allocator<U, TAG> other;
+        };
+
+        Allocator() = default;
+
+        template <typename U>
+        Allocator(const Allocator<U, TAG>&)
+        {
+        }
+
+        T* allocate(const std::size_t count)
+        {
+            return static_cast<T*>(Memory::allocate(count * sizeof(T), TAG));
+        }
+
+        void deallocate(T* memory, const std::size_t)
+        {
+            Memory::deallocate(memory);
+        }
+
+        template <typename U>
+        bool operator==(const Allocator<U, TAG>&) const
+        {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const Allocator<U, TAG>&) const
+        {
+            return false;
+        }
+    };
+
+    template <typename T, Tag TAG>
+    using Vector = std::vector<T, Allocator<T, TAG>>;
+
+    // Maps use a transparent comparison, so they can be searched without making a key.
+    template <typename Key, typename Value, Tag TAG>
+    using Map = std::map<Key, Value, std::less<>, Allocator<std::pair<const Key, Value>, TAG>>;
+}
+
+#endif // MEMORY_H
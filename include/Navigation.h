@@ -0,0 +1,69 @@
+#ifndef NAVIGATION_H
+#define NAVIGATION_H
+
+#include "LevelFile.h"
+
+#include <cstdint>
+
+/**
+* This namespace holds the data derived from a level's tiles that is used for
+* collision and pathfinding. It is used both by the game and by the level cooker,
+* so that cooked data is always identical to data built at load time.
+*/
+namespace Navigation
+{
+    /**
+    * This value in a came_from map means that the tile has not been reached.
+    */
+    const int UNVISITED = -1;
+
+    /**
+    * This struct is the grid used for pathfinding. It stores one byte per tile, which
+    * is 1 if the tile can be walked on and 0 if there is a wall on it.
+    */
+    struct Grid
+    {
+        int width = 0;
+        int height = 0;
+        std::vector<std::uint8_t> walkable;
+
+        /**
+        * This method returns whether or not a tile can be walked on. Tiles outside of
+        * the grid can never be walked on.
+        */
+        bool isWalkable(const int x, const int y) const;
+    };
+
+    /**
+    * This function builds the grid for a level. A tile is a wall if it is a wall on
+    * any layer.
+    */
+    void buildGrid(const LevelFile::Data& data, Grid& grid);
+
+    /**
+    * This function merges the walls in the grid into as few rects as possible. The rects
+    * are in tiles, not pixels. Rows of walls are joined first, then rows with the same
+    * span are joined downwards.
+    */
+    std::vector<SDL_Rect> mergeWalls(const Grid& grid);
+
+    /**
+    * This function runs a breadth first search over the grid from start_tile. Every
+    * reached tile in came_from holds the index (y * width + x) of the tile it was reached
+    * from, and start_tile points to itself. It returns the number of tiles reached.
+    */
+    int breadthFirstSearch(const Grid& grid, const SDL_Point& start_tile, std::vector<int>& came_from);
+
+    /**
+    * This function returns the direction (0 to 7) of a neighbouring tile, in the order
+    * that breadthFirstSearch checks neighbours. It returns -1 if the tiles are not neighbours.
+    */
+    int getDirection(const SDL_Point& from, const SDL_Point& to);
+
+    /**
+    * This function returns the offset to a neighbouring tile for a direction.
+    */
+    SDL_Point getDirectionOffset(const int direction);
+}
+
+#endif // NAVIGATION_H
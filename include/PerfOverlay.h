@@ -0,0 +1,76 @@
+#ifndef PERFOVERLAY_H
+#define PERFOVERLAY_H
+
+#include "Application.h"
+#include "Text.h"
+
+/**
+* This class is an overlay that shows how long frames are taking. It has a graph of the
+* most recent frame times, frame time percentiles, how long each part of the frame took
+* and counts of what is in the level. Frame times are recorded even while the overlay is
+* hidden, so the graph is full as soon as it is shown. It also shows how much memory is
+* in use, how many allocations the last frame made and the resolution the world is drawn
+* at.
+*/
+class PerfOverlay
+{
+public:
+    /**
+    * This struct holds everything about the game that the overlay shows.
+    */
+    struct Stats
+    {
+        int enemies = 0;
+        int projectiles = 0;
+        int enemy_projectiles = 0;
+        int pickups = 0;
+        float bfs_time = 0.0;
+        int bfs_tiles_reached = 0;
+    };
+
+    PerfOverlay();
+
+    /**
+    * This method shows the overlay if it is hidden and hides it if it is shown.
+    */
+    void toggle();
+
+    /**
+    * This method records the last frame's time and, a few times a second, updates the text.
+    */
+    void update(const Stats& stats);
+
+    /**
+    * This method draws the overlay, if it is shown.
+    */
+    void draw();
+
+private:
+    /**
+    * This method returns a frame time percentile, in milliseconds, from sorted frame times.
+    */
+    float getPercentile(const float* sorted_times, const int count, const float percentile);
+
+private:
+    static constexpr int SAMPLE_COUNT = 240;
+    static const int BAR_WIDTH = 2;
+    static const int GRAPH_HEIGHT = 60;
+    static const int LINE_COUNT = 9;
+    static const int MARGIN = 10;
+    static constexpr float GRAPH_MAX_TIME = 50.0;
+    static constexpr float REFRESH_TIME = 0.25;
+
+    bool visible = false;
+    float frame_times[SAMPLE_COUNT] = {};
+    int next_sample = 0;
+    int sample_count = 0;
+    float refresh_timer = 0.0;
+    float target_frame_time;
+
+    Text text;
+    SDL_Rect panel_rect;
+    SDL_Rect graph_rect;
+    std::vector<SDL_Rect> bars;
+};
+
+#endif // PERFOVERLAY_H
@@ -2,6 +2,7 @@
 #define PLAYER_H
 
 #include "Application.h"
+#include "Maths.h"
 #include "Tools.h"
 #include "Text.h"
 #include "Weapon.h"
@@ -18,22 +19,17 @@ class Player
 public:
     Player();
 
-    /**
-    * This method respawns the player by resetting some attributes.
-    */
-    void respawn();
-
     /**
     * This method handles the key presses that are relevant to the player.
     * This mostly includes movement.
     */
-    void handleKeyPresses();
+    void handleKeyPresses(const SDL_Event& event);
 
     /**
     * This method handles the key releases that are relevant to the player.
     * This mostly includes movement.
     */
-    void handleKeyReleases();
+    void handleKeyReleases(const SDL_Event& event);
 
     /**
     * This method updates the player. It moves the player and also stops the player
@@ -58,9 +54,9 @@ public:
     SDL_Rect& getRect();
 
     /**
-    * This method changes the player's current weapon.
+    * This method changes the player's current weapon by how far the mouse wheel was turned.
     */
-    void changeWeapon();
+    void changeWeapon(const SDL_Event& event);
 
     /**
     * This method gets the player's current weapon.
@@ -114,15 +110,40 @@ public:
     void damage(const int damage);
 
     /**
-    * This method gets the player's angle.
+    * This method gets the direction the player is aiming in.
     */
-    int getAngle();
+    const Maths::Vec2& getAim();
 
     /**
     * This method checks if the player is dead.
     */
     bool isDead();
 
+    /**
+    * This struct holds the player's position, health and inventory, so that they can
+    * be saved and restored.
+    */
+    struct State
+    {
+        SDL_Rect rect;
+        int health;
+        std::map<Weapon, int> ammo;
+        std::vector<Weapon> weapons;
+        int weapon_index;
+        float shoot_delay;
+    };
+
+    /**
+    * This method gets the current state of the player.
+    */
+    State getState();
+
+    /**
+    * This method sets the state of the player and updates the HUD to match. The player
+    * stops moving and shooting until the keys and buttons are pressed again.
+    */
+    void setState(const State& state);
+
 private:
     /**
     * This method updates the ammo counter on the HUD.
@@ -134,6 +155,11 @@ private:
     */
     void updateHealthCount();
 
+    /**
+    * This method updates the weapon icon on the HUD.
+    */
+    void updateWeaponIcon();
+
 private:
     static const int SPEED = 450;
     static const int MAX_HEALTH = 100;
@@ -171,8 +197,8 @@ private:
 
     SDL_Texture* texture;
     SDL_Rect rect;
-    Tools::FloatVector movement;
-    int angle;
+    Maths::Vec2 movement = {0.0, 0.0};
+    Maths::Vec2 aim = {1.0, 0.0};
 
     // More stuff to do with weapons.
     bool shooting = false;
@@ -0,0 +1,160 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <SDL.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Comment out if no profiling is wanted.
+#define PROFILER_ENABLED
+
+#define PROFILER_CONCAT_INNER(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_INNER(a, b)
+
+#ifdef PROFILER_ENABLED
+    #define PROFILE_ZONE(name) Profiler::Zone PROFILER_CONCAT(profile_zone_, __LINE__)(name);
+    #define PROFILE_COUNTER(name, value) Profiler::setCounter(name, value);
+    #define PROFILE_COUNTER_ADD(name, amount) Profiler::addCounter(name, amount);
+    #define PROFILE_FRAME() Profiler::markFrame();
+    #define PROFILE_RESTART_FRAME() Profiler::restartFrame();
+#else
+    #define PROFILE_ZONE(name)
+    #define PROFILE_COUNTER(name, value)
+    #define PROFILE_COUNTER_ADD(name, amount)
+    #define PROFILE_FRAME()
+    #define PROFILE_RESTART_FRAME()
+#endif // PROFILER_ENABLED
+
+/**
+* This namespace times sections of a frame (zones) and keeps track of values that change
+* each frame (counters). It should be used through the macros above, so that it compiles
+* to nothing when PROFILER_ENABLED isn't defined. A capture can be started at any time,
+* which streams every frame to a Chrome trace file that can be opened in Perfetto or
+* chrome://tracing. Only one thread is profiled, the main thread unless setThread is used,
+* and zones on other threads are ignored.
+*/
+namespace Profiler
+{
+    /**
+    * This struct is a single timed zone. The times are performance counter ticks and depth
+    * is how many zones it is inside of.
+    */
+    struct ZoneEvent
+    {
+        const char* name;
+        std::uint64_t start;
+        std::uint64_t end;
+        int depth;
+    };
+
+    /**
+    * This struct is the value of a counter at the end of a frame.
+    */
+    struct CounterEvent
+    {
+        const char* name;
+        double value;
+    };
+
+    /**
+    * This struct is everything that was recorded during a frame.
+    */
+    struct Frame
+    {
+        std::uint64_t start = 0;
+        std::uint64_t end = 0;
+        std::vector<ZoneEvent> zones;
+        std::vector<CounterEvent> counters;
+    };
+
+    // Zones and counters past these limits in a single frame are dropped.
+    const std::size_t MAX_ZONES = 1024;
+    const std::size_t MAX_COUNTERS = 64;
+
+    /**
+    * This class times a zone from when it is created until it is destroyed. Zone names
+    * must be string literals, since only the pointer is stored.
+    */
+    class Zone
+    {
+    public:
+        Zone(const char* name);
+        ~Zone();
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        int index;
+    };
+
+    /**
+    * This function sets up the profiler. It must be called from the main thread before
+    * anything is profiled.
+    */
+    void startUp();
+
+    /**
+    * This function makes the thread that calls it the one that is profiled, such as when
+    * the game is updated on its own thread.
+    */
+    void setThread();
+
+    /**
+    * This function ends the current frame and starts the next one. If a capture is running
+    * the frame that just ended is written to it.
+    */
+    void markFrame();
+
+    /**
+    * This function throws away what has been recorded for the current frame and starts it
+    * again from now, so that time spent not running frames, such as while the game is idle,
+    * isn't counted as part of it.
+    */
+    void restartFrame();
+
+    /**
+    * This function sets the value of a counter for the current frame.
+    */
+    void setCounter(const char* name, const double value);
+
+    /**
+    * This function adds to the value of a counter for the current frame. Counters start
+    * every frame at 0.
+    */
+    void addCounter(const char* name, const double amount);
+
+    /**
+    * This function returns everything recorded during the last complete frame.
+    */
+    const Frame& getLastFrame();
+
+    /**
+    * This function returns the current time in performance counter ticks.
+    */
+    std::uint64_t getTime();
+
+    /**
+    * This function converts performance counter ticks to microseconds.
+    */
+    double toMicroseconds(const std::uint64_t ticks);
+
+    /**
+    * This function starts streaming frames to a Chrome trace file.
+    */
+    void startCapture(const std::string& file_name);
+
+    /**
+    * This function finishes the trace file of the current capture.
+    */
+    void stopCapture();
+
+    /**
+    * This function returns whether or not a capture is running.
+    */
+    bool isCapturing();
+}
+
+#endif // PROFILER_H
@@ -2,6 +2,8 @@
 #define PROJECTILE_H
 
 #include "Application.h"
+#include "Maths.h"
+#include "Random.h"
 #include "Tools.h"
 
 /**
@@ -12,8 +14,34 @@ class Projectile
 public:
     /**
     * Create a projectile with a texture, a start position, a set damage, a speed and a spread.
+    * The direction must be a unit vector, and the spread is in degrees either side of it. The
+    * spread is drawn from the given stream, so that the player's and the enemies' shots don't
+    * change each other.
     */
-    Projectile(SDL_Texture* texture, const int x, const int y, const int direction, const int damage, const int speed, const int spread);
+    Projectile(SDL_Texture* texture, const int x, const int y, const Maths::Vec2& direction, const int damage, const int speed, const int spread,
+               const Random::Stream stream);
+
+    /**
+    * This struct holds everything about a projectile, so that it can be saved and restored.
+    */
+    struct State
+    {
+        SDL_Texture* texture;
+        SDL_Rect rect;
+        Maths::Vec2 normal;
+        int damage;
+        int speed;
+    };
+
+    /**
+    * Create a projectile from a saved state.
+    */
+    Projectile(const State& state);
+
+    /**
+    * This method gets the current state of the projectile.
+    */
+    State getState();
 
     /**
     * This method updates the pojectile.
@@ -38,10 +66,14 @@ public:
 private:
     SDL_Texture* texture;
     SDL_Rect rect;
-    Tools::FloatVector normal;
+    Maths::Vec2 normal;
     int damage;
     int speed;
-    int angle;
 };
 
+/**
+* This type is a vector of projectiles. Its memory is counted under the projectile tag.
+*/
+typedef Memory::Vector<Projectile, Memory::Tag::Projectile> ProjectileVector;
+
 #endif // PROJECTILE_H
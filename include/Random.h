@@ -0,0 +1,86 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+* This namespace holds the game's random numbers. Each part of the game draws from its own
+* stream, so that, for example, the spread of the player's shots doesn't change the spread
+* of the boss's volleys. Streams are only independent of each other's draws though, so
+* anything the player does that changes what the enemies do, such as killing one or being
+* seen by one, still changes the numbers they draw. Every stream is seeded from one seed,
+* so a game can be played again exactly.
+*/
+namespace Random
+{
+    /**
+    * This enum contains every stream. Count is the number of streams and isn't a stream itself.
+    */
+    enum class Stream
+    {
+        PlayerSpread,
+        AI,
+        Spawns,
+        EnemySpread,
+        Count
+    };
+
+    /**
+    * This class is a PCG32 random number generator. It is small, fast and can be split
+    * into independent streams that never overlap, by giving each one a different stream
+    * number with the same seed.
+    */
+    class Generator
+    {
+    public:
+        Generator(const std::uint64_t seed = 0, const std::uint64_t stream = 0);
+
+        /**
+        * This method restarts the generator from a seed and stream.
+        */
+        void seed(const std::uint64_t seed, const std::uint64_t stream);
+
+        /**
+        * This method returns the next 32 random bits.
+        */
+        std::uint32_t next();
+
+        /**
+        * This method returns a random number from a range, including both ends.
+        */
+        int getInt(const int from, const int to);
+
+        /**
+        * This method fills an array with random numbers from a range, including both ends.
+        * This is quicker than calling getInt for each one, such as for every pellet in a volley.
+        */
+        void getInts(int* values, const std::size_t count, const int from, const int to);
+
+        /**
+        * This method returns a random number from a range, including from but not to.
+        */
+        float getFloat(const float from, const float to);
+
+    private:
+        std::uint64_t state;
+        std::uint64_t increment;
+    };
+
+    /**
+    * This function seeds every stream from one seed. Until it is called the seed comes
+    * from the clock.
+    */
+    void seed(const std::uint32_t seed);
+
+    /**
+    * This function returns the generator for a stream. Streams must only be used by the
+    * thread that updates the game, which is the simulation thread when the game is threaded
+    * and the main thread otherwise. Spawning a level's enemies in Level::setLayout is fine,
+    * since that happens on the updating thread, but nothing that draws or that runs in
+    * Level::prepare, which the level loader calls on its own thread, may use them.
+    */
+    Generator& get(const Stream stream);
+}
+
+#endif // RANDOM_H
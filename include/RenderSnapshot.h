@@ -0,0 +1,205 @@
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include "Memory.h"
+#include "RotationCache.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include <SDL.h>
+
+/**
+* This class is everything drawn in one frame, recorded as a buffer of small commands. The
+* game records a frame into a snapshot instead of drawing straight to the renderer, so that
+* the snapshot can be sorted, counted, written to a file or drawn later on another thread
+* while the game carries on. Each command holds a sprite id rather than a texture, along
+* with where it goes, how it is rotated and the layer it is drawn on. Once a snapshot has
+* been sorted it isn't changed, and its memory is kept when it is cleared so that
+* recording doesn't allocate.
+*/
+class RenderSnapshot
+{
+public:
+    /**
+    * This enum contains the layers that are drawn, from the bottom up. Commands on the
+    * world layers are sorted by sprite, so that everything using the same texture is drawn
+    * one after another and SDL can batch it. The interface is drawn in the order it was
+    * recorded, since panels and the text on them overlap.
+    */
+    enum class Layer : std::uint8_t
+    {
+        Map,
+        Pickups,
+        Enemies,
+        Projectiles,
+        Player,
+        Weapon,
+        Interface,
+        Count
+    };
+
+    /**
+    * This struct holds the statistics for a sorted snapshot. A batch is a run of commands
+    * that draw with the same texture one after another, and culled commands are sprites
+    * that were off the screen and never recorded.
+    */
+    struct Statistics
+    {
+        int commands = 0;
+        int batches = 0;
+        int culled = 0;
+        int layer_commands[static_cast<int>(Layer::Count)] = {};
+    };
+
+    // The sprite id of a texture that can't be drawn. Commands using it are skipped.
+    static constexpr std::uint16_t NO_SPRITE = 0;
+
+    /**
+    * This method empties the snapshot so that the next frame can be recorded into it.
+    * Sprites that are entirely outside of the viewport are culled. The scale is the
+    * resolution the world layers should be drawn at, as a fraction of the viewport's.
+    */
+    void clear(const std::uint64_t tick, const SDL_Rect& viewport, const float scale = 1.0f);
+
+    /**
+    * This method records a sprite, rotated about its centre by an angle in degrees clockwise.
+    */
+    void addSprite(const Layer layer, const std::uint16_t sprite, const SDL_Rect& destination, const float angle);
+
+    /**
+    * This method records triangles from a sprite, such as a line of text.
+    */
+    void addGeometry(const Layer layer, const std::uint16_t sprite, const SDL_Vertex* vertices, const int vertex_count,
+                     const int* indices, const int index_count);
+
+    /**
+    * This method records filled rects in one colour, blended by the colour's alpha.
+    */
+    void addRects(const Layer layer, const SDL_Rect* rects, const int count, const SDL_Color& colour);
+
+    /**
+    * This method records a line in one colour.
+    */
+    void addLine(const Layer layer, const SDL_Point& start, const SDL_Point& end, const SDL_Color& colour);
+
+    /**
+    * This method works out the order the commands are drawn in and the statistics. It must
+    * be called once everything has been recorded. If batch is false, the commands on each
+    * layer are left in the order they were recorded.
+    */
+    void sort(const bool batch = true);
+
+    /**
+    * This method draws the commands on the layers from first up to, but not including,
+    * end, in the order worked out by sort. Rotated sprites are drawn from the rotation
+    * cache when one is given and it can.
+    */
+    void submit(SDL_Renderer* renderer, RotationCache* rotation_cache = nullptr, const Layer first = Layer::Map,
+                const Layer end = Layer::Count) const;
+
+    /**
+    * This method writes the snapshot to a file, along with the name and size of every
+    * sprite it uses, so that it can be drawn again without the game. It uses the renderer,
+    * so it can only be called on the main thread. It returns false if the file couldn't
+    * be written.
+    */
+    bool write(const std::string& file_name) const;
+
+    /**
+    * This method reads a snapshot written by write. Every sprite in the file is given to
+    * getSprite, with its name and size, which returns the sprite id to use for it in this
+    * game. The snapshot still has to be sorted before it is drawn. It returns false if the
+    * file couldn't be read, leaving the snapshot empty.
+    */
+    bool read(const std::string& file_name, const std::function<std::uint16_t(const std::string&, int, int)>& getSprite);
+
+    /**
+    * This method returns the tick of the game the snapshot was recorded on.
+    */
+    std::uint64_t getTick() const;
+
+    /**
+    * This method returns the part of the screen the snapshot was recorded for.
+    */
+    const SDL_Rect& getViewport() const;
+
+    /**
+    * This method returns the resolution the world layers should be drawn at.
+    */
+    float getScale() const;
+
+    /**
+    * This method sets when the input the snapshot shows arrived, as SDL ticks, so that the
+    * time until it is presented can be measured. The input time is when the oldest input
+    * event the frame handled arrived, and the aim time is when the mouse position the
+    * frame was drawn with was read. Either is 0 if there is nothing to measure.
+    */
+    void setInputTimes(const std::uint32_t input_time, const std::uint32_t aim_time);
+
+    /**
+    * This method returns when the oldest input event the frame handled arrived.
+    */
+    std::uint32_t getInputTime() const;
+
+    /**
+    * This method returns when the mouse position the frame was drawn with was read.
+    */
+    std::uint32_t getAimTime() const;
+
+    /**
+    * This method returns the statistics worked out by sort.
+    */
+    const Statistics& getStatistics() const;
+
+    /**
+    * This function returns the name of a layer.
+    */
+    static const char* getLayerName(const Layer layer);
+
+private:
+    enum class Type : std::uint8_t
+    {
+        Sprite,
+        Geometry,
+        Rects,
+        Line
+    };
+
+    /**
+    * This struct is one command. Geometry indices and rects are kept in the shared arrays
+    * below, from first for count items, and a line's end points are the destination's x
+    * and y and w and h.
+    */
+    struct Command
+    {
+        Type type;
+        Layer layer;
+        std::uint16_t sprite;
+        SDL_Color colour;
+        SDL_Rect destination;
+        float angle;
+        std::uint32_t first, count;
+    };
+
+    std::uint64_t tick = 0;
+    SDL_Rect viewport = {0, 0, 0, 0};
+    float scale = 1.0f;
+    std::uint32_t input_time = 0;
+    std::uint32_t aim_time = 0;
+    Statistics statistics;
+    Memory::Vector<Command, Memory::Tag::Render> commands;
+
+    // The order commands are drawn in. Each one is a sort key with the command's index in
+    // its lowest 32 bits.
+    Memory::Vector<std::uint64_t, Memory::Tag::Render> order;
+
+    // Geometry indices are stored relative to the start of the vertices, so every piece of
+    // geometry can be drawn from the same vertex array.
+    Memory::Vector<SDL_Vertex, Memory::Tag::Render> vertices;
+    Memory::Vector<int, Memory::Tag::Render> indices;
+    Memory::Vector<SDL_Rect, Memory::Tag::Render> rects;
+};
+
+#endif // RENDERSNAPSHOT_H
@@ -0,0 +1,107 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include <SDL.h>
+
+/**
+* This namespace records the input the game uses and plays it back. A replay holds every
+* event the game state is given, with the tick it happened on, along with everything else
+* needed to play the same game again: the random seed, the level, the window size and the
+* fixed time step the game was recorded with. Playing a replay back as fast as possible is
+* a timedemo, which times every frame and checks that the game ended up in exactly the
+* same state as when it was recorded.
+*/
+namespace Replay
+{
+    const char MAGIC[4] = {'R', 'P', 'L', 'Y'};
+    const std::uint32_t VERSION = 2;
+
+    /**
+    * This function starts recording. Events are kept in memory until stopRecording is called.
+    * The game must be run with the given seed and fixed time step while it is recorded.
+    */
+    void startRecording(const std::string& file_name, const std::uint32_t seed, const float delta_time,
+                        const int window_width, const int window_height);
+
+    /**
+    * This function writes the recording to its file and stops recording. It does nothing
+    * if nothing is being recorded.
+    */
+    void stopRecording();
+
+    /**
+    * This function returns whether or not a replay is being recorded.
+    */
+    bool isRecording();
+
+    /**
+    * This function loads a replay and starts playing it back. An error is thrown if the
+    * file can't be read or isn't a replay from this version of the game.
+    */
+    void startPlayback(const std::string& file_name);
+
+    /**
+    * This function returns whether or not a replay is being played back.
+    */
+    bool isPlaying();
+
+    /**
+    * This function returns whether or not every tick of the replay has been played.
+    */
+    bool isFinished();
+
+    /**
+    * These functions return what the replay being played back was recorded with.
+    */
+    std::uint32_t getSeed();
+    float getDeltaTime();
+    SDL_Point getWindowSize();
+    const std::string& getLevel();
+
+    /**
+    * This function sets the level the recording starts on.
+    */
+    void setLevel(const std::string& level_file);
+
+    /**
+    * This function records an event on the current tick. Events the game doesn't use,
+    * such as window events, are left out.
+    */
+    void recordEvent(const SDL_Event& event);
+
+    /**
+    * This function gets the next event from the replay that happened on the current tick.
+    * It returns false once there are no more events on this tick.
+    */
+    bool pollEvent(SDL_Event& event);
+
+    /**
+    * This function moves on to the next tick. While playing back, the time the frame took
+    * to work out, in microseconds, is kept for the report.
+    */
+    void endFrame(const float work_time);
+
+    /**
+    * This function sets the hash of the state the game finished in. When recording it is
+    * stored in the replay, and when playing back it is checked against the stored hash.
+    */
+    void finish(const std::uint64_t state_hash);
+
+    /**
+    * This function returns whether or not the replay that was played back finished every
+    * tick in the same state it was recorded in.
+    */
+    bool hasMatched();
+
+    /**
+    * This function writes how long the replay took to play back, the frame time
+    * percentiles and whether or not the final state matched.
+    */
+    void writeReport(std::ostream& stream);
+}
+
+#endif // REPLAY_H
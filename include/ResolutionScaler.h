@@ -0,0 +1,61 @@
+#ifndef RESOLUTIONSCALER_H
+#define RESOLUTIONSCALER_H
+
+/**
+* This class picks the resolution the world is drawn at, as a fraction of the window's,
+* so that frames stay under a time budget. When a frame takes longer than the budget, say
+* when a horde fills the screen, the scale is dropped straight away by about as much as
+* the frame was over, since the time taken to fill the screen goes with the number of
+* pixels. It is only raised again one small step at a time once frames are comfortably
+* under the budget, and each change is given time to show in the frame times before the
+* next one, so that the resolution doesn't flicker between two scales. With no budget the
+* scale stays at the most it is allowed to be.
+*/
+class ResolutionScaler
+{
+public:
+    /**
+    * This method sets the scales the resolution can be between and the budget, in
+    * milliseconds, that frames are kept under. A budget of 0 keeps the scale at max_scale.
+    */
+    void setup(const float max_scale, const float min_scale, const float budget);
+
+    /**
+    * This method records how long the last frame took, in milliseconds, and changes the
+    * scale if it needs to.
+    */
+    void addFrame(const float frame_time);
+
+    /**
+    * This method returns the scale the next frame should be drawn at.
+    */
+    float getScale() const;
+
+    /**
+    * This method returns the budget, in milliseconds, or 0 if the scale never changes.
+    */
+    float getBudget() const;
+
+private:
+    // Scales are rounded to a multiple of this, which is also how much the scale is raised by.
+    static constexpr float STEP = 0.05;
+
+    // How much of each new frame time goes into the average.
+    static constexpr float SMOOTHING = 0.1;
+
+    // The scale is only raised when the average is under this much of the budget, since
+    // raising it makes frames take longer.
+    static constexpr float RAISE_THRESHOLD = 0.7;
+
+    // How many frames to wait after changing the scale before changing it again.
+    static const int SETTLE_FRAMES = 30;
+
+    float max_scale = 1.0;
+    float min_scale = 1.0;
+    float budget = 0.0;
+    float scale = 1.0;
+    float average_time = 0.0;
+    int settle_frames = 0;
+};
+
+#endif // RESOLUTIONSCALER_H
@@ -0,0 +1,88 @@
+#ifndef ROTATIONCACHE_H
+#define ROTATIONCACHE_H
+
+#include "Memory.h"
+
+#include <cstdint>
+
+#include <SDL.h>
+
+/**
+* This class draws rotated sprites from copies that have already been rotated. SDL's
+* software renderer has to rotate every pixel of a sprite each time it is drawn at an
+* angle, which makes rotated sprites by far the slowest thing to draw without a GPU. The
+* cache instead renders each sprite once at a number of evenly spaced angles into an atlas,
+* and then draws the angle closest to the one asked for with a plain copy. A sprite's atlas
+* is made the first time it is drawn rotated at a given size, and sprites that are too big,
+* or that would take the cache over its memory budget, are left to SDL_RenderCopyEx.
+* Everything is done with the renderer, so the cache can only be used on the main thread.
+*/
+class RotationCache
+{
+public:
+    /**
+    * The angle count is how many rotations each sprite is rendered at, and max_bytes is
+    * roughly how much video memory all of the atlases can take.
+    */
+    RotationCache(const int angle_count, const std::int64_t max_bytes = DEFAULT_MAX_BYTES);
+    ~RotationCache();
+
+    RotationCache(const RotationCache&) = delete;
+    RotationCache& operator=(const RotationCache&) = delete;
+
+    /**
+    * This method draws a sprite rotated about its centre by an angle in degrees clockwise,
+    * rounded to the nearest angle in the cache. It returns false, without drawing anything,
+    * if the sprite can't be cached.
+    */
+    bool draw(SDL_Renderer* renderer, const std::uint16_t sprite, const SDL_Rect& destination, const float angle);
+
+    /**
+    * This method returns how many bytes of video memory the atlases take.
+    */
+    std::int64_t getBytes() const;
+
+private:
+    static constexpr std::int64_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+    // Sprites whose rotated size is bigger than this aren't cached, so one big sprite can't
+    // take the whole budget.
+    static constexpr int MAX_CELL_SIZE = 256;
+
+    /**
+    * This struct is the atlas for one sprite at one size. Every rotation has a square cell
+    * big enough to hold the sprite at any angle, in rows of columns cells. The atlas is
+    * nullptr if the sprite couldn't be cached, so that it isn't tried again every frame.
+    */
+    struct Entry
+    {
+        std::uint16_t sprite;
+        SDL_Texture* texture;
+        int width, height;
+        int cell_size;
+        SDL_Texture* atlas;
+    };
+
+    /**
+    * This method renders every rotation of a sprite into a new atlas.
+    */
+    void createAtlas(SDL_Renderer* renderer, Entry& entry);
+
+    /**
+    * This method destroys an entry's atlas.
+    */
+    void destroyAtlas(Entry& entry);
+
+    /**
+    * This method returns how many bytes an atlas with a cell size takes.
+    */
+    std::int64_t getAtlasBytes(const int cell_size) const;
+
+    int angle_count;
+    int columns, rows;
+    std::int64_t max_bytes;
+    std::int64_t bytes = 0;
+    Memory::Vector<Entry, Memory::Tag::Render> entries;
+};
+
+#endif // ROTATIONCACHE_H
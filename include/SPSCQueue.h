@@ -0,0 +1,56 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+* This class is a fixed size, lock-free queue for passing items from one thread to
+* another. Only one thread may push and only one other thread may pop. Neither side
+* ever waits for the other, a push fails if the queue is full and a pop fails if it is
+* empty. One slot is always left empty, so the queue holds at most CAPACITY - 1 items.
+*/
+template <typename T, std::size_t CAPACITY>
+class SPSCQueue
+{
+public:
+    /**
+    * This method adds an item to the back of the queue. It returns false if the queue is full.
+    */
+    bool push(const T& item)
+    {
+        const std::size_t current_tail = tail.load(std::memory_order_relaxed);
+        const std::size_t next_tail = (current_tail + 1) % CAPACITY;
+        if (next_tail == head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        items[current_tail] = item;
+        tail.store(next_tail, std::memory_order_release);
+        return true;
+    }
+
+    /**
+    * This method takes the item from the front of the queue. It returns false if the queue is empty.
+    */
+    bool pop(T& item)
+    {
+        const std::size_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = items[current_head];
+        head.store((current_head + 1) % CAPACITY, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T items[CAPACITY];
+
+    // The two ends are kept on separate cache lines so that the threads don't slow each other down.
+    alignas(64) std::atomic<std::size_t> head{0};
+    alignas(64) std::atomic<std::size_t> tail{0};
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,85 @@
+#ifndef STRESSSTATE_H
+#define STRESSSTATE_H
+
+#include "GameState.h"
+#include "LevelGenerator.h"
+
+#include <fstream>
+
+/**
+* This state is the scripted stress run. It generates a level for every map size and enemy
+* count, plays each of them for a fixed number of frames without any input and reports how
+* long the frames took, so that it is easy to see how the game scales. Every result is
+* logged and written to a CSV file, and the game quits once every level has been played.
+*/
+class StressState : public Application::BaseState
+{
+public:
+    /**
+    * This struct holds the settings for a stress run. Every size is played with every
+    * enemy count. Frames aren't measured until warmup_frames have been played on a level.
+    */
+    struct Settings
+    {
+        std::vector<int> sizes = {64, 128, 256, 512};
+        std::vector<int> enemy_counts = {16, 64, 256};
+        int warmup_frames = 60;
+        int frames = 300;
+        std::uint32_t seed = LevelGenerator::DEFAULT_SEED;
+    };
+
+    explicit StressState(const Settings& settings);
+
+    void startUp() override;
+    void handleEvents() override;
+    void update() override;
+    void draw() override;
+    void shutDown() override;
+
+private:
+    /**
+    * This struct is one level of the stress run.
+    */
+    struct Scenario
+    {
+        int size;
+        int enemies;
+        std::string file_name;
+    };
+
+    /**
+    * This method works out the settings used to generate the level for a scenario.
+    */
+    LevelGenerator::Settings getLevelSettings(const Scenario& scenario) const;
+
+    /**
+    * This method reports the results of the current scenario and moves on to the next,
+    * or quits if it was the last one.
+    */
+    void finishScenario();
+
+    /**
+    * This method returns a percentile, from 0 to 1, of some sorted times.
+    */
+    static float getPercentile(const std::vector<float>& sorted_times, const float percentile);
+
+private:
+    static constexpr const char* REPORT_FILE = "stress.csv";
+
+    Settings settings;
+    std::vector<Scenario> scenarios;
+    std::size_t scenario_index = 0;
+    int frame = 0;
+
+    // Times for the current scenario, in milliseconds. Work is the frame without the time
+    // spent waiting for the frame rate limit.
+    std::vector<float> frame_times;
+    std::vector<float> work_times;
+    std::vector<float> update_times;
+    std::vector<float> draw_times;
+
+    std::unique_ptr<GameState> game;
+    std::ofstream report;
+};
+
+#endif // STRESSSTATE_H
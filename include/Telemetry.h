@@ -0,0 +1,65 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <cstdint>
+#include <string>
+
+/**
+* This namespace counts how much work the game does each frame, such as how many collision
+* tests were made or how many projectiles were spawned. Every frame the counts are pushed
+* onto a lock-free queue as a row, and a writer thread writes the rows to a CSV file, so
+* the game never waits on the file. Counters can only be added to from the thread the game
+* is updated on. Counter::Allocations is taken from Memory, which counts allocations on
+* every thread.
+*/
+namespace Telemetry
+{
+    /**
+    * This enum contains every counter. Count is the number of counters and isn't a counter itself.
+    */
+    enum class Counter
+    {
+        CollisionTests,
+        LineOfSightRays,
+        BFSNodes,
+        ProjectilesSpawned,
+        ProjectilesCulled,
+        DrawCalls,
+        TextureLoads,
+        Allocations,
+        Count
+    };
+
+    /**
+    * This function returns the name of a counter, as used in the CSV header.
+    */
+    const char* getName(const Counter counter);
+
+    /**
+    * This function adds to a counter for the current frame.
+    */
+    void add(const Counter counter, const std::uint32_t amount = 1);
+
+    /**
+    * This function returns the value of a counter in the last complete frame.
+    */
+    std::uint32_t getLastFrame(const Counter counter);
+
+    /**
+    * This function starts the writer thread, which writes every frame after this to a CSV file.
+    */
+    void startUp(const std::string& file_name);
+
+    /**
+    * This function ends the current frame. If the writer thread is running, the frame's
+    * counters are queued to be written. The frame is dropped if the queue is full.
+    */
+    void endFrame(const float frame_time);
+
+    /**
+    * This function writes every queued frame and stops the writer thread.
+    */
+    void shutDown();
+}
+
+#endif // TELEMETRY_H
@@ -2,19 +2,33 @@
 #define TEXT_H
 
 #include "Application.h"
+#include "GlyphAtlas.h"
 
 class Text
 {
 public:
     Text(TTF_Font* font, const std::string& text, const int x, const int y, const bool centered, const int width = 0);
-    void setText(const std::string& text);
+    void setText(const std::string_view text);
     void draw();
-    ~Text();
 
 private:
-    SDL_Texture* texture;
+    /**
+    * This method builds a quad for every character of the text from the font's glyph atlas.
+    * It is only called when the text changes.
+    */
+    void layOut();
+
+    /**
+    * This method adds the quad for a single glyph.
+    */
+    void addGlyph(const GlyphAtlas::Glyph& glyph, const int x, const int y);
+
+private:
+    GlyphAtlas* atlas;
+    std::string text;
+    Memory::Vector<SDL_Vertex, Memory::Tag::Text> vertices;
+    Memory::Vector<int, Memory::Tag::Text> indices;
     SDL_Rect rect;
-    TTF_Font* font;
     bool centered;
     int width;
 };
@@ -1,11 +1,11 @@
 #ifndef TOOLS_H
 #define TOOLS_H
 
+#include <cstdint>
 #include <string>
 #include <sstream>
 #include <vector>
 #include <cmath>
-#include <random>
 #include <chrono>
 
 #include <SDL.h>
@@ -16,15 +16,6 @@
 */
 namespace Tools
 {
-    /**
-    * This is a type used for normalizing vectors, since
-    * normalized vectors are always floats.
-    */
-    struct FloatVector
-    {
-        float x, y;
-    };
-
     /**
     * This function splits a string into a vector of strings. The string is split
     * based on the delimeter.
@@ -32,22 +23,16 @@ namespace Tools
     std::vector<std::string> splitString(const std::string& text, const char delimeter);
 
     /**
-    * This function calculates the angle between two points.
+    * This function moves a rect back out of every solid it overlaps along the x axis.
+    * Only the sign of velocity is used, to know which side of a solid the rect came from.
     */
-    int angleBetweenPoints(const int x1, const int y1, const int x2, const int y2);
+    void resolveCollisionsX(SDL_Rect& rect, const float velocity, const SDL_Rect* solids, const std::size_t solid_count);
 
     /**
-    * This function returns a normalized vector.
+    * This function moves a rect back out of every solid it overlaps along the y axis.
+    * Only the sign of velocity is used, to know which side of a solid the rect came from.
     */
-    FloatVector normalizeVector(const SDL_Point& vec);
-    FloatVector normalizeVector(const FloatVector& vec);
-
-    /**
-    * This function returns a random number from a range.
-    */
-    int getRandomInt(const int from, const int to);
-
-    float getRandomFloat(const float from, const float to);
+    void resolveCollisionsY(SDL_Rect& rect, const float velocity, const SDL_Rect* solids, const std::size_t solid_count);
 }
 
 #endif // TOOLS_H
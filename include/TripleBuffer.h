@@ -0,0 +1,68 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+
+/**
+* This class passes the latest version of something from one thread to another without
+* either thread ever waiting. The writer fills one buffer while the reader uses another,
+* and the third holds the newest finished buffer. Publishing swaps the writer's buffer
+* with the newest one, and the reader swaps its buffer with the newest one when it wants
+* to move on, so a reader that falls behind skips straight to the latest buffer. Only one
+* thread may write and only one other thread may read.
+*/
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+    * This method returns the buffer the writer is filling.
+    */
+    T& getWriteBuffer()
+    {
+        return buffers[write_index];
+    }
+
+    /**
+    * This method makes the write buffer the newest one. The writer is given the buffer
+    * that was the newest before, which the reader isn't using.
+    */
+    void publish()
+    {
+        write_index = newest.exchange(write_index | NEW_FLAG, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    /**
+    * This method moves the reader onto the newest buffer. It returns false, and keeps the
+    * buffer the reader already has, if nothing has been published since it last moved.
+    */
+    bool update()
+    {
+        if (!(newest.load(std::memory_order_relaxed) & NEW_FLAG))
+        {
+            return false;
+        }
+        read_index = newest.exchange(read_index, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    /**
+    * This method returns the buffer the reader is using.
+    */
+    const T& getReadBuffer() const
+    {
+        return buffers[read_index];
+    }
+
+private:
+    // The newest buffer's index is kept with a flag that is set when it hasn't been read yet.
+    static const int INDEX_MASK = 3;
+    static const int NEW_FLAG = 4;
+
+    T buffers[3];
+    int write_index = 0;
+    int read_index = 1;
+    alignas(64) std::atomic<int> newest{2};
+};
+
+#endif // TRIPLEBUFFER_H
@@ -12,7 +12,6 @@ public:
 private:
     static constexpr float ATTACK_TIME = 0.7;
 
-    float attack_timer = 0.0;
     SDL_Rect melee_rect;
 };
 
@@ -1,11 +1,27 @@
-#include "Debug.h"
+#include "Log.h"
+#include "Random.h"
 #include "GameState.h"
+#include "StressState.h"
+#include "Tools.h"
+
+#include <chrono>
+#include <cstring>
 
 int main(int argc, char* argv[])
 {
+    // Messages are written to the console on their own thread.
+    Log::startUp();
+
     try
     {
         Application::loadConfig("Resources/Config.xml");
+
+        Log::Level log_level;
+        if (Log::getLevelFromName(Application::getConfigMap()["debug"]["log_level"], log_level))
+        {
+            Log::setLevel(log_level);
+        }
+
         int width = std::atoi(Application::getConfigMap()["screen"]["width"].c_str());
         int height = std::atoi(Application::getConfigMap()["screen"]["height"].c_str());
         int fps = std::atoi(Application::getConfigMap()["screen"]["fps_limit"].c_str());
@@ -16,48 +32,238 @@ int main(int argc, char* argv[])
             fullscreen = true;
         }
 
-        Application::startUp("Top Down Shooter", width, height, fps, fullscreen);
-        Application::StateMap states = {
-            {"GAME", std::make_shared<GameState>()}
+        // Play for a while and fail if any frame allocates once the game has warmed up.
+        bool allocation_test = false;
+
+        // Update the game on its own thread even if the config doesn't ask for it.
+        bool threaded = false;
+
+        // Record every input to a replay, or play one back as fast as possible.
+        std::string record_file;
+        std::string timedemo_file;
+        bool headless = false;
+        std::uint32_t seed = std::chrono::system_clock::now().time_since_epoch().count();
+
+        // Play generated levels of growing size and report how long the frames take.
+        bool stress = false;
+        StressState::Settings stress_settings;
+
+        // Turns a comma separated list of numbers into a vector.
+        auto parseList = [](const char* text)
+        {
+            std::vector<int> values;
+            for (const auto& value : Tools::splitString(text, ','))
+            {
+                values.push_back(std::atoi(value.c_str()));
+            }
+            return values;
         };
-        Application::setupStates(states, "GAME");
+
+        for (int i = 1; i < argc; i++)
+        {
+            if (std::strcmp(argv[i], "--allocation-test") == 0)
+            {
+                allocation_test = true;
+                Memory::startAllocationTest(600, 1200);
+            }
+            else if (std::strcmp(argv[i], "--threaded") == 0)
+            {
+                threaded = true;
+            }
+            else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            {
+                record_file = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            {
+                seed = std::strtoul(argv[++i], nullptr, 10);
+            }
+            else if (std::strcmp(argv[i], "--timedemo") == 0 && i + 1 < argc)
+            {
+                timedemo_file = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--headless") == 0)
+            {
+                headless = true;
+            }
+            else if (std::strcmp(argv[i], "--stress") == 0)
+            {
+                stress = true;
+            }
+            else if (std::strcmp(argv[i], "--stress-sizes") == 0 && i + 1 < argc)
+            {
+                stress_settings.sizes = parseList(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--stress-enemies") == 0 && i + 1 < argc)
+            {
+                stress_settings.enemy_counts = parseList(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--stress-frames") == 0 && i + 1 < argc)
+            {
+                stress_settings.frames = std::atoi(argv[++i]);
+            }
+        }
+
+        // A replay has to be played in a window the same size as the one it was recorded in,
+        // since where the player aims depends on it.
+        if (!timedemo_file.empty())
+        {
+            Replay::startPlayback(timedemo_file);
+            width = Replay::getWindowSize().x;
+            height = Replay::getWindowSize().y;
+        }
+
+        Application::startUp("Top Down Shooter", width, height, fps, fullscreen);
+
+        // Write the last few hundred frames to a file whenever a frame goes over budget.
+        float frame_budget_scale = std::atof(Application::getConfigMap()["debug"]["frame_budget_scale"].c_str());
+        FlightRecorder::setFrameBudget(frame_budget_scale * 1000.0 / fps);
+        FlightRecorder::startUp();
+
+        // Write how much work each frame does to a CSV file.
+        if (Application::getConfigMap()["debug"]["telemetry"] == "true")
+        {
+            Telemetry::startUp("telemetry.csv");
+        }
+
+        // Replays step the game by a fixed amount every frame and use a known seed, so that
+        // playing one back gives exactly the same game.
+        if (Replay::isPlaying())
+        {
+            Random::seed(Replay::getSeed());
+            Application::setFixedDeltaTime(Replay::getDeltaTime());
+            Application::setFrameRateLimit(0);
+            Application::setHeadless(headless);
+        }
+        else if (!record_file.empty())
+        {
+            Random::seed(seed);
+            Application::setFixedDeltaTime(1.0 / fps);
+            Replay::startRecording(record_file, seed, 1.0 / fps, width, height);
+        }
+
+        // Draw rotated sprites from copies rendered at a fixed number of angles, for machines
+        // that only have SDL's software renderer.
+        Application::setSpriteRotations(std::atoi(Application::getConfigMap()["screen"]["sprite_rotations"].c_str()));
+
+        // Draw the world at a fraction of the window's resolution. With dynamic resolution the
+        // fraction drops, down to the minimum, whenever drawing a frame takes longer than the
+        // budget, which is the frame rate limit's frame time unless one is given. A config
+        // without a scale draws at full resolution, and one without a minimum never drops below
+        // the scale.
+        float resolution_scale = std::atof(Application::getConfigMap()["screen"]["resolution_scale"].c_str());
+        if (resolution_scale <= 0.0)
+        {
+            resolution_scale = 1.0;
+        }
+        if (Application::getConfigMap()["screen"]["dynamic_resolution"] == "true")
+        {
+            float min_resolution_scale = std::atof(Application::getConfigMap()["screen"]["min_resolution_scale"].c_str());
+            if (min_resolution_scale <= 0.0)
+            {
+                min_resolution_scale = resolution_scale;
+            }
+            float resolution_budget = std::atof(Application::getConfigMap()["screen"]["resolution_budget"].c_str());
+            if (resolution_budget <= 0.0 && fps > 0)
+            {
+                resolution_budget = 1000.0 / fps;
+            }
+            Application::setResolutionScale(resolution_scale, min_resolution_scale, resolution_budget);
+        }
+        else
+        {
+            Application::setResolutionScale(resolution_scale, resolution_scale, 0.0);
+        }
+
+        // Update the game on its own thread so that drawing and the simulation don't hold each
+        // other up. Timedemos, stress runs and the allocation test measure the whole frame on
+        // one thread, so they stay single threaded.
+        bool simulation_thread = threaded || Application::getConfigMap()["screen"]["simulation_thread"] == "true";
+        Application::setThreaded(simulation_thread && !Replay::isPlaying() && !stress && !allocation_test);
+
+        // Stop updating and drawing while the window is hidden or in the background, so that the
+        // game doesn't use the CPU while nobody is playing it. Stress runs and the allocation
+        // test are left running in the background.
+        bool pause_when_unfocused = Application::getConfigMap()["screen"]["pause_when_unfocused"] == "true";
+        Application::setPauseWhenUnfocused(pause_when_unfocused && !stress && !allocation_test);
+
+        // Read the mouse again just before each frame is drawn, so that the player's aim is drawn
+        // with as little latency as possible.
+        Application::setLateLatch(Application::getConfigMap()["screen"]["late_latch"] == "true");
+
+        Application::StateMap states;
+        if (stress)
+        {
+            states["STRESS"] = std::make_shared<StressState>(stress_settings);
+            Application::setupStates(states, "STRESS");
+        }
+        else
+        {
+            states["GAME"] = std::make_shared<GameState>();
+            Application::setupStates(states, "GAME");
+        }
         Application::run();
 
+        Replay::stopRecording();
         Application::shutDown();
+        Log::shutDown();
+
+#ifdef LOG_ENABLED
+        Memory::writeReport(std::cout);
+#endif // LOG_ENABLED
+
+        if (allocation_test && Memory::hasAllocationTestFailed())
+        {
+            return 1;
+        }
+
+        if (Replay::isPlaying())
+        {
+            Replay::writeReport(std::cout);
+            if (!Replay::hasMatched())
+            {
+                return 1;
+            }
+        }
     }
     catch (const Application::Error& error)
     {
         switch (error)
         {
         case Application::Error::SDL:
-            DEBUG("SDL_Error: " << SDL_GetError());
+            LOG_ERROR(General, "SDL_Error: " << SDL_GetError());
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "SDL Error", SDL_GetError(), Application::getWindow());
             break;
         case Application::Error::IMG:
-            DEBUG("IMG Error: " << IMG_GetError());
+            LOG_ERROR(General, "IMG Error: " << IMG_GetError());
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "IMG Error", IMG_GetError(), Application::getWindow());
             break;
         case Application::Error::TTF:
-            DEBUG("TTF Error: " << TTF_GetError());
+            LOG_ERROR(General, "TTF Error: " << TTF_GetError());
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "TTF Error", TTF_GetError(), Application::getWindow());
             break;
         case Application::Error::Mix:
-            DEBUG("Mix Error: " << Mix_GetError());
+            LOG_ERROR(General, "Mix Error: " << Mix_GetError());
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Mix Error", Mix_GetError(), Application::getWindow());
             break;
         case Application::Error::XML:
-            DEBUG("XML Error: " << SDL_GetError());
+            LOG_ERROR(General, "XML Error: " << SDL_GetError());
             SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "XML Error", SDL_GetError(), Application::getWindow());
             break;
+        case Application::Error::Level:
+            LOG_ERROR(General, "Level Error: " << SDL_GetError());
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "Level Error", SDL_GetError(), Application::getWindow());
+            break;
         default:
             break;
         }
 
         Application::shutDown();
+        Log::shutDown();
 
-#ifdef DEBUG_ENABLED
+#ifdef LOG_ENABLED
         std::cin.get();
-#endif // DEBUG_ENABLED
+#endif // LOG_ENABLED
     }
 
     return 0;
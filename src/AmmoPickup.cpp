@@ -18,7 +18,7 @@ AmmoPickup::AmmoPickup(SDL_Texture* texture, const SDL_Rect& rect, const int amm
 void AmmoPickup::draw()
 {
     SDL_Rect draw_rect = Application::convertToCameraView(rect);
-    SDL_RenderCopy(Application::getRenderer(), texture, nullptr, &draw_rect);
+    Application::drawTexture(RenderSnapshot::Layer::Pickups, texture, draw_rect);
 }
 
 const SDL_Rect& AmmoPickup::getRect()
@@ -35,3 +35,13 @@ const Weapon& AmmoPickup::getWeapon()
 {
     return weapon;
 }
+
+int AmmoPickup::getSpawnIndex()
+{
+    return spawn_index;
+}
+
+void AmmoPickup::setSpawnIndex(const int spawn_index)
+{
+    this->spawn_index = spawn_index;
+}
@@ -1,4 +1,13 @@
 #include "Application.h"
+#include "GlyphAtlas.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <mutex>
 
 /**
 * This namespace is used to contain all of the important game information. It is
@@ -16,7 +25,7 @@ namespace Application
         // SDL objects.
         SDL_Window* window;
         SDL_Renderer* renderer;
-        SDL_Event event;
+        InputFrame input_frame;
         SDL_Point window_size;
         SDL_Point camera;
         SDL_Point mouse_position;
@@ -27,9 +36,19 @@ namespace Application
         std::shared_ptr<BaseState> current_state;
 
         // Resource maps.
-        std::map<std::string, SDL_Texture*> textures;
-        std::map<std::string, Mix_Chunk*> sounds;
-        std::map<std::string, std::map<int, TTF_Font*>> fonts;
+        Memory::Map<std::string, SDL_Texture*, Memory::Tag::Resource> textures;
+        Memory::Map<std::string, Mix_Chunk*, Memory::Tag::Resource> sounds;
+        Memory::Map<std::string, Memory::Map<int, TTF_Font*, Memory::Tag::Resource>, Memory::Tag::Resource> fonts;
+        Memory::Map<TTF_Font*, std::unique_ptr<GlyphAtlas>, Memory::Tag::Resource> glyph_atlases;
+
+        // Sprites. Id 0 is RenderSnapshot::NO_SPRITE, so it is never given to a texture.
+        Memory::Vector<SDL_Texture*, Memory::Tag::Resource> sprites = {nullptr};
+        Memory::Vector<std::uint16_t, Memory::Tag::Resource> free_sprites;
+        std::unique_ptr<RotationCache> rotation_cache;
+
+        // Resolution.
+        ResolutionScaler resolution_scaler;
+        SDL_Texture* world_target = nullptr;
 
         // Config variables
         std::map<std::string, std::map<std::string, std::string>> config;
@@ -37,12 +56,666 @@ namespace Application
         std::vector<std::string> catagory_order;
         std::vector<std::string> setting_order;
 
+        // Threading.
+        bool threaded = false;
+        std::thread::id main_thread_id;
+        SPSCQueue<SDL_Event, EVENT_QUEUE_SIZE> event_queue;
+        TripleBuffer<RenderSnapshot> render_snapshots;
+        RenderSnapshot* render_snapshot = nullptr;
+        std::atomic<std::uint64_t> tick{0};
+        std::atomic<std::uint64_t> oldest_drawable_tick{0};
+        std::atomic<float> present_time{0.0};
+
+        // Idling.
+        std::atomic<bool> paused{false};
+        std::atomic<bool> window_active{true};
+        std::atomic<bool> window_exposed{false};
+        bool pause_when_unfocused = false;
+
+        // Input latency.
+        bool late_latch = false;
+        SDL_Point draw_mouse_position;
+        std::uint32_t input_time = 0;
+        std::uint32_t mouse_time = 0;
+        std::atomic<std::uint64_t> latest_mouse{0};
+        std::atomic<float> input_latency{0.0};
+        std::atomic<float> aim_latency{0.0};
+        std::uint64_t presented_tick = 0;
+
         // Miscellaneous variables.
-        bool running;
+        std::atomic<bool> running;
         float delta_time;
         int frame_rate_limit;
+        FramePacer frame_pacer;
+        float fixed_delta_time = 0.0;
+        bool headless = false;
         int frame_rate;
         std::string window_title;
+        FrameTimings frame_timings;
+        std::string render_dump_file;
+
+        /**
+        * This struct is a task waiting for the main thread to run it. Tasks are kept on
+        * the stack of the thread waiting for them, so that passing one doesn't allocate.
+        */
+        struct MainThreadTask
+        {
+            const std::function<void()>* function;
+            bool done;
+            std::exception_ptr error;
+            std::string error_message;
+        };
+
+        // Tasks for the main thread, and the window title to set once it gets to them.
+        std::mutex task_mutex;
+        std::condition_variable task_condition;
+        std::vector<MainThreadTask*> main_thread_tasks;
+        std::string pending_window_title;
+        bool window_title_changed = false;
+
+        // Used to wake the simulation thread when an event arrives while it is idle.
+        std::mutex idle_mutex;
+        std::condition_variable idle_condition;
+        bool idle_wake = false;
+
+        /**
+        * This function gets the next event from SDL or, when the game is threaded, from the
+        * events the main thread has passed on.
+        */
+        bool getNextEvent(SDL_Event& next_event)
+        {
+            if (threaded)
+            {
+                return event_queue.pop(next_event);
+            }
+
+            // SDL_PollEvent asks the system for new events every time it is called, so the
+            // queue is pumped once a frame in handleEvents and only read from here.
+            return SDL_PeepEvents(&next_event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0;
+        }
+
+        /**
+        * This function wakes the main thread when the game is threaded. The main thread sleeps
+        * on SDL's event queue until it has something to do, so it is sent an event.
+        */
+        void wakeMainThread()
+        {
+            SDL_Event wake_event = {};
+            wake_event.type = SDL_USEREVENT;
+            SDL_PushEvent(&wake_event);
+        }
+
+        /**
+        * This function gets the next event for the game. While a replay is played back the
+        * events come from the replay instead, and every real event is thrown away apart
+        * from quitting.
+        */
+        bool pollEvent(SDL_Event& next_event)
+        {
+            if (Replay::isPlaying())
+            {
+                while (getNextEvent(next_event))
+                {
+                    if (next_event.type == SDL_QUIT)
+                    {
+                        running = false;
+                    }
+                }
+                return Replay::pollEvent(next_event);
+            }
+
+            return getNextEvent(next_event);
+        }
+
+        /**
+        * This function returns true if the game should stop updating and drawing until an
+        * event arrives. Replays and headless games never idle, since nobody is waiting to
+        * carry them on.
+        */
+        bool isIdle()
+        {
+            return !headless && !Replay::isPlaying() && (paused || (pause_when_unfocused && !window_active));
+        }
+
+        /**
+        * This function keeps track of whether the window can be seen and has focus, from an
+        * event SDL sent it.
+        */
+        void handleWindowEvent(const SDL_Event& window_event)
+        {
+            switch (window_event.window.event)
+            {
+            case SDL_WINDOWEVENT_HIDDEN:
+            case SDL_WINDOWEVENT_MINIMIZED:
+            case SDL_WINDOWEVENT_FOCUS_LOST:
+                window_active = false;
+                break;
+            case SDL_WINDOWEVENT_SHOWN:
+            case SDL_WINDOWEVENT_RESTORED:
+            case SDL_WINDOWEVENT_FOCUS_GAINED:
+                window_active = true;
+                break;
+            case SDL_WINDOWEVENT_EXPOSED:
+                window_exposed = true;
+                break;
+            default:
+                break;
+            }
+        }
+
+        /**
+        * This function returns true if an event is input from the player.
+        */
+        bool isInputEvent(const SDL_Event& input_event)
+        {
+            switch (input_event.type)
+            {
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+            case SDL_MOUSEMOTION:
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+            case SDL_MOUSEWHEEL:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        /**
+        * This function drains every event waiting for the game into the frame's input,
+        * keeping track of the mouse, and then passes the input on to the current state.
+        * Replays record the input as the state sees it, with the mouse's motion folded
+        * into one event before the frame's other events. When the game is threaded the
+        * main thread has already handled the window's events.
+        */
+        void handleEvents()
+        {
+            PROFILE_ZONE("Application::handleEvents");
+            if (!threaded)
+            {
+                SDL_PumpEvents();
+            }
+
+            SDL_Event event;
+            input_frame.clear(mouse_position);
+            while (pollEvent(event))
+            {
+                // Remember when the oldest input the frame handles arrived, so that the time
+                // until it is seen can be measured. Replayed events don't have a time.
+                if (input_time == 0 && isInputEvent(event) && !Replay::isPlaying())
+                {
+                    input_time = event.common.timestamp;
+                }
+                input_frame.add(event);
+            }
+
+            if (input_frame.hasMouseMotion())
+            {
+                Replay::recordEvent(input_frame.getMouseMotion());
+
+                // Keep track of the position of the mouse.
+                mouse_position = input_frame.getMousePosition();
+                mouse_time = Replay::isPlaying() ? 0 : input_frame.getMouseMotion().common.timestamp;
+            }
+
+            for (const SDL_Event& input_event : input_frame.getEvents())
+            {
+                Replay::recordEvent(input_event);
+                if (input_event.type == SDL_QUIT)
+                {
+                    running = false;
+                }
+                else if (input_event.type == SDL_WINDOWEVENT && !threaded)
+                {
+                    handleWindowEvent(input_event);
+                }
+            }
+
+            frame_timings.input_events = input_frame.getEventCount();
+            frame_timings.mouse_motions = input_frame.getMotionCount();
+            PROFILE_COUNTER("Input events", input_frame.getEventCount());
+            current_state->handleEvents();
+        }
+
+        /**
+        * This function picks the mouse position the frame is drawn with and stores the
+        * frame's input times in its render snapshot. With late latching the mouse is read
+        * again now, just before drawing. When the game is threaded the simulation can't ask
+        * SDL, so it uses the newest position the main thread has seen.
+        */
+        void latchMousePosition()
+        {
+            SDL_Point position = mouse_position;
+            std::uint32_t time = mouse_time;
+            if (late_latch && !Replay::isPlaying())
+            {
+                if (threaded)
+                {
+                    const std::uint64_t latest = latest_mouse;
+                    if (latest != 0)
+                    {
+                        position = {static_cast<std::int16_t>(latest >> 48), static_cast<std::int16_t>(latest >> 32)};
+                        time = static_cast<std::uint32_t>(latest);
+                    }
+                }
+                else
+                {
+                    SDL_PumpEvents();
+                    SDL_GetMouseState(&position.x, &position.y);
+                    time = SDL_GetTicks();
+                }
+            }
+
+            // The aim is only timed on frames where the mouse moved, otherwise a mouse that
+            // was left alone would look like it was seen later and later.
+            const bool moved = position.x != draw_mouse_position.x || position.y != draw_mouse_position.y;
+            draw_mouse_position = position;
+            render_snapshot->setInputTimes(input_time, moved ? time : 0);
+            input_time = 0;
+        }
+
+        /**
+        * This function clears the screen, draws a render snapshot and presents it. When the
+        * snapshot's world is drawn at a lower resolution, it is drawn into the corner of the
+        * world target, which is then stretched over the window. The weapon icon and the
+        * interface are drawn over it at the window's resolution, so that text stays sharp.
+        */
+        void present(const RenderSnapshot& snapshot)
+        {
+            SDL_RenderClear(renderer);
+
+            const float scale = snapshot.getScale();
+            if (scale < 1.0f && world_target != nullptr)
+            {
+                // Setting a render target resets the scale, so it is set afterwards.
+                SDL_SetRenderTarget(renderer, world_target);
+                SDL_RenderClear(renderer);
+                SDL_RenderSetScale(renderer, scale, scale);
+                snapshot.submit(renderer, rotation_cache.get(), RenderSnapshot::Layer::Map, RenderSnapshot::Layer::Weapon);
+                SDL_SetRenderTarget(renderer, nullptr);
+
+                const SDL_Rect source = {0, 0, static_cast<int>(std::ceil(window_size.x * scale)), static_cast<int>(std::ceil(window_size.y * scale))};
+                SDL_RenderCopy(renderer, world_target, &source, nullptr);
+                snapshot.submit(renderer, rotation_cache.get(), RenderSnapshot::Layer::Weapon);
+            }
+            else
+            {
+                snapshot.submit(renderer, rotation_cache.get());
+            }
+
+            SDL_RenderPresent(renderer);
+
+            // Time how long the frame's input took to be seen, the first time it is presented.
+            if (snapshot.getTick() != presented_tick)
+            {
+                presented_tick = snapshot.getTick();
+                const std::uint32_t now = SDL_GetTicks();
+                if (snapshot.getInputTime() != 0)
+                {
+                    input_latency = (now - snapshot.getInputTime()) * 1000.0f;
+                }
+                if (snapshot.getAimTime() != 0)
+                {
+                    aim_latency = (now - snapshot.getAimTime()) * 1000.0f;
+                }
+            }
+        }
+
+        /**
+        * This function runs every task waiting for the main thread and sets the window
+        * title if it has changed. Anything a task does to textures might be used by the
+        * snapshots that have already been published, so those are no longer drawn.
+        */
+        void runMainThreadTasks()
+        {
+            std::lock_guard<std::mutex> lock(task_mutex);
+            if (!main_thread_tasks.empty())
+            {
+                for (MainThreadTask* task : main_thread_tasks)
+                {
+                    try
+                    {
+                        (*task->function)();
+                    }
+                    catch (...)
+                    {
+                        task->error = std::current_exception();
+                        task->error_message = SDL_GetError();
+                    }
+                    task->done = true;
+                }
+                main_thread_tasks.clear();
+                oldest_drawable_tick = tick.load();
+                task_condition.notify_all();
+            }
+
+            if (window_title_changed)
+            {
+                SDL_SetWindowTitle(window, pending_window_title.c_str());
+                window_title_changed = false;
+            }
+        }
+
+        /**
+        * This function waits while the game is idle, handling events as they arrive so that
+        * it knows when to carry on. Nothing is updated, so no ticks pass. When the game isn't
+        * threaded it sleeps on SDL's event queue and draws the last frame again if the window
+        * needs it, and when it is threaded the main thread wakes it whenever it passes on an
+        * event.
+        */
+        void idle()
+        {
+            while (running && isIdle())
+            {
+                if (threaded)
+                {
+                    std::unique_lock<std::mutex> lock(idle_mutex);
+                    idle_condition.wait_for(lock, std::chrono::milliseconds(IDLE_WAIT_TIME), []() { return idle_wake; });
+                    idle_wake = false;
+                }
+                else
+                {
+                    // Without an event to fill in, SDL leaves the event in the queue for handleEvents.
+                    SDL_WaitEventTimeout(nullptr, IDLE_WAIT_TIME);
+                }
+
+                handleEvents();
+
+                // Nothing is drawn for input handled while idle, so it isn't timed.
+                input_time = 0;
+
+                if (!threaded && window_exposed.exchange(false) && render_snapshot != nullptr)
+                {
+                    present(*render_snapshot);
+                }
+            }
+        }
+
+        /**
+        * This function runs the game until it stops. Each tick it waits for the frame rate
+        * limit, handles events, updates the current state and records what the state draws
+        * into a render snapshot. When the game is threaded this runs on the simulation
+        * thread and the snapshot is published for the main thread, otherwise the snapshot
+        * is presented straight away.
+        */
+        void simulate()
+        {
+            // These are used to time each part of the frame precisely.
+            const double ticks_per_microsecond = SDL_GetPerformanceFrequency() / 1000000.0;
+            Uint64 frame_start = SDL_GetPerformanceCounter();
+            Uint64 section_start = 0;
+            auto endSection = [&](float& timing)
+            {
+                Uint64 now = SDL_GetPerformanceCounter();
+                timing = (now - section_start) / ticks_per_microsecond;
+                section_start = now;
+            };
+
+            // Loading before the first frame shouldn't make it look late.
+            frame_pacer.reset();
+
+            while (running)
+            {
+                if (isIdle())
+                {
+                    idle();
+
+                    // Carry on as if the frame had only just started, so that the time spent
+                    // idle isn't simulated in one go or counted as a long frame, including by the
+                    // profiler and flight recorder.
+                    frame_pacer.reset();
+                    frame_start = SDL_GetPerformanceCounter();
+                    PROFILE_RESTART_FRAME();
+                    continue;
+                }
+
+                PROFILE_FRAME();
+                FlightRecorder::recordFrame(Profiler::getLastFrame());
+                PROFILE_ZONE("Application::run");
+                tick++;
+
+                // Wait until the frame is due for the frame rate limit.
+                {
+                    PROFILE_ZONE("FramePacer::wait");
+                    frame_pacer.wait();
+                }
+                frame_timings.pacing_error = frame_pacer.getError();
+                PROFILE_COUNTER("Pacing error", frame_pacer.getError() / 1000.0);
+
+                // Work out the time since the last frame.
+                section_start = SDL_GetPerformanceCounter();
+                frame_timings.frame = (section_start - frame_start) / ticks_per_microsecond;
+                frame_start = section_start;
+
+                // Calculate the current frame rate.
+                frame_rate = frame_timings.frame > 0.0 ? 1000000.0 / frame_timings.frame : 0;
+
+                // Calculate the current delta time.
+                delta_time = fixed_delta_time > 0.0 ? fixed_delta_time : frame_timings.frame / 1000000.0;
+
+                handleEvents();
+                endSection(frame_timings.events);
+
+                if (!paused)
+                {
+                    current_state->update();
+                }
+                endSection(frame_timings.update);
+
+                render_snapshot = &render_snapshots.getWriteBuffer();
+                render_snapshot->clear(tick, {0, 0, window_size.x, window_size.y}, resolution_scaler.getScale());
+                frame_timings.resolution_scale = resolution_scaler.getScale();
+                frame_timings.resolution_budget = resolution_scaler.getBudget();
+                latchMousePosition();
+                if (!headless)
+                {
+                    current_state->draw();
+                }
+                render_snapshot->sort();
+
+                const RenderSnapshot::Statistics& render_statistics = render_snapshot->getStatistics();
+                frame_timings.draw_calls = render_statistics.commands;
+                frame_timings.batches = render_statistics.batches;
+                frame_timings.culled = render_statistics.culled;
+                Telemetry::add(Telemetry::Counter::DrawCalls, render_statistics.commands);
+                PROFILE_COUNTER("Draw calls", render_statistics.commands);
+                PROFILE_COUNTER("Batches", render_statistics.batches);
+
+                if (!render_dump_file.empty())
+                {
+                    runOnMainThread([]()
+                    {
+                        if (render_snapshot->write(render_dump_file))
+                        {
+                            LOG_INFO(Diagnostics, "Wrote the render snapshot for tick " << render_snapshot->getTick() << " to: " << render_dump_file);
+                        }
+                        else
+                        {
+                            LOG_WARNING(Diagnostics, "Unable to write the render snapshot to: " << render_dump_file);
+                        }
+                    });
+                    render_dump_file.clear();
+                }
+                endSection(frame_timings.draw);
+
+                if (threaded)
+                {
+                    render_snapshots.publish();
+                    wakeMainThread();
+                    frame_timings.present = present_time;
+                }
+                else
+                {
+                    if (!headless)
+                    {
+                        PROFILE_ZONE("SDL_RenderPresent");
+                        present(*render_snapshot);
+                    }
+                    endSection(frame_timings.present);
+                }
+                frame_timings.input_latency = input_latency;
+                frame_timings.aim_latency = aim_latency;
+                PROFILE_COUNTER("Input latency", input_latency / 1000.0);
+
+                // Only the time spent drawing counts towards the resolution budget, since the
+                // resolution makes no difference to handling events or updating the game. When
+                // the game is threaded the snapshot is drawn on the main thread while the next
+                // frame is simulated, so only the main thread's time counts.
+                if (!headless)
+                {
+                    const float draw_time = threaded ? frame_timings.present : frame_timings.draw + frame_timings.present;
+                    resolution_scaler.addFrame(draw_time / 1000.0);
+                }
+
+                Memory::endFrame();
+                PROFILE_COUNTER("Allocations", Memory::getFrameAllocations());
+                Telemetry::endFrame(frame_timings.frame);
+
+                Replay::endFrame(frame_timings.events + frame_timings.update + frame_timings.draw + frame_timings.present);
+
+                // The allocation test and replays end the game once they have run for long enough.
+                if (Memory::isAllocationTestFinished() || Replay::isFinished())
+                {
+                    running = false;
+                }
+            }
+        }
+
+        /**
+        * This function runs the game with the simulation on its own thread. The main thread
+        * passes SDL events on to the simulation, runs the tasks it asks for and presents
+        * the newest render snapshot whenever there is one. The simulation is profiled
+        * instead of the main thread, and any error it throws is thrown again here.
+        */
+        void runThreaded()
+        {
+            std::atomic<bool> simulation_finished{false};
+            std::exception_ptr simulation_error;
+            std::string simulation_error_message;
+
+            std::thread simulation_thread([&]()
+            {
+                Profiler::setThread();
+                try
+                {
+                    simulate();
+                }
+                catch (...)
+                {
+                    simulation_error = std::current_exception();
+                    simulation_error_message = SDL_GetError();
+                    running = false;
+                }
+                simulation_finished = true;
+            });
+
+            const double ticks_per_microsecond = SDL_GetPerformanceFrequency() / 1000000.0;
+            SDL_Event main_event;
+            bool holding_event = false;
+            SDL_Event waiting_motion;
+            bool motion_waiting = false;
+
+            // The main thread keeps running tasks until the simulation has finished, since
+            // it may still need them while it stops.
+            while (!simulation_finished)
+            {
+                // If the simulation has fallen behind and the queue is full, the event is
+                // held until there is room and SDL keeps the rest. Mouse motion is folded
+                // into one event until another event has to be passed on after it, so that a
+                // mouse sending thousands of events a second doesn't fill the queue.
+                bool passed_event = false;
+                SDL_PumpEvents();
+                while (holding_event || SDL_PeepEvents(&main_event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0)
+                {
+                    if (!holding_event)
+                    {
+                        // User events are only sent to wake this thread up.
+                        if (main_event.type == SDL_USEREVENT)
+                        {
+                            continue;
+                        }
+                        if (main_event.type == SDL_WINDOWEVENT)
+                        {
+                            handleWindowEvent(main_event);
+                        }
+                        else if (main_event.type == SDL_MOUSEMOTION)
+                        {
+                            // Keep the newest position for late latching, which can be ahead
+                            // of the events the simulation has handled.
+                            latest_mouse = (static_cast<std::uint64_t>(static_cast<std::uint16_t>(main_event.motion.x)) << 48) |
+                                           (static_cast<std::uint64_t>(static_cast<std::uint16_t>(main_event.motion.y)) << 32) |
+                                           main_event.motion.timestamp;
+
+                            if (motion_waiting)
+                            {
+                                main_event.motion.xrel += waiting_motion.motion.xrel;
+                                main_event.motion.yrel += waiting_motion.motion.yrel;
+                            }
+                            waiting_motion = main_event;
+                            motion_waiting = true;
+                            continue;
+                        }
+                    }
+
+                    if (motion_waiting && event_queue.push(waiting_motion))
+                    {
+                        motion_waiting = false;
+                        passed_event = true;
+                    }
+                    holding_event = motion_waiting || !event_queue.push(main_event);
+                    if (holding_event)
+                    {
+                        break;
+                    }
+                    passed_event = true;
+                }
+                if (motion_waiting && event_queue.push(waiting_motion))
+                {
+                    motion_waiting = false;
+                    passed_event = true;
+                }
+
+                // The simulation sleeps while the game is idle, until it has events to handle.
+                if (passed_event)
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(idle_mutex);
+                        idle_wake = true;
+                    }
+                    idle_condition.notify_one();
+                }
+
+                runMainThreadTasks();
+
+                if (render_snapshots.update() && render_snapshots.getReadBuffer().getTick() >= oldest_drawable_tick)
+                {
+                    Uint64 present_start = SDL_GetPerformanceCounter();
+                    present(render_snapshots.getReadBuffer());
+                    present_time = (SDL_GetPerformanceCounter() - present_start) / ticks_per_microsecond;
+                }
+                else
+                {
+                    // Sleep until there is an event, a task or a new snapshot to present. The
+                    // simulation sends an event whenever it publishes a snapshot, so it is
+                    // presented as soon as it is ready instead of when a polling sleep ends.
+                    SDL_WaitEventTimeout(nullptr, IDLE_WAIT_TIME);
+                    if (isIdle() && window_exposed.exchange(false) && render_snapshots.getReadBuffer().getTick() >= oldest_drawable_tick)
+                    {
+                        present(render_snapshots.getReadBuffer());
+                    }
+                }
+            }
+
+            simulation_thread.join();
+            Profiler::setThread();
+
+            if (simulation_error)
+            {
+                SDL_SetError("%s", simulation_error_message.c_str());
+                std::rethrow_exception(simulation_error);
+            }
+        }
     }
 
     /**
@@ -124,6 +797,8 @@ namespace Application
             throw Error::SDL;
         }
 
+        Profiler::startUp();
+
         // Initialize SDL_image.
         if ((IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) != IMG_INIT_PNG)
         {
@@ -168,7 +843,9 @@ namespace Application
 
         running = true;
         frame_rate_limit = fps_limit;
+        frame_pacer.setRate(fps_limit);
         frame_rate = 0;
+        main_thread_id = std::this_thread::get_id();
     }
 
     /**
@@ -200,50 +877,15 @@ namespace Application
     */
     void run()
     {
-        int last_time = 0;
-        int current_time = 0;
-        int frame_time = 0;
-
         current_state->startUp();
-        while (running)
+        if (threaded && !headless)
         {
-            // Work out the time since the last frame.
-            last_time = current_time;
-            current_time = SDL_GetTicks();
-            frame_time = current_time - last_time;
-
-            // Limit the framerate based on the time since the last frame.
-            if ((1000.0 / frame_rate_limit) > frame_time)
-            {
-                SDL_Delay((1000.0 / frame_rate_limit) - frame_time);
-            }
-
-            // Calculate the current frame rate.
-            frame_rate = 1000.0 / frame_time;
-
-            // Calculate the current delta time.
-            delta_time = frame_time / 1000.0;
-
-            while (SDL_PollEvent(&event))
-            {
-                if (event.type == SDL_QUIT)
-                {
-                    running = false;
-                }
-                else if (event.type == SDL_MOUSEMOTION)
-                {
-                    // Keep track of the position of the mouse.
-                    mouse_position.x = event.motion.x;
-                    mouse_position.y = event.motion.y;
-                }
-                current_state->handleEvents();
-            }
-
-            current_state->update();
-
-            SDL_RenderClear(renderer);
-            current_state->draw();
-            SDL_RenderPresent(renderer);
+            runThreaded();
+        }
+        else
+        {
+            threaded = false;
+            simulate();
         }
         current_state->shutDown();
     }
@@ -254,29 +896,45 @@ namespace Application
     */
     void shutDown()
     {
+        Profiler::stopCapture();
+        Telemetry::shutDown();
+        FlightRecorder::shutDown();
+
         for (auto& texture : textures)
         {
-            DEBUG("Unloading texture: " << texture.first);
+            LOG_DEBUG(Resource, "Unloading texture: " << texture.first);
+            Memory::addExternal(Memory::Tag::Texture, -getTextureBytes(texture.second));
             SDL_DestroyTexture(texture.second);
         }
 
         for (auto& sound : sounds)
         {
-            DEBUG("Unloading sound: " << sound.first);
+            LOG_DEBUG(Resource, "Unloading sound: " << sound.first);
             Mix_FreeChunk(sound.second);
         }
 
+        glyph_atlases.clear();
+        rotation_cache.reset();
+
+        if (world_target != nullptr)
+        {
+            Memory::addExternal(Memory::Tag::Texture, -getTextureBytes(world_target));
+            SDL_DestroyTexture(world_target);
+            world_target = nullptr;
+        }
+
         for (auto& font : fonts)
         {
             for (auto& font_it : font.second)
             {
-                DEBUG("Unloading font, size " << font_it.first << ": " << font.first);
+                LOG_DEBUG(Resource, "Unloading font, size " << font_it.first << ": " << font.first);
                 TTF_CloseFont(font_it.second);
             }
         }
 
         SDL_DestroyRenderer(renderer);
         SDL_DestroyWindow(window);
+        renderer = nullptr;
 
         TTF_Quit();
         Mix_CloseAudio();
@@ -286,23 +944,156 @@ namespace Application
 
     /**
     * This function loads a texture and then caches it, so that the next time the texture is
-    * needed it is available immediately.
+    * needed it is available immediately. The file name is a string_view so that looking up a
+    * texture that is already cached never allocates.
     */
-    SDL_Texture* getTexture(const std::string& file_name)
+    SDL_Texture* getTexture(const std::string_view file_name)
+    {
+        auto texture = textures.find(file_name);
+        if (texture == textures.end())
+        {
+            LOG_DEBUG(Resource, "Loading texture: " << file_name);
+            Telemetry::add(Telemetry::Counter::TextureLoads);
+            Memory::TagScope tag_scope(Memory::Tag::Resource);
+
+            std::string name(file_name);
+            SDL_Texture* loaded_texture = nullptr;
+            runOnMainThread([&]()
+            {
+                Memory::TagScope main_thread_tag_scope(Memory::Tag::Resource);
+                loaded_texture = IMG_LoadTexture(renderer, name.c_str());
+                if (loaded_texture == nullptr)
+                {
+                    throw Error::IMG;
+                }
+                addSprite(loaded_texture);
+            });
+            Memory::addExternal(Memory::Tag::Texture, getTextureBytes(loaded_texture));
+            texture = textures.emplace(std::move(name), loaded_texture).first;
+        }
+        return texture->second;
+    }
+
+    /**
+    * This function turns an image that has already been loaded into a texture and caches
+    * it under its file name, unless that file is already cached. This lets images be
+    * decoded on another thread, since textures can only be made on the main thread.
+    */
+    SDL_Texture* addTexture(const std::string& file_name, SDL_Surface* surface)
     {
         if (textures.find(file_name) == textures.end())
         {
-            DEBUG("Loading texture: " << file_name);
+            LOG_DEBUG(Resource, "Uploading texture: " << file_name);
+            Telemetry::add(Telemetry::Counter::TextureLoads);
+            Memory::TagScope tag_scope(Memory::Tag::Resource);
 
-            textures[file_name] = IMG_LoadTexture(renderer, file_name.c_str());
-            if (textures[file_name] == nullptr)
+            SDL_Texture* texture = nullptr;
+            runOnMainThread([&]()
             {
-                throw Error::IMG;
-            }
+                Memory::TagScope main_thread_tag_scope(Memory::Tag::Resource);
+                texture = SDL_CreateTextureFromSurface(renderer, surface);
+                if (texture == nullptr)
+                {
+                    throw Error::SDL;
+                }
+                addSprite(texture);
+            });
+            textures[file_name] = texture;
+            Memory::addExternal(Memory::Tag::Texture, getTextureBytes(textures[file_name]));
         }
         return textures[file_name];
     }
 
+    /**
+    * This function returns roughly how much video memory a texture uses, assuming that
+    * every pixel takes four bytes.
+    */
+    std::int64_t getTextureBytes(SDL_Texture* texture)
+    {
+        int width = 0;
+        int height = 0;
+        SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+        return static_cast<std::int64_t>(width) * height * 4;
+    }
+
+    /**
+    * This function returns the file name a texture was cached under, or an empty string
+    * if the texture isn't in the cache.
+    */
+    std::string getTextureName(SDL_Texture* texture)
+    {
+        for (auto& cached_texture : textures)
+        {
+            if (cached_texture.second == texture)
+            {
+                return cached_texture.first;
+            }
+        }
+        return "";
+    }
+
+    /**
+    * This function gives a texture a sprite id, so that render snapshots can draw it.
+    * Every texture the Application namespace loads is given one, but textures made
+    * anywhere else have to be added here, and removed before they are destroyed. Both
+    * can only be done on the main thread.
+    */
+    std::uint16_t addSprite(SDL_Texture* texture)
+    {
+        std::uint16_t sprite;
+        if (!free_sprites.empty())
+        {
+            sprite = free_sprites.back();
+            free_sprites.pop_back();
+            sprites[sprite] = texture;
+        }
+        else if (sprites.size() <= UINT16_MAX)
+        {
+            sprite = sprites.size();
+            sprites.push_back(texture);
+        }
+        else
+        {
+            LOG_WARNING(Resource, "Out of sprite ids, a texture won't be drawn");
+            return RenderSnapshot::NO_SPRITE;
+        }
+
+        // The id is kept on the texture, so finding it while drawing is just a lookup.
+        SDL_SetTextureUserData(texture, reinterpret_cast<void*>(static_cast<std::uintptr_t>(sprite)));
+        return sprite;
+    }
+
+    /**
+    * This function frees a texture's sprite id so that it can be given to another texture.
+    */
+    void removeSprite(SDL_Texture* texture)
+    {
+        const std::uint16_t sprite = getSpriteId(texture);
+        if (sprite != RenderSnapshot::NO_SPRITE)
+        {
+            sprites[sprite] = nullptr;
+            free_sprites.push_back(sprite);
+            SDL_SetTextureUserData(texture, nullptr);
+        }
+    }
+
+    /**
+    * This function returns the texture for a sprite id.
+    */
+    SDL_Texture* getSprite(const std::uint16_t sprite)
+    {
+        return sprites[sprite];
+    }
+
+    /**
+    * This function returns a texture's sprite id, or RenderSnapshot::NO_SPRITE if it
+    * hasn't been added.
+    */
+    std::uint16_t getSpriteId(SDL_Texture* texture)
+    {
+        return static_cast<std::uint16_t>(reinterpret_cast<std::uintptr_t>(SDL_GetTextureUserData(texture)));
+    }
+
     /**
     * This function loads a sound and then caches it, so that the next time the sound is
     * needed it is available immediately.
@@ -311,7 +1102,8 @@ namespace Application
     {
         if (sounds.find(file_name) == sounds.end())
         {
-            DEBUG("Loading sound: " << file_name);
+            LOG_DEBUG(Resource, "Loading sound: " << file_name);
+            Memory::TagScope tag_scope(Memory::Tag::Resource);
 
             sounds[file_name] = Mix_LoadWAV(file_name.c_str());
             if (sounds[file_name] == nullptr)
@@ -331,7 +1123,8 @@ namespace Application
     {
         if (fonts.find(file_name) == fonts.end() || fonts.find(file_name)->second.find(font_size) == fonts.find(file_name)->second.end())
         {
-            DEBUG("Loading font, size " << font_size << ": " << file_name);
+            LOG_DEBUG(Resource, "Loading font, size " << font_size << ": " << file_name);
+            Memory::TagScope tag_scope(Memory::Tag::Resource);
 
             fonts[file_name][font_size] = TTF_OpenFont(file_name.c_str(), font_size);
             if (fonts[file_name][font_size] == nullptr)
@@ -342,6 +1135,27 @@ namespace Application
         return fonts[file_name][font_size];
     }
 
+    /**
+    * This function returns the glyph atlas for a font, creating it the first time it is
+    * needed. Since fonts are cached by name and size, there is one atlas for each of them.
+    */
+    GlyphAtlas& getGlyphAtlas(TTF_Font* font)
+    {
+        if (glyph_atlases.find(font) == glyph_atlases.end())
+        {
+            LOG_DEBUG(Resource, "Building glyph atlas for font: " << font);
+            Telemetry::add(Telemetry::Counter::TextureLoads);
+            Memory::TagScope tag_scope(Memory::Tag::Resource);
+
+            runOnMainThread([&]()
+            {
+                Memory::TagScope main_thread_tag_scope(Memory::Tag::Resource);
+                glyph_atlases[font] = std::make_unique<GlyphAtlas>(font);
+            });
+        }
+        return *glyph_atlases[font];
+    }
+
     /**
     * This function returns the game window.
     */
@@ -359,11 +1173,12 @@ namespace Application
     }
 
     /**
-    * This function returns to the game's event.
+    * This function returns the input for this frame. States should handle it in their
+    * handleEvents method, which is called once a frame.
     */
-    const SDL_Event& getEvent()
+    const InputFrame& getInput()
     {
-        return event;
+        return input_frame;
     }
 
     /**
@@ -382,6 +1197,17 @@ namespace Application
         return mouse_position;
     }
 
+    /**
+    * This function returns the position of the mouse to draw with. With late latching it
+    * is read again just before the frame is drawn, so it can be newer than the position
+    * from getMousePosition. It isn't recorded in replays, so it must only be used for
+    * drawing and never to change the game.
+    */
+    const SDL_Point& getDrawMousePosition()
+    {
+        return draw_mouse_position;
+    }
+
     /**
     * This function returns the game camera for drawing and editing.
     */
@@ -415,6 +1241,214 @@ namespace Application
         return delta_time;
     }
 
+    /**
+    * This function makes every frame step the game by the same amount of time, no matter
+    * how long the frame really took, so that the game plays out the same every time. A
+    * delta time of 0 goes back to using the real time between frames.
+    */
+    void setFixedDeltaTime(const float delta_time)
+    {
+        fixed_delta_time = delta_time;
+    }
+
+    /**
+    * This function sets the most frames that are run each second. A limit of 0 runs frames
+    * as fast as possible.
+    */
+    void setFrameRateLimit(const int fps_limit)
+    {
+        frame_rate_limit = fps_limit;
+        frame_pacer.setRate(fps_limit);
+    }
+
+    /**
+    * This function hides the window and stops drawing anything, so that the game only
+    * updates. The renderer is still made, since levels need it to load.
+    */
+    void setHeadless(const bool headless)
+    {
+        Application::headless = headless;
+        if (headless)
+        {
+            SDL_HideWindow(window);
+        }
+        else
+        {
+            SDL_ShowWindow(window);
+        }
+    }
+
+    /**
+    * This function sets whether states are updated on their own simulation thread, so
+    * that the simulation and drawing don't hold each other up. It must be set before run
+    * is called, and is ignored when the game is headless.
+    */
+    void setThreaded(const bool threaded)
+    {
+        Application::threaded = threaded;
+    }
+
+    /**
+    * This function sets whether the game stops updating and drawing while its window is
+    * hidden, minimised or doesn't have focus. It carries on as soon as the window is back.
+    */
+    void setPauseWhenUnfocused(const bool pause_when_unfocused)
+    {
+        Application::pause_when_unfocused = pause_when_unfocused;
+    }
+
+    /**
+    * This function pauses or unpauses the game. States are still drawn on the frame the
+    * game is paused, but aren't updated, and then the game sleeps until it is unpaused.
+    */
+    void setPaused(const bool paused)
+    {
+        Application::paused = paused;
+    }
+
+    /**
+    * This function returns true if the game is paused.
+    */
+    bool isPaused()
+    {
+        return paused;
+    }
+
+    /**
+    * This function sets whether the mouse is read again just before each frame is drawn,
+    * after the frame rate limit and the update, rather than only when its events are
+    * handled. It makes what is drawn follow the mouse more closely without drawing more
+    * often. Replays are always drawn with the mouse from their events.
+    */
+    void setLateLatch(const bool late_latch)
+    {
+        Application::late_latch = late_latch;
+    }
+
+    /**
+    * This function sets how many angles rotated sprites are rendered at ahead of time, so
+    * that they can be drawn without being rotated every frame. This is much faster with
+    * SDL's software renderer. An angle count of 0 turns it off, and every rotated sprite
+    * is rotated as it is drawn.
+    */
+    void setSpriteRotations(const int angle_count)
+    {
+        rotation_cache.reset();
+        if (angle_count > 0)
+        {
+            rotation_cache = std::make_unique<RotationCache>(angle_count);
+        }
+    }
+
+    /**
+    * This function sets the resolution the world is drawn at, as a fraction of the window's,
+    * while the weapon icon and the interface are always drawn at the window's resolution.
+    * If the budget is more than 0, the scale changes between min_scale and max_scale to
+    * keep the time each frame takes under the budget, in milliseconds. It must be called
+    * on the main thread before run is called.
+    */
+    void setResolutionScale(const float max_scale, const float min_scale, const float budget)
+    {
+        resolution_scaler.setup(max_scale, min_scale, budget);
+        if (resolution_scaler.getScale() == 1.0f && resolution_scaler.getBudget() <= 0.0f)
+        {
+            return;
+        }
+
+        if (world_target == nullptr)
+        {
+            world_target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, window_size.x, window_size.y);
+            if (world_target == nullptr)
+            {
+                LOG_WARNING(Resource, "Unable to create the world render target, the world will be drawn at full resolution: " << SDL_GetError());
+                resolution_scaler.setup(1.0, 1.0, 0.0);
+                return;
+            }
+
+            // The world covers the whole window, so it doesn't need blending, and it is
+            // filtered as it is stretched so that it doesn't look blocky.
+            SDL_SetTextureBlendMode(world_target, SDL_BLENDMODE_NONE);
+            SDL_SetTextureScaleMode(world_target, SDL_ScaleModeLinear);
+            Memory::addExternal(Memory::Tag::Texture, getTextureBytes(world_target));
+        }
+    }
+
+    /**
+    * This function runs a task on the main thread and waits for it to finish. Anything
+    * that uses the renderer, like making textures, has to be run this way, since the
+    * renderer can only be used from the main thread. Errors thrown by the task are thrown
+    * again on the calling thread. On the main thread the task is just run.
+    */
+    void runOnMainThread(const std::function<void()>& task)
+    {
+        if (!threaded || std::this_thread::get_id() == main_thread_id)
+        {
+            task();
+            return;
+        }
+
+        MainThreadTask main_thread_task = {&task, false, nullptr, ""};
+        {
+            std::unique_lock<std::mutex> lock(task_mutex);
+            main_thread_tasks.push_back(&main_thread_task);
+
+            wakeMainThread();
+            task_condition.wait(lock, [&]() { return main_thread_task.done; });
+        }
+
+        // SDL errors are kept per thread, so the task's error is set again on this one.
+        if (main_thread_task.error)
+        {
+            SDL_SetError("%s", main_thread_task.error_message.c_str());
+            std::rethrow_exception(main_thread_task.error);
+        }
+    }
+
+    /**
+    * This function draws a texture on a layer, rotated about its centre by an angle in
+    * degrees clockwise. Like every function below, it records a command into the frame's
+    * render snapshot rather than drawing straight away, and it can only be used while a
+    * state is drawing.
+    */
+    void drawTexture(const RenderSnapshot::Layer layer, SDL_Texture* texture, const SDL_Rect& destination, const float angle)
+    {
+        render_snapshot->addSprite(layer, getSpriteId(texture), destination, angle);
+    }
+
+    /**
+    * This function draws triangles from a texture on a layer, such as a line of text.
+    */
+    void drawGeometry(const RenderSnapshot::Layer layer, SDL_Texture* texture, const SDL_Vertex* vertices, const int vertex_count,
+                      const int* indices, const int index_count)
+    {
+        render_snapshot->addGeometry(layer, getSpriteId(texture), vertices, vertex_count, indices, index_count);
+    }
+
+    /**
+    * This function draws filled rects in one colour on a layer, blended by the colour's alpha.
+    */
+    void fillRects(const RenderSnapshot::Layer layer, const SDL_Rect* rects, const int count, const SDL_Color& colour)
+    {
+        render_snapshot->addRects(layer, rects, count, colour);
+    }
+
+    /**
+    * This function draws a line in one colour on a layer.
+    */
+    void drawLine(const RenderSnapshot::Layer layer, const SDL_Point& start, const SDL_Point& end, const SDL_Color& colour)
+    {
+        render_snapshot->addLine(layer, start, end, colour);
+    }
+
+    /**
+    * This function writes the next frame's render snapshot to a file once it has been
+    * recorded, so that it can be looked at or drawn again by the RenderBenchmark tool.
+    */
+    void dumpRenderSnapshot(const std::string& file_name)
+    {
+        render_dump_file = file_name;
+    }
+
     /**
     * This function ends the game by stopping the main loop.
     */
@@ -437,7 +1471,17 @@ namespace Application
     void setWindowTitle(const std::string& title)
     {
         window_title = title;
-        SDL_SetWindowTitle(window, window_title.c_str());
+        if (!threaded || std::this_thread::get_id() == main_thread_id)
+        {
+            SDL_SetWindowTitle(window, window_title.c_str());
+            return;
+        }
+
+        // The title is set by the main thread the next time it runs its tasks. Nothing
+        // waits for it, so the simulation isn't held up.
+        std::lock_guard<std::mutex> lock(task_mutex);
+        pending_window_title = window_title;
+        window_title_changed = true;
     }
 
     /**
@@ -447,4 +1491,12 @@ namespace Application
     {
         return frame_rate;
     }
+
+    /**
+    * This function returns how long each part of the last frame took.
+    */
+    const FrameTimings& getFrameTimings()
+    {
+        return frame_timings;
+    }
 }
@@ -1,6 +1,7 @@
 #include "Boss.h"
 #include "Player.h"
 #include "Level.h"
+#include "Random.h"
 
 Boss::Boss(const SDL_Rect& rect) : Enemy(rect, Application::getTexture("Resources/Images/Boss.png"), 250, 500)
 {
@@ -16,12 +17,19 @@ void Boss::update(Level* level, Player& player)
         if (attack_timer >= ATTACK_TIME)
         {
             attack_timer = 0.0;
-            if (!Tools::getRandomInt(0, 3))
+            if (!Random::get(Random::Stream::AI).getInt(0, 3))
             {
-                for (int i = 0; i < 3; i++)
+                // The whole volley's spread is worked out in one go, like the shotgun's.
+                int spreads[VOLLEY_SIZE];
+                Maths::Vec2 directions[VOLLEY_SIZE];
+                Random::get(Random::Stream::EnemySpread).getInts(spreads, VOLLEY_SIZE, -VOLLEY_SPREAD, VOLLEY_SPREAD);
+                Maths::rotate(facing, spreads, directions, VOLLEY_SIZE);
+
+                SDL_Texture* texture = Application::getTexture("Resources/Images/PlasmaBall.png");
+                for (int i = 0; i < VOLLEY_SIZE; i++)
                 {
-                    level->getEnemyProjectiles().emplace_back(Application::getTexture("Resources/Images/PlasmaBall.png"),
-                                                          rect.x + (rect.w / 2), rect.y + (rect.h / 2), angle, 20, 1000, 25);
+                    level->getEnemyProjectiles().emplace_back(texture, rect.x + (rect.w / 2), rect.y + (rect.h / 2),
+                                                          directions[i], 20, 1000, 0, Random::Stream::EnemySpread);
                 }
             }
         }
@@ -1,6 +1,7 @@
 #include "Enemy.h"
 #include "Level.h"
 #include "Player.h"
+#include "Random.h"
 
 /**
 * The constructor sets the starting rect of the enemy.
@@ -22,101 +23,106 @@ Enemy::Enemy(const SDL_Rect& rect, SDL_Texture* texture, const int speed, const
     // Set the delay needed for getting the next path to the player.
     // This is random to stop every enemy from switching direction at once,
     // it adds some individuality to the enemies.
-    ai_time = Tools::getRandomFloat(AI_TIME_MINIMUM, AI_TIME_MAXIMUM);
+    ai_time = Random::get(Random::Stream::Spawns).getFloat(AI_TIME_MINIMUM, AI_TIME_MAXIMUM);
 }
 
 /**
-* This method needs to know about the level and where the player is. This
-* method handles all collisions and AI (not pathfinding however).
+* This method spots the player and follows the enemy's path. It fills in the points the
+* enemy faces from and towards, which are its centre, the centre of the next node in its
+* path and the centre of the player, so that Level::update can work out the directions
+* for every enemy at once.
 */
-void Enemy::update(Level* level, Player& player)
+void Enemy::think(Level* level, Player& player, Maths::Vec2& centre, Maths::Vec2& node_centre, Maths::Vec2& player_centre)
 {
-    x1 = rect.x + (rect.w / 2);
-    y1 = rect.y + (rect.h / 2);
-    x2 = player.getRect().x + (player.getRect().w / 2);
-    y2 = player.getRect().y + (player.getRect().h / 2);
-
+    const SDL_Point enemy_centre = {rect.x + (rect.w / 2), rect.y + (rect.h / 2)};
+    const SDL_Point target_centre = {player.getRect().x + (player.getRect().w / 2), player.getRect().y + (player.getRect().h / 2)};
+    centre = Maths::toVec2(enemy_centre);
+    node_centre = centre;
+    player_centre = Maths::toVec2(target_centre);
+
+    // An enemy only starts moving the frame after it sees the player.
+    moving = alerted;
     if (!alerted)
     {
         // If there are no walls blocking the enemy's line of sight, then it can see the player.
-        if (std::all_of(level->getWallRects().begin(),
-                        level->getWallRects().end(),
-                        [&](const SDL_Rect& wall){return !SDL_IntersectRectAndLine(&wall, &x1, &y1, &x2, &y2);}))
+        if (level->hasLineOfSight(enemy_centre, target_centre))
         {
             alerted = true;
         }
+        return;
+    }
+
+    ai_timer += Application::getDeltaTime();
+    if (current_path.empty() || ai_timer >= ai_time)
+    {
+        ai_timer = 0.0;
+        level->getPathToTile({rect.x / level->TILE_SIZE, rect.y / level->TILE_SIZE}, current_path);
+        current_path.pop_back();
 
+        node_rect = {(current_path.back().x * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
+                     (current_path.back().y * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
+                     NODE_SIZE, NODE_SIZE};
     }
-    else
+
+    // If the center of the enemy is in the next node in the path.
+    if ((enemy_centre.x > node_rect.x) &&
+        (enemy_centre.x < node_rect.x + node_rect.w) &&
+        (enemy_centre.y > node_rect.y) &&
+        (enemy_centre.y < node_rect.y + node_rect.h))
     {
-        ai_timer += Application::getDeltaTime();
-        if (current_path.empty() || ai_timer >= ai_time)
-        {
-            ai_timer = 0.0;
-            current_path = level->getPathToTile({rect.x / level->TILE_SIZE, rect.y / level->TILE_SIZE});
-            current_path.pop_back();
+        current_path.pop_back();
 
-            node_rect = {(current_path.back().x * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
-                         (current_path.back().y * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
-                         NODE_SIZE, NODE_SIZE};
-        }
+        node_rect = {(current_path.back().x * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
+                     (current_path.back().y * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
+                     NODE_SIZE, NODE_SIZE};
+    }
 
-        // If the center of the enemy is in the next node in the path.
-        if (((rect.x + (rect.w / 2)) > node_rect.x) &&
-            ((rect.x + (rect.w / 2)) < node_rect.x + node_rect.w) &&
-            ((rect.y + (rect.h / 2)) > node_rect.y) &&
-            ((rect.y + (rect.h / 2)) < node_rect.y + node_rect.h))
-        {
-            current_path.pop_back();
+    if (current_path.empty())
+    {
+        normal.x = 0;
+        normal.y = 0;
+        return;
+    }
 
-            node_rect = {(current_path.back().x * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
-                         (current_path.back().y * level->TILE_SIZE) + (level->TILE_SIZE / 2) - (NODE_SIZE / 2),
-                         NODE_SIZE, NODE_SIZE};
-        }
+    // Make sure that the enemy moves towards the next node in the path. If it misses the node,
+    // it will turn around and move towards it.
+    node_centre = Maths::toVec2({node_rect.x + (node_rect.w / 2), node_rect.y + (node_rect.h / 2)});
 
-        if (current_path.empty())
-        {
-            normal.x = 0;
-            normal.y = 0;
-        }
-        else
-        {
-            // Make sure that the enemy moves towards the next node in the path. If it misses the node,
-            // it will turn around and move towards it.
-            angle = Tools::angleBetweenPoints(rect.x + (rect.w / 2), rect.y + (rect.h / 2),
-                                              node_rect.x + (node_rect.w / 2), node_rect.y + (node_rect.h / 2)) - 180;
-
-            // Make sure that the enemy moves towards the next node in the path.
-            normal.x = std::cos(angle * 0.0174533);
-            normal.y = std::sin(angle * 0.0174533);
-            normal = Tools::normalizeVector(normal);
-            normal.x *= speed;
-            normal.y *= speed;
-
-            // This means that if the player is in the line of sights, it will face towards the player, but will still
-            // move towards the node because we are not changing any movement variables here.
-            if (std::all_of(level->getWallRects().begin(),
-                            level->getWallRects().end(),
-                            [&](const SDL_Rect& wall){return !SDL_IntersectRectAndLine(&wall, &x1, &y1, &x2, &y2);}))
-            {
-                if (!facing_player)
-                {
-                    facing_player = true;
-                }
-                angle = Tools::angleBetweenPoints(rect.x + (rect.w / 2), rect.y + (rect.h / 2),
-                                                  player.getRect().x + (player.getRect().w / 2), player.getRect().y + (player.getRect().h / 2)) - 180;
-            }
-            else
-            {
-                if (facing_player)
-                {
-                    facing_player = false;
-                }
-            }
-        }
+    // This means that if the player is in the line of sights, it will face towards the player, but will still
+    // move towards the node because we are not changing any movement variables here.
+    facing_player = level->hasLineOfSight(enemy_centre, target_centre);
+}
+
+/**
+* This method sets which way the enemy faces and moves, from the directions to the points
+* that think filled in.
+*/
+void Enemy::setDirections(const Maths::Vec2& node_direction, const Maths::Vec2& player_direction)
+{
+    if (!moving || current_path.empty())
+    {
+        return;
+    }
+
+    facing = node_direction;
+    normal = facing * speed;
+    if (facing_player)
+    {
+        facing = player_direction;
+    }
+}
 
-        // This just constructs a list of every solid in the game for use with collision.
-        std::vector<SDL_Rect> solids = level->getWallRects();
+/**
+* This method moves the enemy and handles its collisions. think and setDirections have to
+* be called first.
+*/
+void Enemy::update(Level* level, Player& player)
+{
+    if (moving)
+    {
+        // This just constructs a list of every solid in the game for use with collision. The
+        // list is kept between frames so that it doesn't have to allocate every time.
+        solids.assign(level->getWallRects().begin(), level->getWallRects().end());
         solids.push_back(player.getRect());
         for (auto& enemy : level->getEnemies())
         {
@@ -129,41 +135,13 @@ void Enemy::update(Level* level, Player& player)
 
         // Collisions for the X axis.
         rect.x += std::round(normal.x * Application::getDeltaTime());
-        for (const auto& solid : solids)
-        {
-            if (SDL_HasIntersection(&solid, &rect))
-            {
-                // If the enemy is moving to the right.
-                if (normal.x > 0)
-                {
-                    rect.x = solid.x - rect.w;
-                }
-                // If the enemy is moving to the left.
-                else if (normal.x < 0)
-                {
-                    rect.x = solid.x + solid.w;
-                }
-            }
-        }
+        Telemetry::add(Telemetry::Counter::CollisionTests, solids.size());
+        Tools::resolveCollisionsX(rect, normal.x, solids.data(), solids.size());
 
         // Collisions for the Y axis.
         rect.y += std::round(normal.y * Application::getDeltaTime());
-        for (const auto& solid : solids)
-        {
-            if (SDL_HasIntersection(&solid, &rect))
-            {
-                // If the enemy s moving down.
-                if (normal.y > 0)
-                {
-                    rect.y = solid.y - rect.h;
-                }
-                // If the enemy is moving up.
-                else if (normal.y < 0)
-                {
-                    rect.y = solid.y + solid.h;
-                }
-            }
-        }
+        Telemetry::add(Telemetry::Counter::CollisionTests, solids.size());
+        Tools::resolveCollisionsY(rect, normal.y, solids.data(), solids.size());
     }
 }
 
@@ -173,7 +151,7 @@ void Enemy::update(Level* level, Player& player)
 void Enemy::draw()
 {
     SDL_Rect draw_rect = Application::convertToCameraView(rect);
-    SDL_RenderCopyEx(Application::getRenderer(), texture, nullptr, &draw_rect, angle, nullptr, SDL_FLIP_NONE);
+    Application::drawTexture(RenderSnapshot::Layer::Enemies, texture, draw_rect, Maths::getAngle(facing));
 }
 
 /**
@@ -203,3 +181,40 @@ const SDL_Rect& Enemy::getRect()
 {
     return rect;
 }
+
+/**
+* This method gets the current state of the enemy.
+*/
+Enemy::State Enemy::getState()
+{
+    return {spawn_index, rect, node_rect, health, ai_time, ai_timer, attack_timer, alerted, dead, facing_player, facing, normal,
+            std::vector<SDL_Point>(current_path.begin(), current_path.end())};
+}
+
+/**
+* This method sets the state of the enemy.
+*/
+void Enemy::setState(const State& state)
+{
+    spawn_index = state.spawn_index;
+    rect = state.rect;
+    node_rect = state.node_rect;
+    health = state.health;
+    ai_time = state.ai_time;
+    ai_timer = state.ai_timer;
+    attack_timer = state.attack_timer;
+    alerted = state.alerted;
+    dead = state.dead;
+    facing_player = state.facing_player;
+    facing = state.facing;
+    normal = state.normal;
+    current_path.assign(state.path.begin(), state.path.end());
+}
+
+/**
+* This method sets which object in the level file the enemy was spawned from.
+*/
+void Enemy::setSpawnIndex(const int spawn_index)
+{
+    this->spawn_index = spawn_index;
+}
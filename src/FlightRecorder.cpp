@@ -0,0 +1,322 @@
+#include "FlightRecorder.h"
+#include "Log.h"
+#include "SPSCQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+* This namespace keeps the zones and counters of the last few hundred frames recorded by
+* the profiler in a ring buffer. When a frame takes longer than the frame budget the ring
+* is written to a file, in the same Chrome trace format as a profiler capture, along with
+* notes about what the game was doing (such as the current level). Recording a frame only
+* copies it into the ring, so it is always on. Writing the ring copies it and the notes,
+* and a writer thread writes the copy, so the game doesn't wait on the file during the
+* frame that was already too slow. Nothing is recorded if PROFILER_ENABLED isn't defined.
+*/
+namespace FlightRecorder
+{
+    /**
+    * This anonymous namespace holds the ring of frames, the notes and the writer thread.
+    */
+    namespace
+    {
+        /**
+        * This struct is a frame in the ring. It has a fixed size so that recording a frame
+        * never allocates.
+        */
+        struct RecordedFrame
+        {
+            std::uint64_t number;
+            std::uint64_t start;
+            std::uint64_t end;
+            int zone_count;
+            int counter_count;
+            Profiler::ZoneEvent zones[MAX_ZONES];
+            Profiler::CounterEvent counters[MAX_COUNTERS];
+        };
+
+        /**
+        * This struct is a copy of the ring, oldest frame first, and the notes, waiting to
+        * be written to a file. Its memory is kept between dumps.
+        */
+        struct Dump
+        {
+            std::string file_name;
+            float frame_budget;
+            int frame_count;
+            RecordedFrame frames[FRAME_COUNT];
+            std::vector<std::pair<std::string, std::string>> notes;
+        };
+
+        RecordedFrame frames[FRAME_COUNT];
+        std::uint64_t frame_number = 0;
+        std::uint64_t last_dump_frame = 0;
+        bool dumped = false;
+        float frame_budget = 0.0;
+
+        // Notes can be set from any thread, so they are only changed or copied while the
+        // mutex is held.
+        std::map<std::string, std::string, std::less<>> notes;
+        std::mutex notes_mutex;
+
+        // There is only one dump. It belongs to the game while spare_dump points to it, then
+        // it is queued for the writer thread, which hands it back once it has been written.
+        Dump dump_buffer;
+        Dump* spare_dump = &dump_buffer;
+        SPSCQueue<Dump*, 2> queued_dumps;
+        SPSCQueue<Dump*, 2> written_dumps;
+        std::thread writer;
+        std::atomic<bool> writing{false};
+
+        /**
+        * This function writes a string as a JSON string.
+        */
+        void writeString(std::ofstream& file, const std::string& text)
+        {
+            file << '"';
+            for (char character : text)
+            {
+                if (character == '"' || character == '\\')
+                {
+                    file << '\\';
+                }
+                file << character;
+            }
+            file << '"';
+        }
+
+        /**
+        * This function writes a dump to its file.
+        */
+        void writeDump(const Dump& dump)
+        {
+            std::ofstream file(dump.file_name);
+            if (!file)
+            {
+                LOG_WARNING(Diagnostics, "Unable to write flight recorder: " << dump.file_name);
+                return;
+            }
+            LOG_INFO(Diagnostics, "Writing flight recorder: " << dump.file_name);
+
+            const std::uint64_t start = dump.frames[0].start;
+
+            file << std::fixed << std::setprecision(3);
+            file << "{\"displayTimeUnit\":\"ms\",\n\"metadata\":{\"frame_budget_ms\":" << dump.frame_budget;
+            for (auto& note : dump.notes)
+            {
+                file << ",";
+                writeString(file, note.first);
+                file << ":";
+                writeString(file, note.second);
+            }
+            file << "},\n\"traceEvents\":[";
+
+            bool first_event = true;
+            auto beginEvent = [&]() -> std::ofstream&
+            {
+                file << (first_event ? "\n" : ",\n");
+                first_event = false;
+                return file;
+            };
+
+            for (int i = 0; i < dump.frame_count; i++)
+            {
+                const RecordedFrame& frame = dump.frames[i];
+                const double frame_start = Profiler::toMicroseconds(frame.start - start);
+                const double frame_end = Profiler::toMicroseconds(frame.end - start);
+
+                beginEvent() << "{\"name\":\"Frame " << frame.number << "\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":"
+                             << frame_start << ",\"dur\":" << frame_end - frame_start << "}";
+
+                for (int j = 0; j < frame.zone_count; j++)
+                {
+                    const Profiler::ZoneEvent& zone = frame.zones[j];
+                    beginEvent() << "{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                                 << Profiler::toMicroseconds(zone.start - start) << ",\"dur\":"
+                                 << Profiler::toMicroseconds(zone.end - zone.start) << "}";
+                }
+
+                for (int j = 0; j < frame.counter_count; j++)
+                {
+                    const Profiler::CounterEvent& counter = frame.counters[j];
+                    beginEvent() << "{\"name\":\"" << counter.name << "\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":"
+                                 << frame_end << ",\"args\":{\"value\":" << counter.value << "}}";
+                }
+            }
+
+            file << "\n]}\n";
+        }
+
+        /**
+        * This function runs on the writer thread. It writes dumps as they are queued and
+        * hands each one back once it is written, until it is stopped, then writes any that
+        * is left.
+        */
+        void writeDumps()
+        {
+            Dump* dump;
+            while (true)
+            {
+                bool stopping = !writing.load(std::memory_order_acquire);
+                if (queued_dumps.pop(dump))
+                {
+                    writeDump(*dump);
+                    written_dumps.push(dump);
+                }
+                else if (stopping)
+                {
+                    break;
+                }
+                else
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+        }
+    }
+
+    /**
+    * This function sets how long a frame can take, in milliseconds, before the recorder is
+    * written to a file. A budget of 0 turns dumping off.
+    */
+    void setFrameBudget(const float milliseconds)
+    {
+        frame_budget = milliseconds;
+    }
+
+    /**
+    * This function sets a note that is written with the recorder, such as the current level.
+    * Changing a note that is already set doesn't allocate unless the value gets longer.
+    * It can be called from any thread.
+    */
+    void setNote(const std::string_view name, const std::string_view value)
+    {
+        std::lock_guard<std::mutex> lock(notes_mutex);
+        auto note = notes.find(name);
+        if (note == notes.end())
+        {
+            notes.emplace(name, value);
+        }
+        else
+        {
+            note->second.assign(value);
+        }
+    }
+
+    /**
+    * This function adds a frame to the ring, replacing the oldest frame. If the frame is
+    * over budget the ring is written to a file, unless it was already written within the
+    * last FRAME_COUNT frames.
+    */
+    void recordFrame(const Profiler::Frame& frame)
+    {
+        // There is nothing to record if the profiler is turned off.
+        if (frame.end == 0)
+        {
+            return;
+        }
+
+        RecordedFrame& recorded = frames[frame_number % FRAME_COUNT];
+        recorded.number = frame_number;
+        recorded.start = frame.start;
+        recorded.end = frame.end;
+        recorded.zone_count = std::min<int>(frame.zones.size(), MAX_ZONES);
+        recorded.counter_count = std::min<int>(frame.counters.size(), MAX_COUNTERS);
+        std::copy_n(frame.zones.begin(), recorded.zone_count, recorded.zones);
+        std::copy_n(frame.counters.begin(), recorded.counter_count, recorded.counters);
+        frame_number++;
+
+        // Wait for the ring to fill up with new frames before writing it again, so a single
+        // slow section doesn't write a file every frame. The first time it is written it can
+        // be only partly filled, so that slow frames while starting up are caught too.
+        const float frame_time = Profiler::toMicroseconds(frame.end - frame.start) / 1000.0;
+        if (frame_budget > 0.0 && frame_time > frame_budget &&
+            (!dumped || frame_number - last_dump_frame >= FRAME_COUNT))
+        {
+            LOG_WARNING(Diagnostics, "Frame " << recorded.number << " took " << frame_time << "ms, the budget is " << frame_budget << "ms.");
+
+            dumped = true;
+            last_dump_frame = frame_number;
+            dump("flight_recorder_" + std::to_string(recorded.number) + ".json");
+        }
+    }
+
+    /**
+    * This function starts the writer thread, which writes the recorder to a file whenever
+    * it is dumped. Until it is started, dumps are written on the thread that asks for them.
+    */
+    void startUp()
+    {
+        if (writer.joinable())
+        {
+            return;
+        }
+        writing = true;
+        writer = std::thread(writeDumps);
+    }
+
+    /**
+    * This function copies every frame in the ring and the notes, and queues the copy to
+    * be written to a file. If the last dump is still being written this one is skipped.
+    */
+    void dump(const std::string& file_name)
+    {
+        if (spare_dump == nullptr && !written_dumps.pop(spare_dump))
+        {
+            LOG_WARNING(Diagnostics, "Skipping flight recorder, the last one is still being written: " << file_name);
+            return;
+        }
+
+        // Assigning into the dump's strings reuses their memory from the last dump.
+        Dump& copy = *spare_dump;
+        copy.file_name.assign(file_name);
+        copy.frame_budget = frame_budget;
+        copy.frame_count = static_cast<int>(std::min<std::uint64_t>(frame_number, FRAME_COUNT));
+        const std::uint64_t first_frame = frame_number - copy.frame_count;
+        for (int i = 0; i < copy.frame_count; i++)
+        {
+            copy.frames[i] = frames[(first_frame + i) % FRAME_COUNT];
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(notes_mutex);
+            copy.notes.resize(notes.size());
+            int note_index = 0;
+            for (auto& note : notes)
+            {
+                copy.notes[note_index].first.assign(note.first);
+                copy.notes[note_index].second.assign(note.second);
+                note_index++;
+            }
+        }
+
+        if (!writing.load(std::memory_order_relaxed))
+        {
+            writeDump(copy);
+            return;
+        }
+        queued_dumps.push(spare_dump);
+        spare_dump = nullptr;
+    }
+
+    /**
+    * This function writes any queued dump and stops the writer thread.
+    */
+    void shutDown()
+    {
+        if (writer.joinable())
+        {
+            writing = false;
+            writer.join();
+        }
+    }
+}
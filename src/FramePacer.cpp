@@ -0,0 +1,98 @@
+#include "FramePacer.h"
+
+#include <cmath>
+
+/**
+* This method sets how many frames should run each second. A rate of 0 runs frames as
+* fast as possible.
+*/
+void FramePacer::setRate(const int frame_rate)
+{
+    ticks_per_microsecond = SDL_GetPerformanceFrequency() / 1000000.0;
+    period = frame_rate > 0 ? static_cast<double>(SDL_GetPerformanceFrequency()) / frame_rate : 0.0;
+    reset();
+}
+
+/**
+* This method starts the schedule again, so that the next frame is due a period from now.
+* It should be called after the game has stopped running frames for a while.
+*/
+void FramePacer::reset()
+{
+    schedule_start = SDL_GetPerformanceCounter();
+    frame_index = 0;
+}
+
+/**
+* This method waits until the next frame is due.
+*/
+void FramePacer::wait()
+{
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (period <= 0.0)
+    {
+        error = 0.0;
+        return;
+    }
+
+    frame_index++;
+    const Uint64 due = schedule_start + static_cast<Uint64>(frame_index * period);
+    if (now >= due)
+    {
+        // The frame is already late. If it is more than a frame late, the schedule is
+        // started again from now.
+        error = (now - due) / ticks_per_microsecond;
+        if (now - due > period)
+        {
+            schedule_start = now;
+            frame_index = 0;
+            missed_frames++;
+        }
+        return;
+    }
+
+    // Sleep while there is time for even a slow sleep to finish before the frame is due.
+    const double sleep_limit = (sleep_average + (sleep_deviation * SLEEP_DEVIATIONS)) * ticks_per_microsecond;
+    while (now < due && due - now > sleep_limit)
+    {
+        const Uint64 sleep_start = now;
+        SDL_Delay(1);
+        now = SDL_GetPerformanceCounter();
+        addSleep((now - sleep_start) / ticks_per_microsecond);
+    }
+
+    // Spin for the rest.
+    while (now < due)
+    {
+        now = SDL_GetPerformanceCounter();
+    }
+    error = (now - due) / ticks_per_microsecond;
+}
+
+/**
+* This method returns how late, in microseconds, the last frame started compared to when
+* it was due.
+*/
+float FramePacer::getError() const
+{
+    return error;
+}
+
+/**
+* This method returns how many times the game has fallen so far behind that the
+* schedule was started again.
+*/
+int FramePacer::getMissedFrames() const
+{
+    return missed_frames;
+}
+
+/**
+* This method records how long a one millisecond sleep took, in microseconds.
+*/
+void FramePacer::addSleep(const double sleep_time)
+{
+    const double difference = sleep_time - sleep_average;
+    sleep_average += difference * SMOOTHING;
+    sleep_deviation += (std::abs(difference) - sleep_deviation) * SMOOTHING;
+}
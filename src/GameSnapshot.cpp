@@ -0,0 +1,355 @@
+#include "GameSnapshot.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+
+/**
+* This anonymous namespace holds the layout of snapshot files and helpers for reading
+* and writing them.
+*/
+namespace
+{
+    const char MAGIC[4] = {'S', 'N', 'A', 'P'};
+    const std::uint32_t VERSION = 2;
+
+    // Limits on the size of anything read from a file, so a broken file can't allocate everything.
+    const std::uint64_t MAX_STRING = 4096;
+    const std::uint64_t MAX_COUNT = 1 << 20;
+
+    template <typename T>
+    void writeValue(std::ostream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(std::ostream& file, const std::string& text)
+    {
+        writeValue<std::uint64_t>(file, text.size());
+        file.write(text.data(), text.size());
+    }
+
+    void writeProjectile(std::ostream& file, const Projectile::State& projectile)
+    {
+        writeString(file, Application::getTextureName(projectile.texture));
+        writeValue(file, projectile.rect);
+        writeValue(file, projectile.normal);
+        writeValue(file, projectile.damage);
+        writeValue(file, projectile.speed);
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool readCount(std::ifstream& file, std::uint64_t& count, const std::uint64_t max_count)
+    {
+        return readValue(file, count) && count <= max_count;
+    }
+
+    bool readString(std::ifstream& file, std::string& text)
+    {
+        std::uint64_t size;
+        if (!readCount(file, size, MAX_STRING))
+        {
+            return false;
+        }
+        text.resize(size);
+        return static_cast<bool>(file.read(&text[0], size));
+    }
+
+    bool readBool(std::ifstream& file, bool& value)
+    {
+        // Any byte other than 0 or 1 isn't a valid bool, so it is read as a byte first.
+        std::uint8_t byte;
+        if (!readValue(file, byte) || byte > 1)
+        {
+            return false;
+        }
+        value = byte == 1;
+        return true;
+    }
+
+    bool readWeapon(std::ifstream& file, Weapon& weapon)
+    {
+        std::underlying_type_t<Weapon> value;
+        if (!readValue(file, value) ||
+            value < static_cast<int>(Weapon::Handgun) ||
+            value > static_cast<int>(Weapon::PlasmaRifle))
+        {
+            return false;
+        }
+        weapon = static_cast<Weapon>(value);
+        return true;
+    }
+
+    bool readProjectile(std::ifstream& file, Projectile::State& projectile)
+    {
+        std::string texture_name;
+        if (!readString(file, texture_name) ||
+            !readValue(file, projectile.rect) ||
+            !readValue(file, projectile.normal) ||
+            !readValue(file, projectile.damage) ||
+            !readValue(file, projectile.speed))
+        {
+            return false;
+        }
+
+        // A snapshot from an older version of the game, or a corrupt one, can name a texture
+        // that doesn't exist, which should stop the snapshot loading rather than the game.
+        try
+        {
+            projectile.texture = Application::getTexture(texture_name);
+        }
+        catch (const Application::Error&)
+        {
+            return false;
+        }
+        return true;
+    }
+}
+
+/**
+* This method writes the snapshot to a file. Textures are stored by the file name
+* they were loaded from.
+*/
+void GameSnapshot::write(const std::string& file_name) const
+{
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file)
+    {
+        SDL_SetError("Unable to write snapshot: %s", file_name.c_str());
+        throw Application::Error::Level;
+    }
+
+    write(file);
+
+    if (!file)
+    {
+        SDL_SetError("Unable to write snapshot: %s", file_name.c_str());
+        throw Application::Error::Level;
+    }
+}
+
+/**
+* This method writes the snapshot to a stream, in the same format as a snapshot file.
+*/
+void GameSnapshot::write(std::ostream& file) const
+{
+    file.write(MAGIC, sizeof(MAGIC));
+    writeValue(file, VERSION);
+    writeString(file, level_file);
+
+    writeValue(file, player.rect);
+    writeValue(file, player.health);
+    writeValue<std::uint64_t>(file, player.ammo.size());
+    for (auto& ammo : player.ammo)
+    {
+        writeValue(file, ammo.first);
+        writeValue(file, ammo.second);
+    }
+    writeValue<std::uint64_t>(file, player.weapons.size());
+    for (auto& weapon : player.weapons)
+    {
+        writeValue(file, weapon);
+    }
+    writeValue(file, player.weapon_index);
+    writeValue(file, player.shoot_delay);
+
+    writeValue<std::uint64_t>(file, level.objects.size());
+    for (int index : level.objects)
+    {
+        writeValue(file, index);
+    }
+    writeValue<std::uint64_t>(file, level.enemies.size());
+    for (auto& enemy : level.enemies)
+    {
+        writeValue(file, enemy.spawn_index);
+        writeValue(file, enemy.rect);
+        writeValue(file, enemy.node_rect);
+        writeValue(file, enemy.health);
+        writeValue(file, enemy.ai_time);
+        writeValue(file, enemy.ai_timer);
+        writeValue(file, enemy.attack_timer);
+        writeValue(file, enemy.alerted);
+        writeValue(file, enemy.dead);
+        writeValue(file, enemy.facing_player);
+        writeValue(file, enemy.facing);
+        writeValue(file, enemy.normal);
+        writeValue<std::uint64_t>(file, enemy.path.size());
+        for (auto& point : enemy.path)
+        {
+            writeValue(file, point);
+        }
+    }
+    writeValue<std::uint64_t>(file, level.enemy_projectiles.size());
+    for (auto& projectile : level.enemy_projectiles)
+    {
+        writeProjectile(file, projectile);
+    }
+
+    writeValue<std::uint64_t>(file, projectiles.size());
+    for (auto& projectile : projectiles)
+    {
+        writeProjectile(file, projectile);
+    }
+}
+
+/**
+* This method returns a 64 bit FNV-1a hash of the snapshot, as it would be written to
+* a file. Two snapshots with the same hash are the same down to the last bit.
+*/
+std::uint64_t GameSnapshot::getHash() const
+{
+    std::ostringstream stream;
+    write(stream);
+
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const char byte : stream.str())
+    {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+* This method reads a snapshot from a file. It returns false if the file doesn't
+* exist or isn't a snapshot from this version of the game.
+*/
+bool GameSnapshot::read(const std::string& file_name)
+{
+    std::ifstream file(file_name, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    char magic[4];
+    std::uint32_t version;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        !readValue(file, version) || version != VERSION)
+    {
+        return false;
+    }
+
+    GameSnapshot snapshot;
+    std::uint64_t count;
+    if (!readString(file, snapshot.level_file) ||
+        !readValue(file, snapshot.player.rect) ||
+        !readValue(file, snapshot.player.health) ||
+        !readCount(file, count, MAX_COUNT))
+    {
+        return false;
+    }
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        Weapon weapon;
+        int ammo;
+        if (!readWeapon(file, weapon) || !readValue(file, ammo))
+        {
+            return false;
+        }
+        snapshot.player.ammo[weapon] = ammo;
+    }
+
+    if (!readCount(file, count, MAX_COUNT))
+    {
+        return false;
+    }
+    snapshot.player.weapons.resize(count);
+    for (auto& weapon : snapshot.player.weapons)
+    {
+        if (!readWeapon(file, weapon))
+        {
+            return false;
+        }
+    }
+    if (!readValue(file, snapshot.player.weapon_index) ||
+        !readValue(file, snapshot.player.shoot_delay) ||
+        snapshot.player.weapons.empty() ||
+        snapshot.player.weapon_index < 0 ||
+        snapshot.player.weapon_index >= static_cast<int>(snapshot.player.weapons.size()))
+    {
+        return false;
+    }
+
+    if (!readCount(file, count, MAX_COUNT))
+    {
+        return false;
+    }
+    snapshot.level.objects.resize(count);
+    for (int& index : snapshot.level.objects)
+    {
+        if (!readValue(file, index))
+        {
+            return false;
+        }
+    }
+
+    if (!readCount(file, count, MAX_COUNT))
+    {
+        return false;
+    }
+    snapshot.level.enemies.resize(count);
+    for (auto& enemy : snapshot.level.enemies)
+    {
+        std::uint64_t path_size;
+        if (!readValue(file, enemy.spawn_index) ||
+            !readValue(file, enemy.rect) ||
+            !readValue(file, enemy.node_rect) ||
+            !readValue(file, enemy.health) ||
+            !readValue(file, enemy.ai_time) ||
+            !readValue(file, enemy.ai_timer) ||
+            !readValue(file, enemy.attack_timer) ||
+            !readBool(file, enemy.alerted) ||
+            !readBool(file, enemy.dead) ||
+            !readBool(file, enemy.facing_player) ||
+            !readValue(file, enemy.facing) ||
+            !readValue(file, enemy.normal) ||
+            !readCount(file, path_size, MAX_COUNT))
+        {
+            return false;
+        }
+        enemy.path.resize(path_size);
+        for (auto& point : enemy.path)
+        {
+            if (!readValue(file, point))
+            {
+                return false;
+            }
+        }
+    }
+
+    if (!readCount(file, count, MAX_COUNT))
+    {
+        return false;
+    }
+    snapshot.level.enemy_projectiles.resize(count);
+    for (auto& projectile : snapshot.level.enemy_projectiles)
+    {
+        if (!readProjectile(file, projectile))
+        {
+            return false;
+        }
+    }
+
+    if (!readCount(file, count, MAX_COUNT))
+    {
+        return false;
+    }
+    snapshot.projectiles.resize(count);
+    for (auto& projectile : snapshot.projectiles)
+    {
+        if (!readProjectile(file, projectile))
+        {
+            return false;
+        }
+    }
+
+    *this = std::move(snapshot);
+    return true;
+}
@@ -1,79 +1,167 @@
 #include "GameState.h"
+#include "Random.h"
+
+#include <algorithm>
+
+/**
+* This constructor plays the given levels instead of the normal level sequence.
+*/
+GameState::GameState(const std::vector<std::string>& level_sequence) : level_sequence(level_sequence)
+{
+}
 
 void GameState::startUp()
 {
-    level.load("Resources/Levels/1.lvl");
-    level.render();
-    player.setRect(level.getStartRect());
-    level.generateAIGrid();
-    level.breadthFirstSearch({player.getCentre().x / level.TILE_SIZE, player.getCentre().y / level.TILE_SIZE});
+    if (level_sequence.empty())
+    {
+        level_sequence = LevelFile::loadSequence("Resources/Levels/Levels.xml");
+    }
 
-    updateWindowTitle();
+    // A replay starts on the level it was recorded on, even if it isn't in the sequence.
+    int start_index = 0;
+    if (Replay::isPlaying())
+    {
+        auto level_it = std::find(level_sequence.begin(), level_sequence.end(), Replay::getLevel());
+        if (level_it == level_sequence.end())
+        {
+            level_it = level_sequence.insert(level_sequence.end(), Replay::getLevel());
+        }
+        start_index = level_it - level_sequence.begin();
+    }
+    changeLevel(start_index);
+
+    if (Replay::isRecording())
+    {
+        Replay::setLevel(level.getFileName());
+    }
 }
 
 void GameState::handleEvents()
 {
-    if (Application::getEvent().type == SDL_KEYDOWN)
+    for (const SDL_Event& event : Application::getInput().getEvents())
     {
-        if (Application::getEvent().key.keysym.sym == SDLK_SPACE)
+        // Nothing is drawn while the game is paused, so only unpausing, quitting and letting
+        // go of keys and buttons are handled. Otherwise the game would carry on from a state
+        // it never showed.
+        if (Application::isPaused())
         {
-            if (level.getTitle() == "Test Level")
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_p)
             {
-                level.load("Resources/Levels/2.lvl");
+                Application::setPaused(false);
             }
-            else if (level.getTitle() == "Second Test Level")
+            else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)
             {
-                level.load("Resources/Levels/1.lvl");
+                Application::quit();
             }
-
-            if (!projectiles.empty())
+            else if (event.type == SDL_KEYUP)
             {
-                projectiles.clear();
+                player.handleKeyReleases(event);
             }
+            else if (event.type == SDL_MOUSEBUTTONUP)
+            {
+                player.stopShooting();
+            }
+            continue;
+        }
 
-            level.render();
-            player.setRect(level.getStartRect());
-            level.generateAIGrid();
-            level.breadthFirstSearch({player.getCentre().x / level.TILE_SIZE, player.getCentre().y / level.TILE_SIZE});
-
-            updateWindowTitle();
+        if (event.type == SDL_KEYDOWN)
+        {
+            if (event.key.keysym.sym == SDLK_SPACE)
+            {
+                changeLevel(level_index + 1);
+            }
+            else if (event.key.keysym.sym == SDLK_F5)
+            {
+                // A folder that can't be written to or a full disk only loses the quicksave.
+                try
+                {
+                    takeSnapshot().write(QUICKSAVE_FILE);
+                    LOG_INFO(Save, "Quicksaved to: " << QUICKSAVE_FILE);
+                }
+                catch (const Application::Error&)
+                {
+                    LOG_WARNING(Save, "Unable to quicksave: " << SDL_GetError());
+                }
+            }
+            else if (event.key.keysym.sym == SDLK_F9)
+            {
+                GameSnapshot quicksave;
+                if (quicksave.read(QUICKSAVE_FILE))
+                {
+                    restoreSnapshot(quicksave);
+                }
+                else
+                {
+                    LOG_WARNING(Save, "Unable to load the quicksave from: " << QUICKSAVE_FILE);
+                }
+            }
+            else if (event.key.keysym.sym == SDLK_F3)
+            {
+                perf_overlay.toggle();
+            }
+            else if (event.key.keysym.sym == SDLK_F10)
+            {
+                // Start or stop streaming frames to a trace file.
+                if (Profiler::isCapturing())
+                {
+                    Profiler::stopCapture();
+                }
+                else
+                {
+                    Profiler::startCapture(TRACE_FILE);
+                }
+            }
+            else if (event.key.keysym.sym == SDLK_F12)
+            {
+                // Write this frame's render commands to a file for the RenderBenchmark tool.
+                Application::dumpRenderSnapshot(RENDER_DUMP_FILE);
+            }
+            else if (event.key.keysym.sym == SDLK_ESCAPE)
+            {
+                Application::quit();
+            }
+            else if (event.key.keysym.sym == SDLK_p)
+            {
+                Application::setPaused(!Application::isPaused());
+            }
+            else
+            {
+                player.handleKeyPresses(event);
+            }
         }
-        else if (Application::getEvent().key.keysym.sym == SDLK_ESCAPE)
+        else if (event.type == SDL_KEYUP)
         {
-            Application::quit();
+            player.handleKeyReleases(event);
         }
-        else
+        else if (event.type == SDL_MOUSEWHEEL)
         {
-            player.handleKeyPresses();
+            player.changeWeapon(event);
+        }
+        else if (event.type == SDL_MOUSEBUTTONDOWN)
+        {
+            player.startShooting();
+        }
+        else if (event.type == SDL_MOUSEBUTTONUP)
+        {
+            player.stopShooting();
         }
-    }
-    else if (Application::getEvent().type == SDL_KEYUP)
-    {
-        player.handleKeyReleases();
-    }
-    else if (Application::getEvent().type == SDL_MOUSEWHEEL)
-    {
-        player.changeWeapon();
-    }
-    else if (Application::getEvent().type == SDL_MOUSEBUTTONDOWN)
-    {
-        player.startShooting();
-    }
-    else if (Application::getEvent().type == SDL_MOUSEBUTTONUP)
-    {
-        player.stopShooting();
     }
 }
 
 void GameState::update()
 {
+    PROFILE_ZONE("GameState::update");
+
     // Create a list of every solid object in the game for the player to collide with.
     solids = level.getWallRects();
     for (auto& enemy : level.getEnemies())
     {
         solids.push_back(enemy->getRect());
     }
-    player.update(solids);
+    {
+        PROFILE_ZONE("Player collision");
+        player.update(solids);
+    }
 
     // If the player can shoot, a different projectile will be spawned at their location depending
     // on what weapon the player has equipped.
@@ -83,28 +171,35 @@ void GameState::update()
         {
         case Weapon::Handgun:
             projectiles.emplace_back(Application::getTexture("Resources/Images/Bullet.png"),
-                                     player.getCentre().x, player.getCentre().y, player.getAngle(), 20, 1000, 5);
+                                     player.getCentre().x, player.getCentre().y, player.getAim(), 20, 1000, 5, Random::Stream::PlayerSpread);
             break;
         case Weapon::Shotgun:
             {
-                for (int i = 0; i < 5; i++)
+                // Every pellet's spread is drawn and turned into a direction in one go rather
+                // than one at a time.
+                int spreads[SHOTGUN_PELLETS];
+                Maths::Vec2 directions[SHOTGUN_PELLETS];
+                Random::get(Random::Stream::PlayerSpread).getInts(spreads, SHOTGUN_PELLETS, -SHOTGUN_SPREAD, SHOTGUN_SPREAD);
+                Maths::rotate(player.getAim(), spreads, directions, SHOTGUN_PELLETS);
+
+                SDL_Texture* texture = Application::getTexture("Resources/Images/BallBearing.png");
+                for (int i = 0; i < SHOTGUN_PELLETS; i++)
                 {
-                    projectiles.emplace_back(Application::getTexture("Resources/Images/BallBearing.png"),
-                                             player.getCentre().x, player.getCentre().y, player.getAngle(), 20, 1000, 25);
+                    projectiles.emplace_back(texture, player.getCentre().x, player.getCentre().y, directions[i], 20, 1000, 0, Random::Stream::PlayerSpread);
                 }
             }
             break;
         case Weapon::AssaultRifle:
             projectiles.emplace_back(Application::getTexture("Resources/Images/AssaultRifleBullet.png"),
-                                     player.getCentre().x, player.getCentre().y, player.getAngle(), 20, 1000, 3);
+                                     player.getCentre().x, player.getCentre().y, player.getAim(), 20, 1000, 3, Random::Stream::PlayerSpread);
             break;
         case Weapon::Minigun:
             projectiles.emplace_back(Application::getTexture("Resources/Images/MinigunBullet.png"),
-                                     player.getCentre().x, player.getCentre().y, player.getAngle(), 20, 1000, 20);
+                                     player.getCentre().x, player.getCentre().y, player.getAim(), 20, 1000, 20, Random::Stream::PlayerSpread);
             break;
         case Weapon::PlasmaRifle:
             projectiles.emplace_back(Application::getTexture("Resources/Images/PlasmaBall.png"),
-                                     player.getCentre().x, player.getCentre().y, player.getAngle(), 20, 1000, 2);
+                                     player.getCentre().x, player.getCentre().y, player.getAim(), 20, 1000, 2, Random::Stream::PlayerSpread);
             break;
         default:
             break;
@@ -118,110 +213,140 @@ void GameState::update()
     }
 
     // Remove player projectile if it hits a wall.
-    for (auto& wall : level.getWallRects())
     {
-        for (auto projectile = projectiles.begin(); projectile != projectiles.end();)
-        {
-            if (SDL_HasIntersection(&wall, &projectile->getRect()))
-            {
-                projectiles.erase(projectile);
-            }
-            else
-            {
-                projectile++;
-            }
-        }
+        PROFILE_ZONE("Projectile wall collision");
+        level.removeProjectilesInWalls(projectiles);
     }
 
-    for (auto pickup = level.getAmmoPickups().begin(); pickup != level.getAmmoPickups().end();)
     {
-        if (SDL_HasIntersection(&pickup->getRect(), &player.getRect()))
+        PROFILE_ZONE("Pickup collision");
+        Telemetry::add(Telemetry::Counter::CollisionTests,
+                       level.getAmmoPickups().size() + level.getWeaponPickups().size() + level.getHealthPickups().size());
+        for (auto pickup = level.getAmmoPickups().begin(); pickup != level.getAmmoPickups().end();)
         {
-            if (player.addAmmo(pickup->getWeapon(), pickup->getAmmo()))
+            if (SDL_HasIntersection(&pickup->getRect(), &player.getRect()))
             {
-                level.getAmmoPickups().erase(pickup);
+                if (player.addAmmo(pickup->getWeapon(), pickup->getAmmo()))
+                {
+                    pickup = level.getAmmoPickups().erase(pickup);
+                }
+                else
+                {
+                    pickup++;
+                }
             }
             else
             {
                 pickup++;
             }
         }
-        else
-        {
-            pickup++;
-        }
-    }
 
-    for (auto pickup = level.getWeaponPickups().begin(); pickup != level.getWeaponPickups().end();)
-    {
-        if (SDL_HasIntersection(&pickup->getRect(), &player.getRect()))
+        for (auto pickup = level.getWeaponPickups().begin(); pickup != level.getWeaponPickups().end();)
         {
-            if (!player.hasWeapon(pickup->getWeapon()))
+            if (SDL_HasIntersection(&pickup->getRect(), &player.getRect()))
             {
-                player.addWeapon(pickup->getWeapon());
-                player.addAmmo(pickup->getWeapon(), pickup->getAmmo());
-                level.getWeaponPickups().erase(pickup);
-            }
-            else if (player.addAmmo(pickup->getWeapon(), pickup->getAmmo()))
-            {
-                level.getWeaponPickups().erase(pickup);
+                if (!player.hasWeapon(pickup->getWeapon()))
+                {
+                    player.addWeapon(pickup->getWeapon());
+                    player.addAmmo(pickup->getWeapon(), pickup->getAmmo());
+                    pickup = level.getWeaponPickups().erase(pickup);
+                }
+                else if (player.addAmmo(pickup->getWeapon(), pickup->getAmmo()))
+                {
+                    pickup = level.getWeaponPickups().erase(pickup);
+                }
+                else
+                {
+                    pickup++;
+                }
             }
             else
             {
                 pickup++;
             }
         }
-        else
-        {
-            pickup++;
-        }
-    }
 
-    for (auto pickup = level.getHealthPickups().begin(); pickup != level.getHealthPickups().end();)
-    {
-        if (SDL_HasIntersection(&pickup->getRect(), &player.getRect()))
+        for (auto pickup = level.getHealthPickups().begin(); pickup != level.getHealthPickups().end();)
         {
-            if (player.addHealth(pickup->getHealth()))
+            if (SDL_HasIntersection(&pickup->getRect(), &player.getRect()))
             {
-                level.getHealthPickups().erase(pickup);
+                if (player.addHealth(pickup->getHealth()))
+                {
+                    pickup = level.getHealthPickups().erase(pickup);
+                }
+                else
+                {
+                    pickup++;
+                }
             }
             else
             {
                 pickup++;
             }
         }
-        else
-        {
-            pickup++;
-        }
     }
 
-    for (auto enemy = level.getEnemies().begin(); enemy != level.getEnemies().end();)
     {
-        for (auto projectile = projectiles.begin(); projectile != projectiles.end();)
+        PROFILE_ZONE("Enemy collision");
+        for (auto enemy = level.getEnemies().begin(); enemy != level.getEnemies().end();)
         {
-            if (SDL_HasIntersection(&enemy->get()->getRect(), &projectile->getRect()))
+            Telemetry::add(Telemetry::Counter::CollisionTests, projectiles.size());
+            for (auto projectile = projectiles.begin(); projectile != projectiles.end();)
+            {
+                if (SDL_HasIntersection(&enemy->get()->getRect(), &projectile->getRect()))
+                {
+                    enemy->get()->damage(projectile->getDamage());
+                    projectile = projectiles.erase(projectile);
+                    Telemetry::add(Telemetry::Counter::ProjectilesCulled);
+                }
+                else
+                {
+                    projectile++;
+                }
+            }
+            if (enemy->get()->isDead())
             {
-                enemy->get()->damage(projectile->getDamage());
-                projectiles.erase(projectile);
+                enemy = level.getEnemies().erase(enemy);
             }
             else
             {
-                projectile++;
+                enemy++;
             }
         }
-        if (enemy->get()->isDead())
+    }
+
+    // Save the game in memory when the player reaches a checkpoint. The checkpoint is
+    // removed first so that it isn't in the snapshot.
+    Telemetry::add(Telemetry::Counter::CollisionTests, level.getCheckpoints().size());
+    for (auto checkpoint_it = level.getCheckpoints().begin(); checkpoint_it != level.getCheckpoints().end();)
+    {
+        if (SDL_HasIntersection(&checkpoint_it->rect, &player.getRect()))
         {
-            level.getEnemies().erase(enemy);
+            checkpoint_it = level.getCheckpoints().erase(checkpoint_it);
+            checkpoint = takeSnapshot();
         }
         else
         {
-            enemy++;
+            checkpoint_it++;
         }
     }
 
     level.update(player);
 
+    PerfOverlay::Stats stats;
+    stats.enemies = level.getEnemies().size();
+    stats.projectiles = projectiles.size();
+    stats.enemy_projectiles = level.getEnemyProjectiles().size();
+    stats.pickups = level.getAmmoPickups().size() + level.getWeaponPickups().size() + level.getHealthPickups().size();
+    stats.bfs_time = level.getBFSTime();
+    stats.bfs_tiles_reached = level.getBFSTilesReached();
+    perf_overlay.update(stats);
+
+    PROFILE_COUNTER("Enemies", stats.enemies);
+    PROFILE_COUNTER("Player projectiles", stats.projectiles);
+    PROFILE_COUNTER("Enemy projectiles", stats.enemy_projectiles);
+    PROFILE_COUNTER("Pickups", stats.pickups);
+
     fps_timer += Application::getDeltaTime();
     if (fps_timer >= TITLE_UPDATE_TIME)
     {
@@ -238,32 +363,118 @@ void GameState::update()
 
     if (player.isDead())
     {
-        player.respawn();
-        level.load(level.getFileName());
-        player.setRect(level.getStartRect());
-        level.render();
-        level.generateAIGrid();
-        level.breadthFirstSearch({player.getCentre().x / level.TILE_SIZE, player.getCentre().y / level.TILE_SIZE});
+        // Go back to the last checkpoint, or to the start of the level if no checkpoint has been reached.
+        restoreSnapshot(checkpoint);
     }
 }
 
 void GameState::draw()
 {
+    PROFILE_ZONE("GameState::draw");
+
     level.draw();
     for (auto& projectile : projectiles)
     {
         projectile.draw();
     }
     player.draw();
+    perf_overlay.draw();
+
+    if (Application::isPaused())
+    {
+        pause_text.draw();
+    }
 }
 
 void GameState::shutDown()
 {
+    // Replays check that they finish in exactly the same state they were recorded in.
+    if (Replay::isRecording() || Replay::isPlaying())
+    {
+        Replay::finish(takeSnapshot().getHash());
+    }
 }
 
 void GameState::updateWindowTitle()
 {
-    std::stringstream ss;
-    ss << "Top Down Shooter" << " - " << level.getTitle() << " - " << "FPS: " << Application::getFrameRate();
-    Application::setWindowTitle(ss.str());
+    // The title is built in the same string every time so that it doesn't allocate.
+    window_title = "Top Down Shooter - ";
+    window_title += level.getTitle();
+    window_title += " - FPS: ";
+    window_title += std::to_string(Application::getFrameRate());
+    Application::setWindowTitle(window_title);
+}
+
+void GameState::changeLevel(const int index)
+{
+    level_index = index % level_sequence.size();
+
+    // This only has to wait if the level hasn't finished prefetching yet.
+    level.setLayout(level_loader.get(level_sequence[level_index]));
+
+    if (!projectiles.empty())
+    {
+        projectiles.clear();
+    }
+
+    level.render();
+    player.setRect(level.getStartRect());
+    level.breadthFirstSearch({player.getCentre().x / level.TILE_SIZE, player.getCentre().y / level.TILE_SIZE});
+
+    updateWindowTitle();
+
+    // Start loading the next level while this one is played.
+    level_loader.prefetch(level_sequence[(level_index + 1) % level_sequence.size()]);
+
+    // The start of the level is the first checkpoint.
+    checkpoint = takeSnapshot();
+}
+
+/**
+* This method takes a snapshot of the player, the level and every projectile.
+*/
+GameSnapshot GameState::takeSnapshot()
+{
+    GameSnapshot snapshot;
+    snapshot.level_file = level.getFileName();
+    snapshot.player = player.getState();
+    snapshot.level = level.getState();
+    for (auto& projectile : projectiles)
+    {
+        snapshot.projectiles.push_back(projectile.getState());
+    }
+    return snapshot;
+}
+
+/**
+* This method puts the game back to how it was when a snapshot was taken. The level
+* is only loaded again if the snapshot is from a different level.
+*/
+void GameState::restoreSnapshot(const GameSnapshot& snapshot)
+{
+    if (snapshot.level_file != level.getFileName())
+    {
+        auto level_it = std::find(level_sequence.begin(), level_sequence.end(), snapshot.level_file);
+        if (level_it != level_sequence.end())
+        {
+            level_index = level_it - level_sequence.begin();
+        }
+
+        level.setLayout(level_loader.get(snapshot.level_file));
+        level.render();
+        updateWindowTitle();
+        level_loader.prefetch(level_sequence[(level_index + 1) % level_sequence.size()]);
+    }
+
+    level.setState(snapshot.level);
+    player.setState(snapshot.player);
+
+    projectiles.clear();
+    for (auto& projectile : snapshot.projectiles)
+    {
+        projectiles.emplace_back(projectile);
+    }
+
+    ai_timer = 0.0;
+    level.breadthFirstSearch({player.getCentre().x / level.TILE_SIZE, player.getCentre().y / level.TILE_SIZE});
 }
@@ -0,0 +1,117 @@
+#include "GlyphAtlas.h"
+
+#include <algorithm>
+
+/**
+* Render every glyph into one surface and upload it. Glyphs are packed left to right
+* into rows that are each as tall as the font.
+*/
+GlyphAtlas::GlyphAtlas(TTF_Font* font)
+{
+    this->font = font;
+    line_skip = TTF_FontLineSkip(font);
+
+    SDL_Surface* glyph_surfaces[LAST_GLYPH - FIRST_GLYPH + 1];
+    SDL_Point pen = {0, 0};
+    int row_height = 0;
+    for (char character = FIRST_GLYPH; character <= LAST_GLYPH; character++)
+    {
+        Glyph& glyph = glyphs[character - FIRST_GLYPH];
+        SDL_Surface*& surface = glyph_surfaces[character - FIRST_GLYPH];
+
+        surface = TTF_RenderGlyph_Blended(font, character, {255, 255, 255, 255});
+        if (surface == nullptr)
+        {
+            throw Application::Error::TTF;
+        }
+        TTF_GlyphMetrics(font, character, nullptr, nullptr, nullptr, nullptr, &glyph.advance);
+
+        if (pen.x + surface->w > ATLAS_WIDTH)
+        {
+            pen.x = 0;
+            pen.y += row_height;
+            row_height = 0;
+        }
+        glyph.source = {pen.x, pen.y, surface->w, surface->h};
+        pen.x += surface->w;
+        row_height = std::max(row_height, surface->h);
+    }
+    height = pen.y + row_height;
+
+    SDL_Surface* atlas_surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (atlas_surface == nullptr)
+    {
+        throw Application::Error::SDL;
+    }
+    SDL_FillRect(atlas_surface, nullptr, 0);
+    for (char character = FIRST_GLYPH; character <= LAST_GLYPH; character++)
+    {
+        SDL_Surface* surface = glyph_surfaces[character - FIRST_GLYPH];
+
+        // Copy the glyph's alpha as it is instead of blending it onto the empty atlas.
+        SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+        SDL_Rect destination = glyphs[character - FIRST_GLYPH].source;
+        SDL_BlitSurface(surface, nullptr, atlas_surface, &destination);
+        SDL_FreeSurface(surface);
+    }
+
+    texture = SDL_CreateTextureFromSurface(Application::getRenderer(), atlas_surface);
+    SDL_FreeSurface(atlas_surface);
+    if (texture == nullptr)
+    {
+        throw Application::Error::SDL;
+    }
+    Application::addSprite(texture);
+    Memory::addExternal(Memory::Tag::Texture, Application::getTextureBytes(texture));
+}
+
+GlyphAtlas::~GlyphAtlas()
+{
+    Memory::addExternal(Memory::Tag::Texture, -Application::getTextureBytes(texture));
+    Application::removeSprite(texture);
+    SDL_DestroyTexture(texture);
+}
+
+/**
+* This method returns a glyph. Characters that aren't in the atlas are drawn as '?'.
+*/
+const GlyphAtlas::Glyph& GlyphAtlas::getGlyph(const char character) const
+{
+    if (character < FIRST_GLYPH || character > LAST_GLYPH)
+    {
+        return glyphs['?' - FIRST_GLYPH];
+    }
+    return glyphs[character - FIRST_GLYPH];
+}
+
+/**
+* This method returns the distance to move the pen between two characters, including
+* any kerning between them.
+*/
+int GlyphAtlas::getAdvance(const char previous, const char character) const
+{
+    return getGlyph(previous).advance + TTF_GetFontKerningSizeGlyphs(font, previous, character);
+}
+
+/**
+* This method returns the distance between two lines of text.
+*/
+int GlyphAtlas::getLineSkip() const
+{
+    return line_skip;
+}
+
+SDL_Texture* GlyphAtlas::getTexture() const
+{
+    return texture;
+}
+
+int GlyphAtlas::getWidth() const
+{
+    return width;
+}
+
+int GlyphAtlas::getHeight() const
+{
+    return height;
+}
@@ -17,7 +17,7 @@ HealthPickup::HealthPickup(SDL_Texture* texture, const SDL_Rect& rect, const int
 void HealthPickup::draw()
 {
     SDL_Rect draw_rect = Application::convertToCameraView(rect);
-    SDL_RenderCopy(Application::getRenderer(), texture, nullptr, &draw_rect);
+    Application::drawTexture(RenderSnapshot::Layer::Pickups, texture, draw_rect);
 }
 
 SDL_Rect& HealthPickup::getRect()
@@ -29,3 +29,13 @@ int HealthPickup::getHealth()
 {
     return health;
 }
+
+int HealthPickup::getSpawnIndex()
+{
+    return spawn_index;
+}
+
+void HealthPickup::setSpawnIndex(const int spawn_index)
+{
+    this->spawn_index = spawn_index;
+}
@@ -0,0 +1,98 @@
+#include "InputFrame.h"
+
+/**
+* This method empties the input for a new frame, starting from where the mouse was at
+* the end of the last one.
+*/
+void InputFrame::clear(const SDL_Point& mouse_position)
+{
+    start_position = mouse_position;
+    event_count = 0;
+    motion_count = 0;
+    events.clear();
+}
+
+/**
+* This method adds an event to the frame.
+*/
+void InputFrame::add(const SDL_Event& event)
+{
+    event_count++;
+    if (event.type != SDL_MOUSEMOTION)
+    {
+        events.push_back(event);
+        return;
+    }
+
+    // Keep the newest event, but with the relative motion of them all.
+    const int relative_x = motion_count > 0 ? mouse_motion.motion.xrel : 0;
+    const int relative_y = motion_count > 0 ? mouse_motion.motion.yrel : 0;
+    mouse_motion = event;
+    mouse_motion.motion.xrel += relative_x;
+    mouse_motion.motion.yrel += relative_y;
+    motion_count++;
+}
+
+/**
+* This method returns every event that isn't mouse motion, in the order they happened.
+*/
+const Memory::Vector<SDL_Event, Memory::Tag::General>& InputFrame::getEvents() const
+{
+    return events;
+}
+
+/**
+* This method returns true if the mouse moved during the frame.
+*/
+bool InputFrame::hasMouseMotion() const
+{
+    return motion_count > 0;
+}
+
+/**
+* This method returns a single motion event that stands for all of the frame's motion.
+* It has the final position and time of the mouse, and the relative motion of every
+* motion event added together.
+*/
+const SDL_Event& InputFrame::getMouseMotion() const
+{
+    return mouse_motion;
+}
+
+/**
+* This method returns where the mouse was at the end of the frame.
+*/
+SDL_Point InputFrame::getMousePosition() const
+{
+    if (motion_count == 0)
+    {
+        return start_position;
+    }
+    return {mouse_motion.motion.x, mouse_motion.motion.y};
+}
+
+/**
+* This method returns how far the mouse moved over the frame.
+*/
+SDL_Point InputFrame::getMouseDelta() const
+{
+    const SDL_Point position = getMousePosition();
+    return {position.x - start_position.x, position.y - start_position.y};
+}
+
+/**
+* This method returns how many events were added, including the motion events that
+* were folded together.
+*/
+int InputFrame::getEventCount() const
+{
+    return event_count;
+}
+
+/**
+* This method returns how many mouse motion events were added.
+*/
+int InputFrame::getMotionCount() const
+{
+    return motion_count;
+}
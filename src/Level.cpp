@@ -1,5 +1,19 @@
 #include "Level.h"
 
+#include <algorithm>
+#include <cstdio>
+
+/**
+* This destructor frees the tile images.
+*/
+LevelLayout::~LevelLayout()
+{
+    for (auto& surface : tile_surfaces)
+    {
+        SDL_FreeSurface(surface.second);
+    }
+}
+
 /**
 * This method loads all of the data for a level from a file. It does not
 * render the level, it only parses the file and gathers all of the information
@@ -7,76 +21,98 @@
 */
 void Level::load(const std::string& file_name)
 {
-    clearPreviousLevelData();
-    this->file_name = file_name;
+    setLayout(prepare(file_name));
+}
 
-    DEBUG("Loading level: " << this->file_name);
+/**
+* This method loads everything about a level that doesn't need the renderer. It can
+* be called from any thread.
+*/
+std::shared_ptr<const LevelLayout> Level::prepare(const std::string& file_name)
+{
+    LOG_INFO(Level, "Loading level: " << file_name);
+
+    auto layout = std::make_shared<LevelLayout>();
+    layout->file_name = file_name;
+    LevelFile::load(layout->file_name, layout->data);
 
-    tinyxml2::XMLDocument doc;
+    // Use the collision and navigation data from the level cooker if there is any,
+    // otherwise work it out now.
+    std::vector<SDL_Rect> walls;
+    LevelCook::Data cooked;
+    if (LevelCook::read(LevelCook::getSidecarName(layout->file_name), layout->data, cooked))
+    {
+        layout->start_tile = cooked.start_tile;
+        LevelCook::getStartPaths(cooked, layout->start_paths);
+        layout->grid = std::move(cooked.grid);
+        walls = std::move(cooked.walls);
+    }
+    else
+    {
+        Navigation::buildGrid(layout->data, layout->grid);
+        walls = Navigation::mergeWalls(layout->grid);
+        layout->start_tile = LevelCook::findStart(layout->data);
+        Navigation::breadthFirstSearch(layout->grid, layout->start_tile, layout->start_paths);
+    }
 
-    if (doc.LoadFile(this->file_name.c_str()) != tinyxml2::XML_SUCCESS)
+    // Add walls, converting them from tiles to pixels.
+    for (const auto& wall : walls)
     {
-        SDL_SetError(doc.ErrorName());
-        throw Application::Error::XML;
+        layout->wall_rects.push_back({wall.x * TILE_SIZE, wall.y * TILE_SIZE, wall.w * TILE_SIZE, wall.h * TILE_SIZE});
     }
 
-    for (tinyxml2::XMLNode* node = doc.FirstChild(); node; node = node->NextSibling())
+    // Decode the image of every kind of tile used in the level.
+    bool used_tiles[256] = {};
+    for (int layer = 0; layer < layout->data.layer_count; layer++)
     {
-        std::string node_name = node->ToElement()->Name();
-        if (node_name == "about")
+        const char* tiles = layout->data.getLayer(layer);
+        for (int i = 0; i < layout->data.width * layout->data.height; i++)
         {
-            for (tinyxml2::XMLNode* about_node = node->FirstChild(); about_node; about_node = about_node->NextSibling())
-            {
-                std::string name = about_node->ToElement()->Name();
-                std::string text = about_node->ToElement()->GetText();
-                if (name == "title")
-                {
-                    title = text;
-                    DEBUG("Level title: " << title);
-                }
-                else if (name == "width")
-                {
-                    width = atoi(text.c_str());
-                    DEBUG("Level width: " << width);
-                }
-                else if (name == "height")
-                {
-                    height = atoi(text.c_str());
-                    DEBUG("Level height: " << height);
-                }
-            }
+            used_tiles[static_cast<unsigned char>(tiles[i])] = true;
         }
-
-        else if (node_name == "level")
+    }
+    for (int tile = 0; tile < 256; tile++)
+    {
+        // Ignore things that aren't tiles.
+        if (!used_tiles[tile] || tile == '0' || tile == '\0')
         {
-            for (tinyxml2::XMLNode* level_node = node->FirstChild(); level_node; level_node = level_node->NextSibling())
-            {
-                std::string level_node_name = level_node->ToElement()->Name();
-                if (level_node_name == "layers")
-                {
-#ifdef DEBUG_ENABLED
-                    int layer_num = 0;
-#endif // DEBUG_ENABLED
-                    for (tinyxml2::XMLNode* layer_node = level_node->FirstChild(); layer_node; layer_node = layer_node->NextSibling())
-                    {
-                        std::string layer_node_name = layer_node->ToElement()->Name();
-                        if (layer_node_name == "layer")
-                        {
-                            std::string layer_text = layer_node->ToElement()->GetText();
-                            processLayers(layer_text);
-                            DEBUG("Layer " << ++layer_num << ":" << std::endl << layer_text);
-                        }
-                    }
-                }
+            continue;
+        }
 
-                if (level_node_name == "objects")
-                {
-                    std::string object_text = level_node->ToElement()->GetText();
-                    processObjects(object_text);
-                }
-            }
+        std::string image_file = "Resources/Images/Tiles/";
+        image_file += static_cast<char>(tile);
+        image_file += ".png";
+
+        SDL_Surface* surface = IMG_Load(image_file.c_str());
+        if (surface == nullptr)
+        {
+            throw Application::Error::IMG;
         }
+        layout->tile_surfaces[image_file] = surface;
     }
+
+    return layout;
+}
+
+/**
+* This method switches to a level made by prepare. It spawns the level's enemies and
+* pickups, but like load it doesn't render the level.
+*/
+void Level::setLayout(std::shared_ptr<const LevelLayout> layout)
+{
+    clearPreviousLevelData();
+    this->layout = layout;
+    processObjects();
+
+    FlightRecorder::setNote("Level", layout->file_name);
+}
+
+/**
+* This method returns the layout of the current level.
+*/
+std::shared_ptr<const LevelLayout> Level::getLayout()
+{
+    return layout;
 }
 
 /**
@@ -84,49 +120,75 @@ void Level::load(const std::string& file_name)
 */
 void Level::render()
 {
-    // If the texture has been loaded before, destroy it.
-    if (map_texture != nullptr)
+    // The map is drawn with the renderer, which can only be used on the main thread.
+    Application::runOnMainThread([this]()
     {
-        SDL_DestroyTexture(map_texture);
-    }
+        // If the texture has been loaded before, destroy it.
+        if (map_texture != nullptr)
+        {
+            Memory::addExternal(Memory::Tag::Texture, -Application::getTextureBytes(map_texture));
+            Application::removeSprite(map_texture);
+            SDL_DestroyTexture(map_texture);
+        }
 
-    // Create a map texture and set it as the render target.
-    map_texture = SDL_CreateTexture(Application::getRenderer(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width * TILE_SIZE, height * TILE_SIZE);
-    map_rect = {0, 0, width * TILE_SIZE, height * TILE_SIZE};
-    SDL_SetRenderTarget(Application::getRenderer(), map_texture);
-    SDL_RenderClear(Application::getRenderer());
+        // Upload the tile images that were decoded when the level was prepared.
+        for (const auto& surface : layout->tile_surfaces)
+        {
+            Application::addTexture(surface.first, surface.second);
+        }
 
-    SDL_Rect tile_rect = {0, 0, TILE_SIZE, TILE_SIZE};
+        const LevelFile::Data& data = layout->data;
 
-    // This is so every layer in the map gets drawn.
-    for (const auto& layer : map_data)
-    {
-        for (int y = 0; y < height; y++)
+        // Create a map texture and set it as the render target.
+        map_texture = SDL_CreateTexture(Application::getRenderer(), SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, data.width * TILE_SIZE, data.height * TILE_SIZE);
+        map_rect = {0, 0, data.width * TILE_SIZE, data.height * TILE_SIZE};
+        if (map_texture == nullptr)
         {
-            for (int x = 0; x < width; x++)
+            // Very large levels can be bigger than the biggest texture the renderer supports.
+            // They can still be played, the map just isn't drawn.
+            LOG_WARNING(Level, "Unable to create a " << map_rect.w << "x" << map_rect.h << " map texture, the map won't be drawn: "
+                        << SDL_GetError());
+            return;
+        }
+        Memory::addExternal(Memory::Tag::Texture, Application::getTextureBytes(map_texture));
+        Application::addSprite(map_texture);
+        SDL_SetRenderTarget(Application::getRenderer(), map_texture);
+        SDL_RenderClear(Application::getRenderer());
+
+        SDL_Rect tile_rect = {0, 0, TILE_SIZE, TILE_SIZE};
+
+        // This is so every layer in the map gets drawn.
+        for (int layer = 0; layer < data.layer_count; layer++)
+        {
+            for (int y = 0; y < data.height; y++)
             {
-                // Ignore things that aren't tiles.
-                if (layer[y][x] == '0' || layer[y][x] == '\0')
+                for (int x = 0; x < data.width; x++)
                 {
-                    continue;
-                }
+                    const char tile = data.getTile(layer, x, y);
+
+                    // Ignore things that aren't tiles.
+                    if (tile == '0' || tile == '\0')
+                    {
+                        continue;
+                    }
 
-                // Get the string for the image of the tile.
-                std::string image_file;
-                image_file += "Resources/Images/Tiles/";
-                image_file += layer[y][x];
-                image_file += ".png";
+                    // Get the string for the image of the tile.
+                    std::string image_file;
+                    image_file += "Resources/Images/Tiles/";
+                    image_file += tile;
+                    image_file += ".png";
 
-                // Load and render the tile.
-                tile_rect.y = y * TILE_SIZE;
-                tile_rect.x = x * TILE_SIZE;
-                SDL_RenderCopy(Application::getRenderer(), Application::getTexture(image_file), nullptr, &tile_rect);
+                    // Load and render the tile.
+                    tile_rect.y = y * TILE_SIZE;
+                    tile_rect.x = x * TILE_SIZE;
+                    SDL_RenderCopy(Application::getRenderer(), Application::getTexture(image_file), nullptr, &tile_rect);
+                }
             }
         }
-    }
 
-    SDL_RenderPresent(Application::getRenderer());
-    SDL_SetRenderTarget(Application::getRenderer(), nullptr);
+        SDL_RenderPresent(Application::getRenderer());
+        SDL_SetRenderTarget(Application::getRenderer(), nullptr);
+    });
 }
 
 /**
@@ -134,9 +196,32 @@ void Level::render()
 */
 void Level::update(Player& player)
 {
-    for (auto& enemy : enemies)
+    PROFILE_ZONE("Level::update");
+
     {
-        enemy->update(this, player);
+        PROFILE_ZONE("Enemy::update");
+
+        // Every enemy decides where it is going first, so that the directions for all of them
+        // can be worked out eight at a time before any of them move.
+        const std::size_t enemy_count = enemies.size();
+        enemy_centres.resize(enemy_count);
+        node_centres.resize(enemy_count);
+        player_centres.resize(enemy_count);
+        node_directions.resize(enemy_count);
+        player_directions.resize(enemy_count);
+        for (std::size_t i = 0; i < enemy_count; i++)
+        {
+            enemies[i]->think(this, player, enemy_centres[i], node_centres[i], player_centres[i]);
+        }
+
+        Maths::getDirections(enemy_centres.data(), node_centres.data(), node_directions.data(), enemy_count);
+        Maths::getDirections(enemy_centres.data(), player_centres.data(), player_directions.data(), enemy_count);
+
+        for (std::size_t i = 0; i < enemy_count; i++)
+        {
+            enemies[i]->setDirections(node_directions[i], player_directions[i]);
+            enemies[i]->update(this, player);
+        }
     }
 
     for (auto& projectile : enemy_projectiles)
@@ -144,13 +229,18 @@ void Level::update(Player& player)
         projectile.update();
     }
 
-    for (auto& wall : wall_rects)
     {
+        PROFILE_ZONE("Enemy projectile collision");
+        removeProjectilesInWalls(enemy_projectiles);
+
+        Telemetry::add(Telemetry::Counter::CollisionTests, enemy_projectiles.size());
         for (auto projectile = enemy_projectiles.begin(); projectile != enemy_projectiles.end();)
         {
-            if (SDL_HasIntersection(&wall, &projectile->getRect()))
+            if (SDL_HasIntersection(&projectile->getRect(), &player.getRect()))
             {
-                enemy_projectiles.erase(projectile);
+                player.damage(projectile->getDamage());
+                projectile = enemy_projectiles.erase(projectile);
+                Telemetry::add(Telemetry::Counter::ProjectilesCulled);
             }
             else
             {
@@ -158,19 +248,6 @@ void Level::update(Player& player)
             }
         }
     }
-
-    for (auto projectile = enemy_projectiles.begin(); projectile != enemy_projectiles.end();)
-    {
-        if (SDL_HasIntersection(&projectile->getRect(), &player.getRect()))
-        {
-            player.damage(projectile->getDamage());
-            enemy_projectiles.erase(projectile);
-        }
-        else
-        {
-            projectile++;
-        }
-    }
 }
 
 /**
@@ -178,8 +255,13 @@ void Level::update(Player& player)
 */
 void Level::draw()
 {
-    SDL_Rect draw_rect = Application::convertToCameraView(map_rect);
-    SDL_RenderCopy(Application::getRenderer(), map_texture, nullptr, &draw_rect);
+    PROFILE_ZONE("Level::draw");
+
+    if (map_texture != nullptr)
+    {
+        SDL_Rect draw_rect = Application::convertToCameraView(map_rect);
+        Application::drawTexture(RenderSnapshot::Layer::Map, map_texture, draw_rect);
+    }
 
     for (auto& pickup : ammo_pickups)
     {
@@ -212,7 +294,7 @@ void Level::draw()
 */
 const std::string& Level::getFileName()
 {
-    return file_name;
+    return layout->file_name;
 }
 
 /**
@@ -220,7 +302,7 @@ const std::string& Level::getFileName()
 */
 const std::string& Level::getTitle()
 {
-    return title;
+    return layout->data.title;
 }
 
 /**
@@ -236,13 +318,54 @@ SDL_Rect& Level::getStartRect()
 */
 const std::vector<SDL_Rect>& Level::getWallRects()
 {
-    return wall_rects;
+    return layout->wall_rects;
+}
+
+/**
+* This method returns whether or not a line between two points, in pixels, misses
+* every wall in the level.
+*/
+bool Level::hasLineOfSight(const SDL_Point& from, const SDL_Point& to)
+{
+    Telemetry::add(Telemetry::Counter::LineOfSightRays);
+    return std::none_of(layout->wall_rects.begin(), layout->wall_rects.end(), [&](const SDL_Rect& wall)
+    {
+        // SDL clips the line to the wall, so every wall gets its own copy of it.
+        int x1 = from.x;
+        int y1 = from.y;
+        int x2 = to.x;
+        int y2 = to.y;
+        return SDL_IntersectRectAndLine(&wall, &x1, &y1, &x2, &y2);
+    });
+}
+
+/**
+* This method removes every projectile that has hit a wall.
+*/
+void Level::removeProjectilesInWalls(ProjectileVector& projectiles)
+{
+    for (auto& wall : layout->wall_rects)
+    {
+        Telemetry::add(Telemetry::Counter::CollisionTests, projectiles.size());
+        for (auto projectile = projectiles.begin(); projectile != projectiles.end();)
+        {
+            if (SDL_HasIntersection(&wall, &projectile->getRect()))
+            {
+                projectile = projectiles.erase(projectile);
+                Telemetry::add(Telemetry::Counter::ProjectilesCulled);
+            }
+            else
+            {
+                projectile++;
+            }
+        }
+    }
 }
 
 /**
 * This method returns a vector of every ammo pickup in the level.
 */
-std::vector<AmmoPickup>& Level::getAmmoPickups()
+LevelVector<AmmoPickup>& Level::getAmmoPickups()
 {
     return ammo_pickups;
 }
@@ -250,7 +373,7 @@ std::vector<AmmoPickup>& Level::getAmmoPickups()
 /**
 * This method returns a vector of every weapon pickup in the level.
 */
-std::vector<WeaponPickup>& Level::getWeaponPickups()
+LevelVector<WeaponPickup>& Level::getWeaponPickups()
 {
     return weapon_pickups;
 }
@@ -258,7 +381,7 @@ std::vector<WeaponPickup>& Level::getWeaponPickups()
 /**
 * This method returns a vector of every health pickup in the level.
 */
-std::vector<HealthPickup>& Level::getHealthPickups()
+LevelVector<HealthPickup>& Level::getHealthPickups()
 {
     return health_pickups;
 }
@@ -266,150 +389,227 @@ std::vector<HealthPickup>& Level::getHealthPickups()
 /**
 * This method returns a vector of every enemy in the level.
 */
-std::vector<std::shared_ptr<Enemy>>& Level::getEnemies()
+LevelVector<std::shared_ptr<Enemy>>& Level::getEnemies()
 {
     return enemies;
 }
 
-std::vector<Projectile>& Level::getEnemyProjectiles()
+ProjectileVector& Level::getEnemyProjectiles()
 {
     return enemy_projectiles;
 }
 
 /**
-* This destructor is needed to destroy the current map texture.
+* This method returns a vector of every checkpoint in the level that hasn't been reached.
 */
-Level::~Level()
+LevelVector<Checkpoint>& Level::getCheckpoints()
 {
-    // We need to destroy the map texture because it is created by this class and
-    // is not loaded in the Application namespace.
-    SDL_DestroyTexture(map_texture);
+    return checkpoints;
 }
 
 /**
-* This method processes all of the objects in the level, such as weapon pickups
-* and player starting position.
+* This method gets the current state of the level.
 */
-void Level::processObjects(std::string& object_text)
+Level::State Level::getState()
 {
-    // Remove all white space from the object data because it may be indented, and spaces aren't needed.
-    object_text.erase(std::remove(object_text.begin(), object_text.end(), ' '), object_text.end());
-
-    // Remove newlines from the beginning and end of the object data, as they would mess with splitting by lines.
-    object_text.erase(object_text.begin());
-    object_text.pop_back();
+    State state;
+    for (auto& pickup : ammo_pickups)
+    {
+        state.objects.push_back(pickup.getSpawnIndex());
+    }
+    for (auto& pickup : weapon_pickups)
+    {
+        state.objects.push_back(pickup.getSpawnIndex());
+    }
+    for (auto& pickup : health_pickups)
+    {
+        state.objects.push_back(pickup.getSpawnIndex());
+    }
+    for (auto& checkpoint : checkpoints)
+    {
+        state.objects.push_back(checkpoint.spawn_index);
+    }
+    for (auto& enemy : enemies)
+    {
+        state.enemies.push_back(enemy->getState());
+    }
+    for (auto& projectile : enemy_projectiles)
+    {
+        state.enemy_projectiles.push_back(projectile.getState());
+    }
+    return state;
+}
 
-    DEBUG("Objects: " << std::endl << object_text);
+/**
+* This method sets the state of the level. The layout of the level must be the one
+* the state was taken from.
+*/
+void Level::setState(const State& state)
+{
+    clearPreviousLevelData();
 
-    // Split the object data by line.
-    auto object_data = Tools::splitString(object_text, '\n');
+    const int object_count = layout->data.objects.size();
+    for (int i = 0; i < object_count; i++)
+    {
+        if (layout->data.objects[i].type == 'A')
+        {
+            spawnObject(i);
+        }
+    }
 
-    SDL_Rect object_rect = {0, 0, TILE_SIZE, TILE_SIZE};
-    for (int y = 0; y < height; y++)
+    for (int index : state.objects)
     {
-        for (int x = 0; x < width; x++)
+        if (index >= 0 && index < object_count)
         {
-            object_rect.y = y * TILE_SIZE;
-            object_rect.x = x * TILE_SIZE;
+            spawnObject(index);
+        }
+    }
 
-            // Process object data.
-            switch (object_data[y][x])
-            {
-            case 'A':
-                player_rect = object_rect;
-                break;
-            case 'B':
-                {
-                    auto zombie = std::make_shared<Zombie>(object_rect);
-                    enemies.push_back(zombie);
-                }
-                break;
-            case 'C':
-                {
-                    auto demon = std::make_shared<Demon>(object_rect);
-                    enemies.push_back(demon);
-                }
-                break;
-            case 'D':
-                {
-                    auto hound = std::make_shared<Hound>(object_rect);
-                    enemies.push_back(hound);
-                }
-                break;
-            case 'E':
-                {
-                    auto boss = std::make_shared<Boss>(object_rect);
-                    enemies.push_back(boss);
-                }
-                break;
-            case 'F':
-                ammo_pickups.emplace_back(Application::getTexture("Resources/Images/HandgunAmmoPickup.png"), object_rect, 10, Weapon::Handgun);
-                break;
-            case 'G':
-                ammo_pickups.emplace_back(Application::getTexture("Resources/Images/ShotgunAmmoPickup.png"), object_rect, 20, Weapon::Shotgun);
-                break;
-            case 'H':
-                ammo_pickups.emplace_back(Application::getTexture("Resources/Images/AssaultRifleAmmoPickup.png"), object_rect, 20, Weapon::AssaultRifle);
-                break;
-            case 'I':
-                ammo_pickups.emplace_back(Application::getTexture("Resources/Images/MinigunAmmoPickup.png"), object_rect, 20, Weapon::Minigun);
-                break;
-            case 'J':
-                ammo_pickups.emplace_back(Application::getTexture("Resources/Images/PlasmaAmmoPickup.png"), object_rect, 20, Weapon::PlasmaRifle);
-                break;
-            case 'K':
-                weapon_pickups.emplace_back(Application::getTexture("Resources/Images/Shotgun.png"), object_rect, 4, Weapon::Shotgun);
-                break;
-            case 'L':
-                weapon_pickups.emplace_back(Application::getTexture("Resources/Images/AssaultRifle.png"), object_rect, 25, Weapon::AssaultRifle);
-                break;
-            case 'M':
-                weapon_pickups.emplace_back(Application::getTexture("Resources/Images/Minigun.png"), object_rect, 30, Weapon::Minigun);
-                break;
-            case 'N':
-                weapon_pickups.emplace_back(Application::getTexture("Resources/Images/PlasmaRifle.png"), object_rect, 10, Weapon::PlasmaRifle);
-                break;
-            case 'O':
-                health_pickups.emplace_back(Application::getTexture("Resources/Images/Stimpack.png"), object_rect, 10);
-                break;
-            case 'P':
-                health_pickups.emplace_back(Application::getTexture("Resources/Images/Medkit.png"), object_rect, 25);
-                break;
-            default:
-                break;
-            }
+    for (const auto& enemy_state : state.enemies)
+    {
+        // Only use the state if its object really did spawn an enemy.
+        const std::size_t enemy_count = enemies.size();
+        if (enemy_state.spawn_index >= 0 && enemy_state.spawn_index < object_count)
+        {
+            spawnObject(enemy_state.spawn_index);
+        }
+        if (enemies.size() > enemy_count)
+        {
+            enemies.back()->setState(enemy_state);
         }
     }
+
+    for (const auto& projectile_state : state.enemy_projectiles)
+    {
+        enemy_projectiles.emplace_back(projectile_state);
+    }
 }
 
 /**
-* This method processes all of the layers in the level.
+* This destructor is needed to destroy the current map texture.
 */
-void Level::processLayers(std::string& layer_text)
+Level::~Level()
 {
-    // Remove all white space from the layer data because it may be indented, and spaces aren't needed.
-    layer_text.erase(std::remove(layer_text.begin(), layer_text.end(), ' '), layer_text.end());
+    // We need to destroy the map texture because it is created by this class and
+    // is not loaded in the Application namespace. Levels can outlive the renderer, which
+    // destroys every texture made with it, so then there is nothing left to destroy.
+    if (map_texture != nullptr && Application::getRenderer() != nullptr)
+    {
+        Memory::addExternal(Memory::Tag::Texture, -Application::getTextureBytes(map_texture));
+        Application::runOnMainThread([this]()
+        {
+            Application::removeSprite(map_texture);
+            SDL_DestroyTexture(map_texture);
+        });
+    }
+}
 
-    // Remove newlines from the beginning and end of the layer data, as they would mess with splitting by lines.
-    layer_text.erase(layer_text.begin());
-    layer_text.pop_back();
+/**
+* This method processes all of the objects in the level, such as weapon pickups
+* and player starting position.
+*/
+void Level::processObjects()
+{
+    for (unsigned i = 0; i < layout->data.objects.size(); i++)
+    {
+        spawnObject(i);
+    }
+}
 
-    // Split the layer data by line.
-    auto layer_data = Tools::splitString(layer_text, '\n');
+/**
+* This method spawns a single object from the level file.
+*/
+void Level::spawnObject(const int index)
+{
+    const LevelFile::Object& object = layout->data.objects[index];
+    SDL_Rect object_rect = {object.x * TILE_SIZE, object.y * TILE_SIZE, TILE_SIZE, TILE_SIZE};
 
-    for (int y = 0; y < height; y++)
+    // Process object data.
+    switch (object.type)
     {
-        for (int x = 0; x < width; x++)
+    case 'A':
+        // The player always starts on the first player object, the same tile the paths
+        // are worked out from, even if the level has more than one.
+        player_rect = {layout->start_tile.x * TILE_SIZE, layout->start_tile.y * TILE_SIZE, TILE_SIZE, TILE_SIZE};
+        break;
+    case 'B':
         {
-            if (layer_data[y][x] == '2')
-            {
-                // Add walls.
-                wall_rects.push_back({x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE});
-            }
+            auto zombie = std::allocate_shared<Zombie>(Memory::Allocator<Zombie, Memory::Tag::Enemy>(), object_rect);
+            zombie->setSpawnIndex(index);
+            enemies.push_back(zombie);
+        }
+        break;
+    case 'C':
+        {
+            auto demon = std::allocate_shared<Demon>(Memory::Allocator<Demon, Memory::Tag::Enemy>(), object_rect);
+            demon->setSpawnIndex(index);
+            enemies.push_back(demon);
         }
+        break;
+    case 'D':
+        {
+            auto hound = std::allocate_shared<Hound>(Memory::Allocator<Hound, Memory::Tag::Enemy>(), object_rect);
+            hound->setSpawnIndex(index);
+            enemies.push_back(hound);
+        }
+        break;
+    case 'E':
+        {
+            auto boss = std::allocate_shared<Boss>(Memory::Allocator<Boss, Memory::Tag::Enemy>(), object_rect);
+            boss->setSpawnIndex(index);
+            enemies.push_back(boss);
+        }
+        break;
+    case 'F':
+        ammo_pickups.emplace_back(Application::getTexture("Resources/Images/HandgunAmmoPickup.png"), object_rect, 10, Weapon::Handgun);
+        ammo_pickups.back().setSpawnIndex(index);
+        break;
+    case 'G':
+        ammo_pickups.emplace_back(Application::getTexture("Resources/Images/ShotgunAmmoPickup.png"), object_rect, 20, Weapon::Shotgun);
+        ammo_pickups.back().setSpawnIndex(index);
+        break;
+    case 'H':
+        ammo_pickups.emplace_back(Application::getTexture("Resources/Images/AssaultRifleAmmoPickup.png"), object_rect, 20, Weapon::AssaultRifle);
+        ammo_pickups.back().setSpawnIndex(index);
+        break;
+    case 'I':
+        ammo_pickups.emplace_back(Application::getTexture("Resources/Images/MinigunAmmoPickup.png"), object_rect, 20, Weapon::Minigun);
+        ammo_pickups.back().setSpawnIndex(index);
+        break;
+    case 'J':
+        ammo_pickups.emplace_back(Application::getTexture("Resources/Images/PlasmaAmmoPickup.png"), object_rect, 20, Weapon::PlasmaRifle);
+        ammo_pickups.back().setSpawnIndex(index);
+        break;
+    case 'K':
+        weapon_pickups.emplace_back(Application::getTexture("Resources/Images/Shotgun.png"), object_rect, 4, Weapon::Shotgun);
+        weapon_pickups.back().setSpawnIndex(index);
+        break;
+    case 'L':
+        weapon_pickups.emplace_back(Application::getTexture("Resources/Images/AssaultRifle.png"), object_rect, 25, Weapon::AssaultRifle);
+        weapon_pickups.back().setSpawnIndex(index);
+        break;
+    case 'M':
+        weapon_pickups.emplace_back(Application::getTexture("Resources/Images/Minigun.png"), object_rect, 30, Weapon::Minigun);
+        weapon_pickups.back().setSpawnIndex(index);
+        break;
+    case 'N':
+        weapon_pickups.emplace_back(Application::getTexture("Resources/Images/PlasmaRifle.png"), object_rect, 10, Weapon::PlasmaRifle);
+        weapon_pickups.back().setSpawnIndex(index);
+        break;
+    case 'O':
+        health_pickups.emplace_back(Application::getTexture("Resources/Images/Stimpack.png"), object_rect, 10);
+        health_pickups.back().setSpawnIndex(index);
+        break;
+    case 'P':
+        health_pickups.emplace_back(Application::getTexture("Resources/Images/Medkit.png"), object_rect, 25);
+        health_pickups.back().setSpawnIndex(index);
+        break;
+    case 'Q':
+        checkpoints.push_back({object_rect, index});
+        break;
+    default:
+        break;
     }
-
-    map_data.push_back(layer_data);
 }
 
 /**
@@ -418,18 +618,6 @@ void Level::processLayers(std::string& layer_text)
 */
 void Level::clearPreviousLevelData()
 {
-    // If loading a new level, clear all of the previous map data.
-    if (!map_data.empty())
-    {
-        map_data.clear();
-    }
-
-    // If loading a new level, clear all of the previous wall locations.
-    if (!wall_rects.empty())
-    {
-        wall_rects.clear();
-    }
-
     // If loading a new level, clear all of the previous ammo pickups.
     if (!ammo_pickups.empty())
     {
@@ -457,45 +645,10 @@ void Level::clearPreviousLevelData()
     {
         health_pickups.clear();
     }
-}
 
-/**
-* This method generates the grid used for pathfinding. It simply makes a grid
-* which stores walls and non-walls.
-*/
-void Level::generateAIGrid()
-{
-    // Clear the previous AI grid so that it doesn't mess with the new one.
-    if (!grid.empty())
+    if (!checkpoints.empty())
     {
-        grid.clear();
-    }
-
-    // Set the grid to a certain width and height so that we don't have to use
-    // push_back or any methods like that. We can access every part of the grid directly.
-    grid = std::vector<std::vector<char>>(height, std::vector<char>(width));
-
-    // To catch every wall in the map, we have to look through every layer.
-    for (auto& layer : map_data)
-    {
-        for (int y = 0; y < height; y++)
-        {
-            for (int x = 0; x < width; x++)
-            {
-                // If the current tile is a wall in the layer or the grid.
-                if (layer[y][x] == '2' || grid[y][x] == '2')
-                {
-                    // Set it in the grid.
-                    grid[y][x] = '2';
-                }
-                // If the current tile is not a wall, we can set it to a '1', which
-                // represents a non-traversable tile.
-                else
-                {
-                    grid[y][x] = '1';
-                }
-            }
-        }
+        checkpoints.clear();
     }
 }
 
@@ -505,81 +658,84 @@ void Level::generateAIGrid()
 */
 void Level::breadthFirstSearch(const SDL_Point& start_tile)
 {
+    PROFILE_ZONE("Level::breadthFirstSearch");
+    Memory::TagScope tag_scope(Memory::Tag::Path);
+
+    Uint64 start_time = SDL_GetPerformanceCounter();
     this->start_tile = start_tile;
-    std::queue<SDL_Point> frontier;
-    frontier.push(this->start_tile);
 
-    // If a this method has been run before, the map of paths has to be cleared so that it doesn't interfere with the
-    // new map of paths.
-    if (!came_from.empty())
+    // The paths from the player's start were worked out when the level was prepared.
+    int reached;
+    if (start_tile.x == layout->start_tile.x && start_tile.y == layout->start_tile.y)
     {
-        came_from.clear();
+        came_from = layout->start_paths;
+        reached = std::count_if(came_from.begin(), came_from.end(), [](int tile){return tile != Navigation::UNVISITED;});
     }
-
-    // Every path found by the algorithm starts here, so we set it to itself.
-    came_from[std::make_pair(this->start_tile.x, this->start_tile.y)] = std::make_pair(this->start_tile.x, this->start_tile.y);
-
-    SDL_Point current;
-    while (!frontier.empty())
+    else
     {
-        current = frontier.front();
+        reached = Navigation::breadthFirstSearch(layout->grid, this->start_tile, came_from);
+        Telemetry::add(Telemetry::Counter::BFSNodes, reached);
+    }
 
-        // Check every tile above, below and to the sides of the current tile.
-        checkTile(frontier, current.x + 1, current.y, current.x, current.y);
-        checkTile(frontier, current.x - 1, current.y, current.x, current.y);
-        checkTile(frontier, current.x, current.y + 1, current.x, current.y);
-        checkTile(frontier, current.x, current.y - 1, current.x, current.y);
+    bfs_time = (SDL_GetPerformanceCounter() - start_time) * 1000000.0 / SDL_GetPerformanceFrequency();
+    bfs_tiles_reached = reached;
 
-        // Check every tile diagonally to the current tile, to allow for diagonal pathfinding.
-        checkTile(frontier, current.x + 1, current.y - 1, current.x, current.y);
-        checkTile(frontier, current.x + 1, current.y + 1, current.x, current.y);
-        checkTile(frontier, current.x - 1, current.y - 1, current.x, current.y);
-        checkTile(frontier, current.x - 1, current.y + 1, current.x, current.y);
+    PROFILE_COUNTER("BFS tiles reached", reached);
+    char note[64];
+    std::snprintf(note, sizeof(note), "Start (%d, %d), %d tiles reached", start_tile.x, start_tile.y, reached);
+    FlightRecorder::setNote("BFS", note);
+}
 
-        frontier.pop();
-    }
+/**
+* This method returns how long the last breadth first search took, in microseconds.
+*/
+float Level::getBFSTime()
+{
+    return bfs_time;
 }
 
 /**
-* This method returns a list of each tile from end_tile to start_tile.
+* This method returns how many tiles the last breadth first search reached.
 */
-std::deque<SDL_Point> Level::getPathToTile(const SDL_Point& end_tile)
+int Level::getBFSTilesReached()
 {
-    std::deque<SDL_Point> path;
+    return bfs_tiles_reached;
+}
 
-    // Tiles are stored as their 2D co-ordinates in the map (not as resolution co-ordinates.)
-    std::pair<int, int> current_tile(end_tile.x, end_tile.y);
+/**
+* This method fills path with each tile from end_tile to start_tile. The path is
+* filled in place so that its memory can be reused.
+*/
+void Level::getPathToTile(const SDL_Point& end_tile, TilePath& path)
+{
+    path.clear();
+    const Navigation::Grid& grid = layout->grid;
+
+    // Tiles are stored by their index in the grid (not as resolution co-ordinates.)
+    const int start_index = (start_tile.y * grid.width) + start_tile.x;
+    int current_index = (end_tile.y * grid.width) + end_tile.x;
+
+    // If the end tile can't be reached from start_tile, the path just stays where it is.
+    if (!grid.isWalkable(end_tile.x, end_tile.y) || came_from[current_index] == Navigation::UNVISITED)
+    {
+        path.assign(2, end_tile);
+        return;
+    }
 
     // Start the path at the end tile.
-    path.push_front({current_tile.first, current_tile.second});
+    path.push_back(end_tile);
 
     // Until the current tile of the path is the same as the start_tile, add
-    // it to the path deque and set the tile to the next tile in the path.
-    while (came_from[current_tile] != std::make_pair(start_tile.x, start_tile.y))
+    // it to the path and set the tile to the next tile in the path.
+    while (came_from[current_index] != start_index)
     {
-        current_tile = came_from[current_tile];
-        path.push_front({current_tile.first, current_tile.second});
+        current_index = came_from[current_index];
+        path.push_back({current_index % grid.width, current_index / grid.width});
     }
 
     // End the path at the start tile.
-    path.push_front(start_tile);
-
-    return path;
-}
+    path.push_back(start_tile);
 
-void Level::checkTile(std::queue<SDL_Point>& frontier, const int x, const int y, const int orig_x, const int orig_y)
-{
-    // If the tile is traversable.
-    if (grid[y][x] == '1')
-    {
-        // If it has not been visited before.
-        if (came_from.find(std::make_pair(x, y)) == came_from.end())
-        {
-            // Add it to the frontier.
-            frontier.push({x, y});
-
-            // And store it in the path.
-            came_from[std::make_pair(x, y)] = std::make_pair(orig_x, orig_y);
-        }
-    }
+    // The path is followed from the back, so the end tile has to be last.
+    std::reverse(path.begin(), path.end());
 }
@@ -0,0 +1,404 @@
+#include "LevelCook.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+/**
+* This namespace builds, reads and writes cooked level data. Cooked data is what loading
+* a level would otherwise work out from its tiles: the merged wall rects, the walkable
+* grid and the paths from the player's start. It is stored in a sidecar file next to the
+* level (see getSidecarName), with the walkable grid packed into one bit per tile.
+*/
+namespace LevelCook
+{
+    /**
+    * This anonymous namespace holds helpers for cooking and for the sidecar file.
+    */
+    namespace
+    {
+        const char MAGIC[4] = {'L', 'V', 'L', 'C'};
+        const std::uint32_t VERSION = 2;
+        const char EXTENSION[] = ".lvlc";
+
+        // This value in start_directions marks the start tile itself.
+        const std::uint8_t START = 8;
+
+        /**
+        * This function hashes some bytes into a running FNV-1a hash.
+        */
+        void hashBytes(std::uint64_t& hash, const void* bytes, const std::size_t size)
+        {
+            const unsigned char* data = static_cast<const unsigned char*>(bytes);
+            for (std::size_t i = 0; i < size; i++)
+            {
+                hash ^= data[i];
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        /**
+        * This function returns the name of an object for validation messages.
+        */
+        std::string getObjectName(const char type)
+        {
+            switch (type)
+            {
+            case 'B': return "Zombie";
+            case 'C': return "Demon";
+            case 'D': return "Hound";
+            case 'E': return "Boss";
+            case 'F': return "Handgun ammo";
+            case 'G': return "Shotgun ammo";
+            case 'H': return "Assault rifle ammo";
+            case 'I': return "Minigun ammo";
+            case 'J': return "Plasma rifle ammo";
+            case 'K': return "Shotgun";
+            case 'L': return "Assault rifle";
+            case 'M': return "Minigun";
+            case 'N': return "Plasma rifle";
+            case 'O': return "Stimpack";
+            case 'P': return "Medkit";
+            case 'Q': return "Checkpoint";
+            default: return std::string("Object '") + type + "'";
+            }
+        }
+
+        /**
+        * This function returns whether or not every stored direction leads back to a tile
+        * in the level, so that getStartPaths can't make a came_from map that points outside
+        * of it.
+        */
+        bool hasValidStartPaths(const Data& cooked)
+        {
+            const int width = cooked.grid.width;
+            const int height = cooked.grid.height;
+            const int start_index = (cooked.start_tile.y * width) + cooked.start_tile.x;
+            for (std::size_t i = 0; i < cooked.start_directions.size(); i++)
+            {
+                const std::uint8_t direction = cooked.start_directions[i];
+                if (direction == UNREACHABLE)
+                {
+                    continue;
+                }
+                if (direction == START)
+                {
+                    if (static_cast<int>(i) != start_index)
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                if (direction >= START)
+                {
+                    return false;
+                }
+
+                SDL_Point offset = Navigation::getDirectionOffset(direction);
+                const int from_x = (static_cast<int>(i) % width) - offset.x;
+                const int from_y = (static_cast<int>(i) / width) - offset.y;
+                if (from_x < 0 || from_y < 0 || from_x >= width || from_y >= height)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename T>
+        void writeValue(std::ofstream& file, const T& value)
+        {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        void writeVector(std::ofstream& file, const std::vector<T>& values)
+        {
+            writeValue<std::uint64_t>(file, values.size());
+            file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+        }
+
+        template <typename T>
+        bool readValue(std::ifstream& file, T& value)
+        {
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        template <typename T>
+        bool readVector(std::ifstream& file, std::vector<T>& values, const std::uint64_t max_size)
+        {
+            std::uint64_t size;
+            if (!readValue(file, size) || size > max_size)
+            {
+                return false;
+            }
+            values.resize(size);
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), size * sizeof(T)));
+        }
+
+        /**
+        * This function packs one byte per tile, which is either 0 or 1, into one bit per tile.
+        */
+        std::vector<std::uint8_t> packBits(const std::vector<std::uint8_t>& bytes)
+        {
+            std::vector<std::uint8_t> bits((bytes.size() + 7) / 8, 0);
+            for (std::size_t i = 0; i < bytes.size(); i++)
+            {
+                if (bytes[i])
+                {
+                    bits[i / 8] |= 1 << (i % 8);
+                }
+            }
+            return bits;
+        }
+
+        /**
+        * This function unpacks bits made by packBits back into one byte per tile.
+        */
+        void unpackBits(const std::vector<std::uint8_t>& bits, const std::size_t count, std::vector<std::uint8_t>& bytes)
+        {
+            bytes.resize(count);
+            for (std::size_t i = 0; i < count; i++)
+            {
+                bytes[i] = (bits[i / 8] >> (i % 8)) & 1;
+            }
+        }
+    }
+
+    /**
+    * This function returns the name of the sidecar file for a level. The same sidecar is
+    * used for both the ".lvl" and ".lvlb" versions of a level.
+    */
+    std::string getSidecarName(const std::string& level_file_name)
+    {
+        return level_file_name.substr(0, level_file_name.find_last_of('.')) + EXTENSION;
+    }
+
+    /**
+    * This function hashes the tiles and objects of a level, so that a sidecar that was
+    * cooked from a different version of the level is not used.
+    */
+    std::uint64_t hashLevel(const LevelFile::Data& level)
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+        hashBytes(hash, &level.width, sizeof(level.width));
+        hashBytes(hash, &level.height, sizeof(level.height));
+        hashBytes(hash, &level.layer_count, sizeof(level.layer_count));
+        for (int layer = 0; layer < level.layer_count; layer++)
+        {
+            hashBytes(hash, level.getLayer(layer), static_cast<std::size_t>(level.width) * level.height);
+        }
+        for (const auto& object : level.objects)
+        {
+            hashBytes(hash, &object.x, sizeof(object.x));
+            hashBytes(hash, &object.y, sizeof(object.y));
+            hashBytes(hash, &object.type, sizeof(object.type));
+        }
+        return hash;
+    }
+
+    /**
+    * This function returns the tile the player starts on, which is the first player
+    * object in the level, or (-1, -1) if there isn't one.
+    */
+    SDL_Point findStart(const LevelFile::Data& level)
+    {
+        for (const auto& object : level.objects)
+        {
+            if (object.type == 'A')
+            {
+                return {object.x, object.y};
+            }
+        }
+        return {-1, -1};
+    }
+
+    /**
+    * This function works out all of the cooked data for a level.
+    */
+    void cook(const LevelFile::Data& level, Data& cooked)
+    {
+        cooked = Data();
+        cooked.level_hash = hashLevel(level);
+
+        Navigation::buildGrid(level, cooked.grid);
+        cooked.walls = Navigation::mergeWalls(cooked.grid);
+
+        // Find the player's start and store the paths from it.
+        cooked.start_tile = findStart(level);
+
+        std::vector<int> came_from;
+        Navigation::breadthFirstSearch(cooked.grid, cooked.start_tile, came_from);
+        cooked.start_directions.assign(came_from.size(), UNREACHABLE);
+        for (std::size_t i = 0; i < came_from.size(); i++)
+        {
+            if (came_from[i] == Navigation::UNVISITED)
+            {
+                continue;
+            }
+            if (came_from[i] == static_cast<int>(i))
+            {
+                cooked.start_directions[i] = START;
+                continue;
+            }
+            SDL_Point from = {came_from[i] % level.width, came_from[i] / level.width};
+            SDL_Point to = {static_cast<int>(i) % level.width, static_cast<int>(i) / level.width};
+            cooked.start_directions[i] = Navigation::getDirection(from, to);
+        }
+
+    }
+
+    /**
+    * This function turns the stored paths from the player's start back into a came_from
+    * map, exactly as Navigation::breadthFirstSearch would have made it.
+    */
+    void getStartPaths(const Data& cooked, std::vector<int>& came_from)
+    {
+        const int width = cooked.grid.width;
+        came_from.assign(cooked.start_directions.size(), Navigation::UNVISITED);
+        for (std::size_t i = 0; i < cooked.start_directions.size(); i++)
+        {
+            const std::uint8_t direction = cooked.start_directions[i];
+            if (direction == START)
+            {
+                came_from[i] = i;
+            }
+            else if (direction != UNREACHABLE)
+            {
+                SDL_Point offset = Navigation::getDirectionOffset(direction);
+                came_from[i] = i - ((offset.y * width) + offset.x);
+            }
+        }
+    }
+
+    /**
+    * This function checks that a level and the data cooked from it can be played. It
+    * returns a list of problems, which is empty if the level is fine.
+    */
+    std::vector<std::string> validate(const LevelFile::Data& level, const Data& cooked)
+    {
+        std::vector<std::string> problems;
+
+        int start_count = std::count_if(level.objects.begin(), level.objects.end(),
+                                        [](const LevelFile::Object& object){return object.type == 'A';});
+        if (start_count == 0)
+        {
+            problems.push_back("The level has no player start (A)");
+            return problems;
+        }
+        if (start_count > 1)
+        {
+            problems.push_back("The level has " + std::to_string(start_count) + " player starts, only the first is used");
+        }
+        if (!cooked.grid.isWalkable(cooked.start_tile.x, cooked.start_tile.y))
+        {
+            problems.push_back("The player starts inside a wall at (" + std::to_string(cooked.start_tile.x) + ", " +
+                               std::to_string(cooked.start_tile.y) + ")");
+            return problems;
+        }
+
+        for (const auto& object : level.objects)
+        {
+            const std::uint8_t direction = cooked.start_directions[(object.y * level.width) + object.x];
+            if (object.type != 'A' && direction == UNREACHABLE)
+            {
+                problems.push_back(getObjectName(object.type) + " at (" + std::to_string(object.x) + ", " + std::to_string(object.y) +
+                                   ") can't be reached from the player's start");
+            }
+        }
+
+        return problems;
+    }
+
+    /**
+    * This function writes cooked data to a file.
+    */
+    void write(const std::string& file_name, const Data& cooked)
+    {
+        std::ofstream file(file_name, std::ios::binary);
+        if (!file)
+        {
+            SDL_SetError("Unable to write cooked level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        file.write(MAGIC, sizeof(MAGIC));
+        writeValue(file, VERSION);
+        writeValue(file, cooked.level_hash);
+        writeValue(file, cooked.grid.width);
+        writeValue(file, cooked.grid.height);
+        writeVector(file, packBits(cooked.grid.walkable));
+        writeVector(file, cooked.walls);
+        writeValue(file, cooked.start_tile);
+        writeVector(file, cooked.start_directions);
+
+        if (!file)
+        {
+            SDL_SetError("Unable to write cooked level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+    }
+
+    /**
+    * This function reads cooked data for a level. It returns false if there is no sidecar,
+    * if it was cooked from a different version of the level or if it is corrupt, so that
+    * the data is worked out from the level instead.
+    */
+    bool read(const std::string& file_name, const LevelFile::Data& level, Data& cooked)
+    {
+        std::ifstream file(file_name, std::ios::binary);
+        if (!file)
+        {
+            return false;
+        }
+
+        char magic[4];
+        std::uint32_t version;
+        if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            !readValue(file, version) || version != VERSION)
+        {
+            LOG_WARNING(Level, "Ignoring cooked level with an unknown format: " << file_name);
+            return false;
+        }
+
+        cooked = Data();
+        if (!readValue(file, cooked.level_hash) || cooked.level_hash != hashLevel(level))
+        {
+            LOG_WARNING(Level, "Ignoring out of date cooked level: " << file_name);
+            return false;
+        }
+
+        // No list can have more entries than there are tiles, so a corrupt size can't allocate
+        // a huge amount.
+        const std::uint64_t tile_count = static_cast<std::uint64_t>(level.width) * level.height;
+        const std::uint64_t packed_size = (tile_count + 7) / 8;
+
+        std::vector<std::uint8_t> walkable_bits;
+        if (!readValue(file, cooked.grid.width) || !readValue(file, cooked.grid.height) ||
+            cooked.grid.width != level.width || cooked.grid.height != level.height ||
+            !readVector(file, walkable_bits, packed_size) ||
+            !readVector(file, cooked.walls, tile_count) ||
+            !readValue(file, cooked.start_tile) ||
+            !readVector(file, cooked.start_directions, tile_count) ||
+            walkable_bits.size() != packed_size ||
+            cooked.start_directions.size() != tile_count)
+        {
+            LOG_WARNING(Level, "Ignoring corrupt cooked level: " << file_name);
+            return false;
+        }
+        unpackBits(walkable_bits, tile_count, cooked.grid.walkable);
+
+        // The paths are turned straight into offsets into the grid, so they have to be
+        // checked before they are used.
+        const SDL_Point start_tile = findStart(level);
+        if (cooked.start_tile.x != start_tile.x || cooked.start_tile.y != start_tile.y ||
+            !hasValidStartPaths(cooked))
+        {
+            LOG_WARNING(Level, "Ignoring corrupt cooked level: " << file_name);
+            return false;
+        }
+
+        LOG_DEBUG(Level, "Using cooked level: " << file_name);
+        return true;
+    }
+}
@@ -0,0 +1,544 @@
+#include "LevelFile.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif // _WIN32
+
+/**
+* This namespace reads and writes level files. A level can either be stored in the
+* hand-written XML format (".lvl") or in the compiled binary format (".lvlb"). Binary
+* levels are memory mapped and their tile layers are used in place, so they do not
+* need to be parsed at all.
+*/
+namespace LevelFile
+{
+    /**
+    * This anonymous namespace holds helpers that are only used when loading levels.
+    */
+    namespace
+    {
+        /**
+        * This function returns the text of an element without copying it. Elements
+        * with no text give an empty view.
+        */
+        std::string_view getElementText(tinyxml2::XMLNode* node)
+        {
+            const char* text = node->ToElement()->GetText();
+            return text == nullptr ? std::string_view() : std::string_view(text);
+        }
+
+        /**
+        * This function removes the indentation and line endings from both sides of a row.
+        */
+        std::string_view trimRow(std::string_view row)
+        {
+            const std::size_t first = row.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos)
+            {
+                return std::string_view();
+            }
+            return row.substr(first, row.find_last_not_of(" \t\r") - first + 1);
+        }
+
+        /**
+        * This function reports a malformed level with the file and line it happened on.
+        */
+        [[noreturn]] void throwParseError(const std::string& file_name, const int line, const std::string& message)
+        {
+            SDL_SetError("%s:%d: %s", file_name.c_str(), line, message.c_str());
+            throw Application::Error::Level;
+        }
+
+        /**
+        * This function scans the rows of a layer or the objects in a single pass. Blank
+        * lines are skipped and every other row is handed to on_row without being copied.
+        * Every row must be exactly width tiles long and there must be exactly height rows.
+        * first_line is the line the element starts on, so errors point at the right line.
+        */
+        template <typename RowFunction>
+        void scanRows(std::string_view text, int first_line, const int width, const int height,
+                      const std::string& file_name, const char* section, RowFunction on_row)
+        {
+            int line = first_line;
+            int y = 0;
+            while (!text.empty())
+            {
+                const std::size_t row_end = text.find('\n');
+                const std::string_view row = trimRow(text.substr(0, row_end));
+                text.remove_prefix(row_end == std::string_view::npos ? text.size() : row_end + 1);
+
+                if (!row.empty())
+                {
+                    if (y >= height)
+                    {
+                        throwParseError(file_name, line, std::string(section) + " has more than " + std::to_string(height) + " rows");
+                    }
+                    if (static_cast<int>(row.size()) != width)
+                    {
+                        throwParseError(file_name, line, std::string(section) + " row " + std::to_string(y + 1) + " has " +
+                                        std::to_string(row.size()) + " columns, expected " + std::to_string(width));
+                    }
+                    on_row(y++, row);
+                }
+
+                line++;
+            }
+
+            if (y != height)
+            {
+                throwParseError(file_name, line, std::string(section) + " has " + std::to_string(y) + " rows, expected " + std::to_string(height));
+            }
+        }
+    }
+
+    /**
+    * The constructor maps the file. An error is thrown if the file can't be opened.
+    */
+    MappedFile::MappedFile(const std::string& file_name)
+    {
+#ifdef _WIN32
+        file_handle = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_handle == INVALID_HANDLE_VALUE)
+        {
+            file_handle = nullptr;
+            SDL_SetError("Unable to open level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        LARGE_INTEGER file_size;
+        GetFileSizeEx(file_handle, &file_size);
+        size = static_cast<std::size_t>(file_size.QuadPart);
+
+        mapping_handle = CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_handle != nullptr)
+        {
+            data = static_cast<const char*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (data == nullptr)
+        {
+            if (mapping_handle != nullptr)
+            {
+                CloseHandle(mapping_handle);
+            }
+            CloseHandle(file_handle);
+            SDL_SetError("Unable to map level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+#else
+        int file_descriptor = open(file_name.c_str(), O_RDONLY);
+        if (file_descriptor == -1)
+        {
+            SDL_SetError("Unable to open level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        struct stat file_info;
+        if (fstat(file_descriptor, &file_info) == -1 || file_info.st_size == 0)
+        {
+            close(file_descriptor);
+            SDL_SetError("Unable to read level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+        size = static_cast<std::size_t>(file_info.st_size);
+
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+
+        // The mapping stays valid after the file is closed.
+        close(file_descriptor);
+
+        if (mapping == MAP_FAILED)
+        {
+            SDL_SetError("Unable to map level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+        data = static_cast<const char*>(mapping);
+#endif // _WIN32
+    }
+
+    /**
+    * The destructor unmaps the file.
+    */
+    MappedFile::~MappedFile()
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+#else
+        munmap(const_cast<char*>(data), size);
+#endif // _WIN32
+    }
+
+    /**
+    * This method returns the start of the mapped file.
+    */
+    const char* MappedFile::getData() const
+    {
+        return data;
+    }
+
+    /**
+    * This method returns the size of the mapped file in bytes.
+    */
+    std::size_t MappedFile::getSize() const
+    {
+        return size;
+    }
+
+    /**
+    * This method returns the start of a tile layer. The layer is stored row by row.
+    */
+    const char* Data::getLayer(const int layer) const
+    {
+        const std::size_t offset = static_cast<std::size_t>(layer) * width * height;
+        if (mapping)
+        {
+            return mapping->getData() + mapping_offset + offset;
+        }
+        return tile_buffer.data() + offset;
+    }
+
+    /**
+    * This method returns a single tile from a layer.
+    */
+    char Data::getTile(const int layer, const int x, const int y) const
+    {
+        return getLayer(layer)[(y * width) + x];
+    }
+
+    /**
+    * This function returns whether or not a file name is a binary level.
+    */
+    bool isBinary(const std::string& file_name)
+    {
+        const std::size_t extension_length = std::strlen(BINARY_EXTENSION);
+        return file_name.size() >= extension_length &&
+               file_name.compare(file_name.size() - extension_length, extension_length, BINARY_EXTENSION) == 0;
+    }
+
+    /**
+    * This function loads a level, picking the format from the file's extension.
+    */
+    void load(const std::string& file_name, Data& data)
+    {
+        if (isBinary(file_name))
+        {
+            loadBinary(file_name, data);
+        }
+        else
+        {
+            loadText(file_name, data);
+        }
+    }
+
+    /**
+    * This function parses a hand-written ".lvl" file. The text of each layer is scanned
+    * once and written straight into the tile planes.
+    */
+    void loadText(const std::string& file_name, Data& data)
+    {
+        data = Data();
+
+        tinyxml2::XMLDocument doc;
+        if (doc.LoadFile(file_name.c_str()) != tinyxml2::XML_SUCCESS)
+        {
+            SDL_SetError(doc.ErrorName());
+            throw Application::Error::XML;
+        }
+
+        for (tinyxml2::XMLNode* node = doc.FirstChild(); node; node = node->NextSibling())
+        {
+            std::string_view node_name = node->ToElement()->Name();
+            if (node_name == "about")
+            {
+                for (tinyxml2::XMLNode* about_node = node->FirstChild(); about_node; about_node = about_node->NextSibling())
+                {
+                    std::string_view name = about_node->ToElement()->Name();
+                    std::string_view text = getElementText(about_node);
+                    if (name == "title")
+                    {
+                        data.title = text;
+                        LOG_TRACE(Level, "Level title: " << data.title);
+                    }
+                    else if (name == "width")
+                    {
+                        data.width = atoi(std::string(text).c_str());
+                        LOG_TRACE(Level, "Level width: " << data.width);
+                    }
+                    else if (name == "height")
+                    {
+                        data.height = atoi(std::string(text).c_str());
+                        LOG_TRACE(Level, "Level height: " << data.height);
+                    }
+                }
+            }
+
+            else if (node_name == "level")
+            {
+                if (data.width <= 0 || data.height <= 0)
+                {
+                    throwParseError(file_name, node->GetLineNum(), "the level needs a width and height before its layers");
+                }
+                const std::size_t plane_size = static_cast<std::size_t>(data.width) * data.height;
+
+                for (tinyxml2::XMLNode* level_node = node->FirstChild(); level_node; level_node = level_node->NextSibling())
+                {
+                    std::string_view level_node_name = level_node->ToElement()->Name();
+                    if (level_node_name == "layers")
+                    {
+                        for (tinyxml2::XMLNode* layer_node = level_node->FirstChild(); layer_node; layer_node = layer_node->NextSibling())
+                        {
+                            std::string_view layer_node_name = layer_node->ToElement()->Name();
+                            if (layer_node_name == "layer")
+                            {
+                                // Grow the buffer by one plane and copy each row straight into it.
+                                data.tile_buffer.resize(plane_size * (data.layer_count + 1));
+                                char* plane = data.tile_buffer.data() + (plane_size * data.layer_count);
+                                data.layer_count++;
+
+                                scanRows(getElementText(layer_node), layer_node->GetLineNum(), data.width, data.height, file_name, "Layer",
+                                         [&](const int y, std::string_view row)
+                                         {
+                                             std::copy(row.begin(), row.end(), plane + (y * data.width));
+                                         });
+                                LOG_TRACE(Level, "Layer " << data.layer_count << ":" << std::endl << getElementText(layer_node));
+                            }
+                        }
+                    }
+
+                    if (level_node_name == "objects")
+                    {
+                        // Only keep the tiles that actually have something on them.
+                        scanRows(getElementText(level_node), level_node->GetLineNum(), data.width, data.height, file_name, "Objects",
+                                 [&](const int y, std::string_view row)
+                                 {
+                                     for (int x = 0; x < data.width; x++)
+                                     {
+                                         if (row[x] != '0')
+                                         {
+                                             data.objects.push_back({x, y, row[x]});
+                                         }
+                                     }
+                                 });
+                    }
+                }
+            }
+        }
+
+        LOG_INFO(Level, "Parsed level: " << data.title << " (" << data.width << "x" << data.height << ", "
+              << data.layer_count << " layers, " << data.objects.size() << " objects)");
+    }
+
+    /**
+    * This function maps a ".lvlb" file into memory. Nothing is copied except for the
+    * title and the object table, the tile layers are read straight from the mapping.
+    */
+    void loadBinary(const std::string& file_name, Data& data)
+    {
+        data = Data();
+        data.mapping = std::make_shared<MappedFile>(file_name);
+
+        const char* file = data.mapping->getData();
+        const std::uint64_t file_size = data.mapping->getSize();
+
+        BinaryHeader header;
+        if (file_size < sizeof(header))
+        {
+            SDL_SetError("Level is too small to be a binary level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+        std::memcpy(&header, file, sizeof(header));
+
+        if (std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) != 0 || header.version != BINARY_VERSION)
+        {
+            SDL_SetError("Level is not a version %u binary level: %s", BINARY_VERSION, file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        // Make sure every section actually fits in the file before using any of it.
+        const std::uint64_t layers_size = static_cast<std::uint64_t>(header.width) * header.height * header.layer_count;
+        const std::uint64_t objects_size = static_cast<std::uint64_t>(header.object_count) * sizeof(BinaryObject);
+        if (static_cast<std::uint64_t>(header.title_offset) + header.title_length > file_size ||
+            header.layers_offset + layers_size > file_size ||
+            header.objects_offset + objects_size > file_size)
+        {
+            SDL_SetError("Binary level is truncated: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        data.title.assign(file + header.title_offset, header.title_length);
+        data.width = header.width;
+        data.height = header.height;
+        data.layer_count = header.layer_count;
+        data.mapping_offset = header.layers_offset;
+
+        data.objects.reserve(header.object_count);
+        for (std::uint32_t i = 0; i < header.object_count; i++)
+        {
+            BinaryObject object;
+            std::memcpy(&object, file + header.objects_offset + (i * sizeof(BinaryObject)), sizeof(object));
+            if (object.x >= header.width || object.y >= header.height)
+            {
+                SDL_SetError("Object %u is outside of the level: %s", i, file_name.c_str());
+                throw Application::Error::Level;
+            }
+            data.objects.push_back({static_cast<int>(object.x), static_cast<int>(object.y), object.type});
+        }
+
+        LOG_INFO(Level, "Mapped binary level: " << data.title << " (" << data.width << "x" << data.height << ", "
+              << data.layer_count << " layers, " << data.objects.size() << " objects)");
+    }
+
+    /**
+    * This function writes level data out as a hand-written style ".lvl" file, in the
+    * same layout that loadText reads. Each row is written in one go so that very large
+    * generated levels don't take long to write.
+    */
+    void writeText(const std::string& file_name, const Data& data)
+    {
+        std::ofstream file(file_name, std::ios::binary);
+        if (!file)
+        {
+            SDL_SetError("Unable to write level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        file << "<about>\n"
+             << "    <title>" << data.title << "</title>\n"
+             << "    <width>" << data.width << "</width>\n"
+             << "    <height>" << data.height << "</height>\n"
+             << "</about>\n"
+             << "<level>\n"
+             << "    <layers>\n";
+
+        for (int layer = 0; layer < data.layer_count; layer++)
+        {
+            file << "        <layer>\n";
+            const char* tiles = data.getLayer(layer);
+            for (int y = 0; y < data.height; y++)
+            {
+                file << "            ";
+                file.write(tiles + (static_cast<std::size_t>(y) * data.width), data.width);
+                file << "\n";
+            }
+            file << "        </layer>\n";
+        }
+        file << "    </layers>\n";
+
+        // The objects are written as a grid of their own, with '0' where there isn't one.
+        std::vector<char> objects(static_cast<std::size_t>(data.width) * data.height, '0');
+        for (const auto& object : data.objects)
+        {
+            objects[(static_cast<std::size_t>(object.y) * data.width) + object.x] = object.type;
+        }
+
+        file << "    <objects>\n";
+        for (int y = 0; y < data.height; y++)
+        {
+            file << "        ";
+            file.write(objects.data() + (static_cast<std::size_t>(y) * data.width), data.width);
+            file << "\n";
+        }
+        file << "    </objects>\n"
+             << "</level>\n";
+
+        if (!file)
+        {
+            SDL_SetError("Unable to write level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+    }
+
+    /**
+    * This function writes level data out as a ".lvlb" file.
+    */
+    void writeBinary(const std::string& file_name, const Data& data)
+    {
+        const std::size_t plane_size = static_cast<std::size_t>(data.width) * data.height;
+
+        BinaryHeader header = {};
+        std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+        header.version = BINARY_VERSION;
+        header.width = data.width;
+        header.height = data.height;
+        header.layer_count = data.layer_count;
+        header.object_count = data.objects.size();
+        header.title_offset = sizeof(header);
+        header.title_length = data.title.size();
+        header.layers_offset = header.title_offset + header.title_length;
+        header.objects_offset = header.layers_offset + (plane_size * data.layer_count);
+
+        std::ofstream file(file_name, std::ios::binary);
+        if (!file)
+        {
+            SDL_SetError("Unable to write level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(data.title.data(), data.title.size());
+        for (int layer = 0; layer < data.layer_count; layer++)
+        {
+            file.write(data.getLayer(layer), plane_size);
+        }
+        for (const auto& object : data.objects)
+        {
+            BinaryObject binary_object = {};
+            binary_object.x = object.x;
+            binary_object.y = object.y;
+            binary_object.type = object.type;
+            file.write(reinterpret_cast<const char*>(&binary_object), sizeof(binary_object));
+        }
+
+        if (!file)
+        {
+            SDL_SetError("Unable to write level: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+    }
+
+    /**
+    * This function loads a level sequence. This is an XML file that lists the file of
+    * every level in the order they are played in.
+    */
+    std::vector<std::string> loadSequence(const std::string& file_name)
+    {
+        tinyxml2::XMLDocument doc;
+        if (doc.LoadFile(file_name.c_str()) != tinyxml2::XML_SUCCESS)
+        {
+            SDL_SetError(doc.ErrorName());
+            throw Application::Error::XML;
+        }
+
+        std::vector<std::string> sequence;
+        for (tinyxml2::XMLNode* node = doc.FirstChild(); node; node = node->NextSibling())
+        {
+            for (tinyxml2::XMLNode* level_node = node->FirstChild(); level_node; level_node = level_node->NextSibling())
+            {
+                std::string_view text = getElementText(level_node);
+                if (std::string_view(level_node->ToElement()->Name()) == "level" && !text.empty())
+                {
+                    sequence.emplace_back(text);
+                }
+            }
+        }
+
+        if (sequence.empty())
+        {
+            SDL_SetError("No levels in level sequence: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        return sequence;
+    }
+}
@@ -0,0 +1,328 @@
+#include "LevelGenerator.h"
+#include "Navigation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+/**
+* This namespace generates levels for stress testing. Levels are made of rooms joined by
+* corridors, or a single open room, with walls scattered through the rooms and a chosen
+* number of each enemy. Everything is worked out from a seed, so the same settings always
+* make exactly the same level.
+*/
+namespace LevelGenerator
+{
+    /**
+    * This anonymous namespace holds the helpers used to lay out a level. The random numbers
+    * are worked out by hand from std::mt19937, because the standard distributions give
+    * different numbers with different standard libraries.
+    */
+    namespace
+    {
+        const char FLOOR = '1';
+        const char WALL = '2';
+        const char PICKUP_TYPES[] = "FGHIJKLMNOP";
+
+        // Enemies are never placed this many tiles or fewer from the player's start.
+        const int SAFE_DISTANCE = 6;
+
+        /**
+        * This function returns a random number from min to max, including both.
+        */
+        int getRandomInt(std::mt19937& random, const int min, const int max)
+        {
+            return min + static_cast<int>(random() % static_cast<std::uint32_t>(max - min + 1));
+        }
+
+        /**
+        * This function returns true with the given chance, from 0 to 1.
+        */
+        bool getChance(std::mt19937& random, const float chance)
+        {
+            return (random() >> 8) < chance * 16777216.0f;
+        }
+
+        /**
+        * This function shuffles a vector with a Fisher-Yates shuffle.
+        */
+        template <typename T>
+        void shuffle(std::vector<T>& items, std::mt19937& random)
+        {
+            for (std::size_t i = items.size(); i > 1; i--)
+            {
+                std::swap(items[i - 1], items[random() % i]);
+            }
+        }
+
+        /**
+        * This function reports settings that can't be used to generate a level.
+        */
+        [[noreturn]] void throwSettingsError(const std::string& message)
+        {
+            SDL_SetError("Unable to generate level: %s", message.c_str());
+            throw Application::Error::Level;
+        }
+
+        /**
+        * This function sets every tile in a rect to a tile, leaving the edges of the level alone.
+        */
+        void fillRect(LevelFile::Data& data, const SDL_Rect& rect, const char tile)
+        {
+            const int left = std::max(rect.x, 1);
+            const int top = std::max(rect.y, 1);
+            const int right = std::min(rect.x + rect.w, data.width - 1);
+            const int bottom = std::min(rect.y + rect.h, data.height - 1);
+            for (int y = top; y < bottom; y++)
+            {
+                std::fill(data.tile_buffer.begin() + (static_cast<std::size_t>(y) * data.width) + left,
+                          data.tile_buffer.begin() + (static_cast<std::size_t>(y) * data.width) + right, tile);
+            }
+        }
+
+        /**
+        * This function returns whether or not every tile in a rect is a wall. Rects that
+        * touch the edges of the level are never clear.
+        */
+        bool isSolid(const LevelFile::Data& data, const SDL_Rect& rect)
+        {
+            if (rect.x < 1 || rect.y < 1 || rect.x + rect.w > data.width - 1 || rect.y + rect.h > data.height - 1)
+            {
+                return false;
+            }
+            for (int y = rect.y; y < rect.y + rect.h; y++)
+            {
+                for (int x = rect.x; x < rect.x + rect.w; x++)
+                {
+                    if (data.tile_buffer[(static_cast<std::size_t>(y) * data.width) + x] != WALL)
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /**
+        * This function places rooms that don't touch each other, trying a few times for
+        * each room. It returns fewer rooms than asked for if the level fills up.
+        */
+        std::vector<SDL_Rect> placeRooms(const Settings& settings, LevelFile::Data& data, std::mt19937& random)
+        {
+            const int max_room_size = std::min({settings.max_room_size, data.width - 4, data.height - 4});
+            const int min_room_size = std::min(settings.min_room_size, max_room_size);
+
+            std::vector<SDL_Rect> rooms;
+            for (int attempt = 0; attempt < settings.room_count * 32 && static_cast<int>(rooms.size()) < settings.room_count; attempt++)
+            {
+                SDL_Rect room;
+                room.w = getRandomInt(random, min_room_size, max_room_size);
+                room.h = getRandomInt(random, min_room_size, max_room_size);
+                room.x = getRandomInt(random, 2, data.width - room.w - 2);
+                room.y = getRandomInt(random, 2, data.height - room.h - 2);
+
+                // Leave at least one wall between rooms.
+                if (isSolid(data, {room.x - 1, room.y - 1, room.w + 2, room.h + 2}))
+                {
+                    fillRect(data, room, FLOOR);
+                    rooms.push_back(room);
+                }
+            }
+
+            // Sort the rooms into rows that snake back and forth, so that joining each room to
+            // the one before it makes short corridors.
+            const int row_height = max_room_size * 2;
+            std::sort(rooms.begin(), rooms.end(), [row_height](const SDL_Rect& a, const SDL_Rect& b)
+            {
+                const int a_row = a.y / row_height;
+                const int b_row = b.y / row_height;
+                if (a_row != b_row)
+                {
+                    return a_row < b_row;
+                }
+                return a_row % 2 == 0 ? a.x < b.x : a.x > b.x;
+            });
+            return rooms;
+        }
+
+        /**
+        * This function carves an L shaped corridor between the middles of two rooms.
+        */
+        void carveCorridor(const Settings& settings, LevelFile::Data& data, const SDL_Rect& from, const SDL_Rect& to, std::mt19937& random)
+        {
+            const SDL_Point start = {from.x + (from.w / 2), from.y + (from.h / 2)};
+            const SDL_Point end = {to.x + (to.w / 2), to.y + (to.h / 2)};
+            const int width = settings.corridor_width;
+
+            // Go across then down, or down then across.
+            const SDL_Point corner = getChance(random, 0.5) ? SDL_Point{end.x, start.y} : SDL_Point{start.x, end.y};
+            fillRect(data, {std::min(start.x, corner.x), std::min(start.y, corner.y),
+                            std::abs(start.x - corner.x) + width, std::abs(start.y - corner.y) + width}, FLOOR);
+            fillRect(data, {std::min(corner.x, end.x), std::min(corner.y, end.y),
+                            std::abs(corner.x - end.x) + width, std::abs(corner.y - end.y) + width}, FLOOR);
+        }
+    }
+
+    /**
+    * This function generates a level. Every floor tile that can't be reached from the
+    * player's start is filled in, so that the level passes the level cooker's checks. An
+    * error is thrown if the settings are out of range or there isn't room for every object.
+    */
+    void generate(const Settings& settings, LevelFile::Data& data)
+    {
+        if (settings.width < MIN_SIZE || settings.height < MIN_SIZE || settings.width > MAX_SIZE || settings.height > MAX_SIZE)
+        {
+            throwSettingsError("the size must be from " + std::to_string(MIN_SIZE) + " to " + std::to_string(MAX_SIZE) + " tiles");
+        }
+        if (settings.wall_density < 0.0 || settings.wall_density > 1.0 || settings.pickup_density < 0.0 || settings.pickup_density > 1.0)
+        {
+            throwSettingsError("densities must be from 0 to 1");
+        }
+        if (settings.room_count < 0 || settings.min_room_size < 1 || settings.max_room_size < settings.min_room_size ||
+            settings.corridor_width < 1)
+        {
+            throwSettingsError("the room and corridor sizes are invalid");
+        }
+        if (settings.zombies < 0 || settings.demons < 0 || settings.hounds < 0 || settings.bosses < 0)
+        {
+            throwSettingsError("enemy counts can't be negative");
+        }
+
+        std::mt19937 random(settings.seed);
+
+        data = LevelFile::Data();
+        data.title = settings.title;
+        data.width = settings.width;
+        data.height = settings.height;
+        data.layer_count = 1;
+        data.tile_buffer.assign(static_cast<std::size_t>(data.width) * data.height, WALL);
+
+        // Lay out the rooms. Without any rooms the whole level is one open room.
+        std::vector<SDL_Rect> rooms;
+        if (settings.room_count == 0)
+        {
+            rooms.push_back({1, 1, data.width - 2, data.height - 2});
+            fillRect(data, rooms.back(), FLOOR);
+        }
+        else
+        {
+            rooms = placeRooms(settings, data, random);
+            if (rooms.empty())
+            {
+                throwSettingsError("no rooms fit in the level");
+            }
+        }
+
+        const SDL_Point start = {rooms.front().x + (rooms.front().w / 2), rooms.front().y + (rooms.front().h / 2)};
+
+        // Scatter walls through the rooms, keeping the tiles around the start clear. This is
+        // done before the corridors are carved so that corridors are never blocked.
+        for (const auto& room : rooms)
+        {
+            for (int y = room.y; y < room.y + room.h; y++)
+            {
+                for (int x = room.x; x < room.x + room.w; x++)
+                {
+                    if ((std::abs(x - start.x) > 1 || std::abs(y - start.y) > 1) && getChance(random, settings.wall_density))
+                    {
+                        data.tile_buffer[(static_cast<std::size_t>(y) * data.width) + x] = WALL;
+                    }
+                }
+            }
+        }
+
+        for (std::size_t i = 1; i < rooms.size(); i++)
+        {
+            carveCorridor(settings, data, rooms[i - 1], rooms[i], random);
+        }
+
+        // Fill in everything that can't be reached, and gather what can be.
+        Navigation::Grid grid;
+        Navigation::buildGrid(data, grid);
+        std::vector<int> came_from;
+        Navigation::breadthFirstSearch(grid, start, came_from);
+
+        const int start_index = (start.y * data.width) + start.x;
+        std::vector<int> open_tiles;
+        for (std::size_t i = 0; i < came_from.size(); i++)
+        {
+            if (came_from[i] == Navigation::UNVISITED)
+            {
+                data.tile_buffer[i] = WALL;
+            }
+            else if (static_cast<int>(i) != start_index)
+            {
+                open_tiles.push_back(i);
+            }
+        }
+
+        // Hand out the objects to random open tiles. The enemy types are shuffled too, so
+        // that each kind is spread over the whole level.
+        std::vector<char> enemy_types;
+        enemy_types.insert(enemy_types.end(), settings.zombies, 'B');
+        enemy_types.insert(enemy_types.end(), settings.demons, 'C');
+        enemy_types.insert(enemy_types.end(), settings.hounds, 'D');
+        enemy_types.insert(enemy_types.end(), settings.bosses, 'E');
+        shuffle(enemy_types, random);
+        shuffle(open_tiles, random);
+
+        std::size_t pickups_left = std::lround(settings.pickup_density * open_tiles.size());
+        const std::size_t pickup_count = pickups_left;
+        std::size_t next_enemy = 0;
+
+        data.objects.push_back({start.x, start.y, 'A'});
+        for (const int tile : open_tiles)
+        {
+            if (next_enemy == enemy_types.size() && pickups_left == 0)
+            {
+                break;
+            }
+
+            const int x = tile % data.width;
+            const int y = tile / data.width;
+            if (next_enemy < enemy_types.size() && (std::abs(x - start.x) > SAFE_DISTANCE || std::abs(y - start.y) > SAFE_DISTANCE))
+            {
+                data.objects.push_back({x, y, enemy_types[next_enemy++]});
+            }
+            else if (pickups_left > 0)
+            {
+                data.objects.push_back({x, y, PICKUP_TYPES[random() % (sizeof(PICKUP_TYPES) - 1)]});
+                pickups_left--;
+            }
+        }
+
+        if (next_enemy < enemy_types.size() || pickups_left > 0)
+        {
+            throwSettingsError("there isn't room for " + std::to_string(enemy_types.size()) + " enemies and " +
+                               std::to_string(pickup_count) + " pickups in " + std::to_string(open_tiles.size()) + " open tiles");
+        }
+
+        // Put the objects in the order loadText would find them.
+        std::sort(data.objects.begin(), data.objects.end(), [](const LevelFile::Object& a, const LevelFile::Object& b)
+        {
+            return a.y != b.y ? a.y < b.y : a.x < b.x;
+        });
+
+        LOG_INFO(Level, "Generated level: " << data.title << " (" << data.width << "x" << data.height << ", seed " << settings.seed
+              << ", " << rooms.size() << " rooms, " << open_tiles.size() + 1 << " open tiles, " << data.objects.size() << " objects)");
+    }
+
+    /**
+    * This function generates a level and writes it out, as a ".lvl" file or as a binary
+    * level if the file name ends in ".lvlb".
+    */
+    void write(const std::string& file_name, const Settings& settings)
+    {
+        LevelFile::Data data;
+        generate(settings, data);
+
+        if (LevelFile::isBinary(file_name))
+        {
+            LevelFile::writeBinary(file_name, data);
+        }
+        else
+        {
+            LevelFile::writeText(file_name, data);
+        }
+    }
+}
@@ -0,0 +1,82 @@
+#include "LevelLoader.h"
+
+/**
+* This method starts preparing a level on another thread. If a different level is
+* already being prepared, it is finished and thrown away first.
+*/
+void LevelLoader::prefetch(const std::string& file_name)
+{
+    if (future.valid())
+    {
+        if (this->file_name == file_name)
+        {
+            return;
+        }
+        future.wait();
+    }
+
+    LOG_DEBUG(Level, "Prefetching level: " << file_name);
+
+    this->file_name = file_name;
+    error.clear();
+    future = std::async(std::launch::async, [this, file_name]()
+    {
+        try
+        {
+            return Level::prepare(file_name);
+        }
+        catch (const Application::Error&)
+        {
+            error = SDL_GetError();
+            throw;
+        }
+    });
+}
+
+/**
+* This method returns whether or not a level has finished being prefetched.
+*/
+bool LevelLoader::isReady(const std::string& file_name)
+{
+    return future.valid() && this->file_name == file_name &&
+           future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+/**
+* This method returns a prepared level. If the level was prefetched it waits for it
+* to finish, otherwise it is prepared right away on this thread. Errors from the other
+* thread are thrown here.
+*/
+std::shared_ptr<const LevelLayout> LevelLoader::get(const std::string& file_name)
+{
+    if (!future.valid() || this->file_name != file_name)
+    {
+        if (future.valid())
+        {
+            future.wait();
+            future = std::future<std::shared_ptr<const LevelLayout>>();
+        }
+        return Level::prepare(file_name);
+    }
+
+    try
+    {
+        return future.get();
+    }
+    catch (const Application::Error&)
+    {
+        SDL_SetError("%s", error.c_str());
+        throw;
+    }
+}
+
+/**
+* This destructor waits for any level that is still being prepared.
+*/
+LevelLoader::~LevelLoader()
+{
+    if (future.valid())
+    {
+        future.wait();
+    }
+}
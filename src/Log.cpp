@@ -0,0 +1,369 @@
+#include "Log.h"
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <streambuf>
+#include <thread>
+
+/**
+* This namespace is the game's logger. Messages are formatted straight into a fixed size,
+* lock-free ring buffer on the thread that logs them, and a writer thread writes them to
+* the console, so logging never waits on the console. Any thread can log. If the ring is
+* full the message is dropped instead of waiting for room, and messages are cut short if
+* they are longer than MAX_MESSAGE_LENGTH. Use the LOG_* macros instead of Message.
+*/
+namespace Log
+{
+    /**
+    * This anonymous namespace holds the ring of messages, the writer thread and which
+    * messages are logged.
+    */
+    namespace
+    {
+        const int CATEGORY_COUNT = static_cast<int>(Category::Count);
+        const std::uint64_t RING_SIZE = 4096;
+
+        const char* LEVEL_NAMES[] = {
+            "Trace",
+            "Debug",
+            "Info",
+            "Warning",
+            "Error"
+        };
+
+        const char* CATEGORY_NAMES[CATEGORY_COUNT] = {
+            "General",
+            "Resource",
+            "Level",
+            "Save",
+            "Diagnostics"
+        };
+
+        /**
+        * This struct is a slot in the ring. A slot can be written to when its sequence is the
+        * position being claimed, and read from when it is one past the position being read.
+        * The sequence is stored minus the slot's index, so that the ring starts out ready to
+        * be written to without having to be set up first.
+        */
+        struct Entry
+        {
+            std::atomic<std::uint64_t> sequence{0};
+            Level level;
+            Category category;
+            double time;
+            int length;
+            char text[MAX_MESSAGE_LENGTH];
+        };
+
+        /**
+        * This class is a stream buffer that writes into a fixed size block of memory. Anything
+        * that doesn't fit is thrown away.
+        */
+        class FixedStreamBuffer : public std::streambuf
+        {
+        public:
+            void reset(char* begin, char* end)
+            {
+                setp(begin, end);
+            }
+
+            int getLength() const
+            {
+                return pptr() - pbase();
+            }
+        };
+
+        /**
+        * This struct is the stream each thread formats its messages with. It is made once per
+        * thread, so formatting a message never allocates.
+        */
+        struct ThreadStream
+        {
+            FixedStreamBuffer buffer;
+            std::ostream stream{&buffer};
+            char dropped_text[MAX_MESSAGE_LENGTH];
+        };
+
+        Entry ring[RING_SIZE];
+        std::atomic<std::uint64_t> write_position{0};
+        std::uint64_t read_position = 0;
+        std::atomic<std::uint64_t> dropped_messages{0};
+
+        thread_local ThreadStream thread_stream;
+
+        std::atomic<int> minimum_level{static_cast<int>(Level::Debug)};
+        std::atomic<std::uint32_t> disabled_categories{0};
+
+        const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+        std::thread writer;
+        std::atomic<bool> writing{false};
+
+        /**
+        * This function returns the slot for a position in the ring.
+        */
+        Entry& getEntry(const std::uint64_t position)
+        {
+            return ring[position % RING_SIZE];
+        }
+
+        /**
+        * This function returns the sequence of a slot, adding back its index.
+        */
+        std::uint64_t getSequence(const std::uint64_t position, const std::memory_order order)
+        {
+            return getEntry(position).sequence.load(order) + (position % RING_SIZE);
+        }
+
+        /**
+        * This function sets the sequence of a slot, taking away its index.
+        */
+        void setSequence(const std::uint64_t position, const std::uint64_t sequence)
+        {
+            getEntry(position).sequence.store(sequence - (position % RING_SIZE), std::memory_order_release);
+        }
+
+        /**
+        * This function claims the next slot in the ring for writing. It returns false if
+        * the ring is full.
+        */
+        bool claim(std::uint64_t& position)
+        {
+            position = write_position.load(std::memory_order_relaxed);
+            while (true)
+            {
+                const std::int64_t difference = static_cast<std::int64_t>(getSequence(position, std::memory_order_acquire) - position);
+                if (difference == 0)
+                {
+                    // The slot is free, take it unless another thread got there first.
+                    if (write_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                {
+                    // The slot still holds a message from the last time around the ring.
+                    return false;
+                }
+                else
+                {
+                    position = write_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+        * This function writes every message that is ready. It must only be called from one
+        * thread at a time. It returns whether or not anything was written.
+        */
+        bool writeMessages()
+        {
+            bool wrote = false;
+            while (getSequence(read_position, std::memory_order_acquire) == read_position + 1)
+            {
+                const Entry& entry = getEntry(read_position);
+
+                char prefix[64];
+                std::snprintf(prefix, sizeof(prefix), "[%10.3f] %-7s %s: ", entry.time,
+                              LEVEL_NAMES[static_cast<int>(entry.level)], CATEGORY_NAMES[static_cast<int>(entry.category)]);
+                std::cout << prefix;
+                std::cout.write(entry.text, entry.length);
+                std::cout << "\n";
+
+                // Hand the slot back for the next time around the ring.
+                setSequence(read_position, read_position + RING_SIZE);
+                read_position++;
+                wrote = true;
+            }
+
+            if (wrote)
+            {
+                std::cout.flush();
+            }
+            return wrote;
+        }
+
+        /**
+        * This function runs on the writer thread. It writes messages as they are logged
+        * until it is stopped.
+        */
+        void writeLoop()
+        {
+            while (writing.load(std::memory_order_acquire))
+            {
+                if (!writeMessages())
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+        }
+    }
+
+    /**
+    * This function returns the name of a level.
+    */
+    const char* getName(const Level level)
+    {
+        return LEVEL_NAMES[static_cast<int>(level)];
+    }
+
+    /**
+    * This function returns the name of a category.
+    */
+    const char* getName(const Category category)
+    {
+        return CATEGORY_NAMES[static_cast<int>(category)];
+    }
+
+    /**
+    * This function finds a level from its name, ignoring case. It returns false if there
+    * isn't a level with that name.
+    */
+    bool getLevelFromName(const std::string_view name, Level& level)
+    {
+        for (int i = 0; i <= static_cast<int>(Level::Error); i++)
+        {
+            const std::string_view level_name = LEVEL_NAMES[i];
+            if (level_name.size() != name.size())
+            {
+                continue;
+            }
+
+            bool matches = true;
+            for (std::size_t j = 0; j < name.size(); j++)
+            {
+                if (std::tolower(static_cast<unsigned char>(name[j])) != std::tolower(static_cast<unsigned char>(level_name[j])))
+                {
+                    matches = false;
+                    break;
+                }
+            }
+            if (matches)
+            {
+                level = static_cast<Level>(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+    * This function sets the lowest level that is logged. Levels below LOG_LEVEL are
+    * compiled out, so they can't be turned back on here.
+    */
+    void setLevel(const Level level)
+    {
+        minimum_level.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    /**
+    * This function turns a category on or off.
+    */
+    void setCategoryEnabled(const Category category, const bool enabled)
+    {
+        const std::uint32_t bit = 1u << static_cast<int>(category);
+        if (enabled)
+        {
+            disabled_categories.fetch_and(~bit, std::memory_order_relaxed);
+        }
+        else
+        {
+            disabled_categories.fetch_or(bit, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+    * This function returns whether or not messages of a level and category are logged.
+    */
+    bool isEnabled(const Level level, const Category category)
+    {
+        return static_cast<int>(level) >= minimum_level.load(std::memory_order_relaxed) &&
+               (disabled_categories.load(std::memory_order_relaxed) & (1u << static_cast<int>(category))) == 0;
+    }
+
+    /**
+    * This function starts the writer thread. Messages logged before this are kept until
+    * it starts, as long as the ring doesn't fill up.
+    */
+    void startUp()
+    {
+        if (!writer.joinable())
+        {
+            writing = true;
+            writer = std::thread(writeLoop);
+        }
+    }
+
+    /**
+    * This function writes every message that is left and stops the writer thread.
+    */
+    void shutDown()
+    {
+        if (writer.joinable())
+        {
+            writing = false;
+            writer.join();
+        }
+
+        // The writer has stopped, so it is safe to write what is left from this thread.
+        writeMessages();
+
+        const std::uint64_t dropped = dropped_messages.exchange(0);
+        if (dropped > 0)
+        {
+            std::cout << "Log dropped " << dropped << " messages because the ring was full." << std::endl;
+        }
+    }
+
+    /**
+    * Claim a slot for the message and point this thread's stream at it. If the ring is
+    * full, the message is formatted somewhere else and thrown away.
+    */
+    Message::Message(const Level level, const Category category)
+    {
+        claimed = claim(position);
+        if (claimed)
+        {
+            Entry& entry = getEntry(position);
+            entry.level = level;
+            entry.category = category;
+            entry.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+            thread_stream.buffer.reset(entry.text, entry.text + MAX_MESSAGE_LENGTH);
+        }
+        else
+        {
+            thread_stream.buffer.reset(thread_stream.dropped_text, thread_stream.dropped_text + MAX_MESSAGE_LENGTH);
+        }
+
+        // A message that was too long leaves the stream in a failed state.
+        thread_stream.stream.clear();
+    }
+
+    /**
+    * Hand the message to the writer thread.
+    */
+    Message::~Message()
+    {
+        if (claimed)
+        {
+            getEntry(position).length = thread_stream.buffer.getLength();
+            setSequence(position, position + 1);
+        }
+        else
+        {
+            dropped_messages.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+    * This method returns the stream that formats into the message.
+    */
+    std::ostream& Message::getStream()
+    {
+        return thread_stream.stream;
+    }
+}
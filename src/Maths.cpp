@@ -0,0 +1,239 @@
+#include "Maths.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64)
+#define MATHS_SSE
+#include <xmmintrin.h>
+#endif
+
+/**
+* This namespace holds the vector maths used to move and aim everything in the game.
+* Directions are kept as unit vectors rather than angles, so moving towards something
+* never needs any trigonometry. An angle is only worked out when something is drawn,
+* because that is what SDL needs to rotate a texture.
+*/
+namespace Maths
+{
+    /**
+    * This anonymous namespace holds the rotation table and helpers for the batch functions.
+    */
+    namespace
+    {
+        const float PI = 3.14159265f;
+
+        /**
+        * This struct works out the rotation for every whole degree once, when the game starts.
+        */
+        struct RotationTable
+        {
+            Vec2 rotations[360];
+
+            RotationTable()
+            {
+                for (int i = 0; i < 360; i++)
+                {
+                    const double radians = i * (3.14159265358979323846 / 180.0);
+                    rotations[i] = {static_cast<float>(std::cos(radians)), static_cast<float>(std::sin(radians))};
+                }
+            }
+        };
+
+        const RotationTable rotation_table;
+
+        /**
+        * This function copies up to eight vectors into the lanes of a batch. Unused lanes
+        * are filled with zero, which every batch function leaves alone.
+        */
+        void load(Vec2x8& batch, const Vec2* vectors, const std::size_t count)
+        {
+            for (std::size_t i = 0; i < Vec2x8::SIZE; i++)
+            {
+                batch.x[i] = (i < count) ? vectors[i].x : 0.0f;
+                batch.y[i] = (i < count) ? vectors[i].y : 0.0f;
+            }
+        }
+
+        /**
+        * This function copies the first count lanes of a batch back out into vectors.
+        */
+        void store(const Vec2x8& batch, Vec2* vectors, const std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; i++)
+            {
+                vectors[i] = {batch.x[i], batch.y[i]};
+            }
+        }
+    }
+
+    /**
+    * This function returns a vector with a length of 1 pointing the same way. A vector
+    * with no length stays that way rather than becoming NaN.
+    */
+    Vec2 normalize(const Vec2& vector)
+    {
+        const float length = std::sqrt((vector.x * vector.x) + (vector.y * vector.y));
+        if (length > 0.0f)
+        {
+            return {vector.x / length, vector.y / length};
+        }
+        return {0.0f, 0.0f};
+    }
+
+    /**
+    * This function returns the unit vector pointing from one point to another, or a
+    * vector with no length if they are the same point.
+    */
+    Vec2 getDirection(const Vec2& from, const Vec2& to)
+    {
+        return normalize(to - from);
+    }
+
+    /**
+    * This function returns the unit vector for a whole number of degrees clockwise, which
+    * can be given to rotate. It comes from a table, so it doesn't need any trigonometry.
+    */
+    Vec2 getRotation(const int degrees)
+    {
+        return rotation_table.rotations[((degrees % 360) + 360) % 360];
+    }
+
+    /**
+    * This function rotates a vector by a rotation from getRotation.
+    */
+    Vec2 rotate(const Vec2& vector, const Vec2& rotation)
+    {
+        return {(vector.x * rotation.x) - (vector.y * rotation.y), (vector.x * rotation.y) + (vector.y * rotation.x)};
+    }
+
+    /**
+    * This function returns the angle of a direction in degrees clockwise, for drawing.
+    * Nothing but drawing should need this.
+    */
+    float getAngle(const Vec2& direction)
+    {
+        return std::atan2(direction.y, direction.x) * (180.0f / PI);
+    }
+
+    /**
+    * These functions are the same as the ones above, but work on eight vectors at once.
+    * The SIMD versions do exactly the same operations in the same order as the scalar
+    * ones, so they give the same results to the bit and replays stay in sync.
+    */
+    void normalize(Vec2x8& vectors)
+    {
+#ifdef MATHS_SSE
+        const __m128 zero = _mm_setzero_ps();
+        for (std::size_t i = 0; i < Vec2x8::SIZE; i += 4)
+        {
+            const __m128 x = _mm_load_ps(&vectors.x[i]);
+            const __m128 y = _mm_load_ps(&vectors.y[i]);
+            const __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+
+            // Lanes with no length would divide by zero, so they are masked back to zero.
+            const __m128 has_length = _mm_cmpgt_ps(length, zero);
+            _mm_store_ps(&vectors.x[i], _mm_and_ps(_mm_div_ps(x, length), has_length));
+            _mm_store_ps(&vectors.y[i], _mm_and_ps(_mm_div_ps(y, length), has_length));
+        }
+#else
+        for (std::size_t i = 0; i < Vec2x8::SIZE; i++)
+        {
+            const Vec2 normal = normalize(Vec2{vectors.x[i], vectors.y[i]});
+            vectors.x[i] = normal.x;
+            vectors.y[i] = normal.y;
+        }
+#endif
+    }
+
+    void getDirections(const Vec2x8& from, const Vec2x8& to, Vec2x8& directions)
+    {
+#ifdef MATHS_SSE
+        for (std::size_t i = 0; i < Vec2x8::SIZE; i += 4)
+        {
+            _mm_store_ps(&directions.x[i], _mm_sub_ps(_mm_load_ps(&to.x[i]), _mm_load_ps(&from.x[i])));
+            _mm_store_ps(&directions.y[i], _mm_sub_ps(_mm_load_ps(&to.y[i]), _mm_load_ps(&from.y[i])));
+        }
+#else
+        for (std::size_t i = 0; i < Vec2x8::SIZE; i++)
+        {
+            directions.x[i] = to.x[i] - from.x[i];
+            directions.y[i] = to.y[i] - from.y[i];
+        }
+#endif
+        normalize(directions);
+    }
+
+    void rotate(Vec2x8& vectors, const Vec2x8& rotations)
+    {
+#ifdef MATHS_SSE
+        for (std::size_t i = 0; i < Vec2x8::SIZE; i += 4)
+        {
+            const __m128 x = _mm_load_ps(&vectors.x[i]);
+            const __m128 y = _mm_load_ps(&vectors.y[i]);
+            const __m128 cos = _mm_load_ps(&rotations.x[i]);
+            const __m128 sin = _mm_load_ps(&rotations.y[i]);
+            _mm_store_ps(&vectors.x[i], _mm_sub_ps(_mm_mul_ps(x, cos), _mm_mul_ps(y, sin)));
+            _mm_store_ps(&vectors.y[i], _mm_add_ps(_mm_mul_ps(x, sin), _mm_mul_ps(y, cos)));
+        }
+#else
+        for (std::size_t i = 0; i < Vec2x8::SIZE; i++)
+        {
+            const Vec2 rotated = rotate(Vec2{vectors.x[i], vectors.y[i]}, Vec2{rotations.x[i], rotations.y[i]});
+            vectors.x[i] = rotated.x;
+            vectors.y[i] = rotated.y;
+        }
+#endif
+    }
+
+    /**
+    * These functions work on arrays of any length, eight vectors at a time.
+    */
+    void normalize(Vec2* vectors, const std::size_t count)
+    {
+        Vec2x8 batch;
+        for (std::size_t i = 0; i < count; i += Vec2x8::SIZE)
+        {
+            const std::size_t batch_count = std::min(count - i, Vec2x8::SIZE);
+            load(batch, &vectors[i], batch_count);
+            normalize(batch);
+            store(batch, &vectors[i], batch_count);
+        }
+    }
+
+    void getDirections(const Vec2* from, const Vec2* to, Vec2* directions, const std::size_t count)
+    {
+        Vec2x8 from_batch, to_batch, batch;
+        for (std::size_t i = 0; i < count; i += Vec2x8::SIZE)
+        {
+            const std::size_t batch_count = std::min(count - i, Vec2x8::SIZE);
+            load(from_batch, &from[i], batch_count);
+            load(to_batch, &to[i], batch_count);
+            getDirections(from_batch, to_batch, batch);
+            store(batch, &directions[i], batch_count);
+        }
+    }
+
+    /**
+    * This function rotates one vector by a number of degrees for each of count vectors,
+    * such as the spread of every projectile in a volley.
+    */
+    void rotate(const Vec2& vector, const int* degrees, Vec2* rotated, const std::size_t count)
+    {
+        Vec2x8 batch, rotations;
+        for (std::size_t i = 0; i < count; i += Vec2x8::SIZE)
+        {
+            const std::size_t batch_count = std::min(count - i, Vec2x8::SIZE);
+            for (std::size_t j = 0; j < Vec2x8::SIZE; j++)
+            {
+                const Vec2 rotation = (j < batch_count) ? getRotation(degrees[i + j]) : Vec2{0.0f, 0.0f};
+                batch.x[j] = vector.x;
+                batch.y[j] = vector.y;
+                rotations.x[j] = rotation.x;
+                rotations.y[j] = rotation.y;
+            }
+            rotate(batch, rotations);
+            store(batch, &rotated[i], batch_count);
+        }
+    }
+}
@@ -0,0 +1,321 @@
+#include "Memory.h"
+#include "Log.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+
+/**
+* This namespace keeps track of how much memory the game uses. Every heap allocation goes
+* through the global operator new, which is replaced so that each allocation is tagged
+* with what it is for. An allocation's tag comes from the container it is in if the
+* container uses Memory::Allocator, and otherwise from the innermost TagScope on that
+* thread. Memory that isn't on the heap, like textures, can be added with addExternal.
+*/
+namespace Memory
+{
+    /**
+    * This anonymous namespace holds the memory used by each tag and the allocation test.
+    */
+    namespace
+    {
+        const int TAG_COUNT = static_cast<int>(Tag::Count);
+
+        const char* TAG_NAMES[TAG_COUNT] = {
+            "General",
+            "Level",
+            "Enemy",
+            "Path",
+            "Projectile",
+            "Resource",
+            "Texture",
+            "Text",
+            "Render"
+        };
+
+        /**
+        * This struct is stored in front of every allocation. It is 16 bytes so that the
+        * memory after it is as aligned as the memory malloc returns.
+        */
+        struct alignas(16) Header
+        {
+            std::size_t size;
+            Tag tag;
+        };
+
+        /**
+        * This struct is the memory used by a tag. It is all atomic since any thread can allocate.
+        */
+        struct TagCounters
+        {
+            std::atomic<std::int64_t> live{0};
+            std::atomic<std::int64_t> peak{0};
+            std::atomic<std::uint64_t> allocations{0};
+            std::atomic<std::uint32_t> frame_allocations{0};
+        };
+
+        TagCounters tag_counters[TAG_COUNT];
+        TagCounters total_counters;
+        std::uint32_t last_frame_allocations = 0;
+
+        thread_local Tag current_tag = Tag::General;
+
+        int test_warmup_frames = 0;
+        int test_length = 0;
+        int test_frame = 0;
+        bool testing = false;
+        bool test_failed = false;
+
+        /**
+        * This function raises a peak to a new value, if it is higher.
+        */
+        void updatePeak(std::atomic<std::int64_t>& peak, const std::int64_t value)
+        {
+            std::int64_t current_peak = peak.load(std::memory_order_relaxed);
+            while (value > current_peak && !peak.compare_exchange_weak(current_peak, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        /**
+        * This function adds memory to a tag and to the total.
+        */
+        void addBytes(const Tag tag, const std::int64_t bytes)
+        {
+            TagCounters& counters = tag_counters[static_cast<int>(tag)];
+            updatePeak(counters.peak, counters.live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+            updatePeak(total_counters.peak, total_counters.live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+        }
+
+        /**
+        * This function returns the stats of a set of counters.
+        */
+        Stats getCounterStats(const TagCounters& counters)
+        {
+            return {counters.live.load(std::memory_order_relaxed),
+                    counters.peak.load(std::memory_order_relaxed),
+                    counters.allocations.load(std::memory_order_relaxed)};
+        }
+    }
+
+    /**
+    * This function returns the name of a tag.
+    */
+    const char* getName(const Tag tag)
+    {
+        return TAG_NAMES[static_cast<int>(tag)];
+    }
+
+    /**
+    * This function allocates memory on the heap under a tag.
+    */
+    void* allocate(const std::size_t size, const Tag tag)
+    {
+        Header* header = static_cast<Header*>(std::malloc(sizeof(Header) + size));
+        if (header == nullptr)
+        {
+            throw std::bad_alloc();
+        }
+        header->size = size;
+        header->tag = tag;
+
+        TagCounters& counters = tag_counters[static_cast<int>(tag)];
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        counters.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+        total_counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        total_counters.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+        addBytes(tag, size);
+
+        return header + 1;
+    }
+
+    /**
+    * This function frees memory allocated by allocate. The tag it was allocated under
+    * is stored with it.
+    */
+    void deallocate(void* memory)
+    {
+        if (memory == nullptr)
+        {
+            return;
+        }
+        Header* header = static_cast<Header*>(memory) - 1;
+        tag_counters[static_cast<int>(header->tag)].live.fetch_sub(header->size, std::memory_order_relaxed);
+        total_counters.live.fetch_sub(header->size, std::memory_order_relaxed);
+        std::free(header);
+    }
+
+    /**
+    * This function adds memory that isn't on the heap to a tag, such as the memory used
+    * by a texture. A negative amount removes it again.
+    */
+    void addExternal(const Tag tag, const std::int64_t bytes)
+    {
+        addBytes(tag, bytes);
+    }
+
+    /**
+    * This function returns how much memory a tag is using.
+    */
+    Stats getStats(const Tag tag)
+    {
+        return getCounterStats(tag_counters[static_cast<int>(tag)]);
+    }
+
+    /**
+    * This function returns how much memory is being used by every tag together.
+    */
+    Stats getTotalStats()
+    {
+        return getCounterStats(total_counters);
+    }
+
+    /**
+    * This function ends the current frame and starts counting allocations for the next one.
+    * If an allocation test is running, it fails if the frame allocated once warmed up.
+    */
+    void endFrame()
+    {
+        last_frame_allocations = total_counters.frame_allocations.exchange(0, std::memory_order_relaxed);
+
+        std::uint32_t tag_frame_allocations[TAG_COUNT];
+        for (int i = 0; i < TAG_COUNT; i++)
+        {
+            tag_frame_allocations[i] = tag_counters[i].frame_allocations.exchange(0, std::memory_order_relaxed);
+        }
+
+        if (!testing)
+        {
+            return;
+        }
+
+        test_frame++;
+        if (test_frame > test_warmup_frames && last_frame_allocations > 0)
+        {
+            test_failed = true;
+            LOG_WARNING(Diagnostics, "Allocation test: frame " << test_frame << " made " << last_frame_allocations << " allocations.");
+            for (int i = 0; i < TAG_COUNT; i++)
+            {
+                if (tag_frame_allocations[i] > 0)
+                {
+                    LOG_WARNING(Diagnostics, "    " << TAG_NAMES[i] << ": " << tag_frame_allocations[i]);
+                }
+            }
+        }
+        if (test_frame >= test_warmup_frames + test_length)
+        {
+            testing = false;
+            if (test_failed)
+            {
+                LOG_ERROR(Diagnostics, "Allocation test failed.");
+            }
+            else
+            {
+                LOG_INFO(Diagnostics, "Allocation test passed.");
+            }
+        }
+    }
+
+    /**
+    * This function returns how many allocations were made during the last frame, on any thread.
+    */
+    std::uint32_t getFrameAllocations()
+    {
+        return last_frame_allocations;
+    }
+
+    /**
+    * This function writes how much memory every tag is using.
+    */
+    void writeReport(std::ostream& out)
+    {
+        auto writeLine = [&](const char* name, const Stats& stats)
+        {
+            out << std::left << std::setw(12) << name << std::right
+                << " live " << std::setw(10) << stats.live
+                << " peak " << std::setw(10) << stats.peak
+                << " allocations " << stats.allocations << "\n";
+        };
+
+        for (int i = 0; i < TAG_COUNT; i++)
+        {
+            writeLine(TAG_NAMES[i], getStats(static_cast<Tag>(i)));
+        }
+        writeLine("Total", getTotalStats());
+    }
+
+    /**
+    * This function starts an allocation test. After warmup_frames frames, any frame that
+    * allocates fails the test. The test finishes after another test_frames frames.
+    */
+    void startAllocationTest(const int warmup_frames, const int test_frames)
+    {
+        test_warmup_frames = warmup_frames;
+        test_length = test_frames;
+        test_frame = 0;
+        testing = true;
+        test_failed = false;
+    }
+
+    /**
+    * This function returns whether or not the allocation test has finished.
+    */
+    bool isAllocationTestFinished()
+    {
+        return !testing && test_frame > 0;
+    }
+
+    /**
+    * This function returns whether or not the allocation test has failed.
+    */
+    bool hasAllocationTestFailed()
+    {
+        return test_failed;
+    }
+
+    /**
+    * Set the tag for allocations on this thread, remembering the tag it replaces.
+    */
+    TagScope::TagScope(const Tag tag)
+    {
+        previous_tag = current_tag;
+        current_tag = tag;
+    }
+
+    /**
+    * Put back the tag that was in use before this scope.
+    */
+    TagScope::~TagScope()
+    {
+        current_tag = previous_tag;
+    }
+
+    /**
+    * This function returns the tag that allocations on this thread are made under, unless
+    * they are made through an Allocator.
+    */
+    Tag getCurrentTag()
+    {
+        return current_tag;
+    }
+}
+
+/**
+* The global operator new and delete are replaced so that every heap allocation in the
+* game is tagged and counted.
+*/
+void* operator new(std::size_t size)
+{
+    return Memory::allocate(size, Memory::getCurrentTag());
+}
+
+void operator delete(void* memory) noexcept
+{
+    Memory::deallocate(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    Memory::deallocate(memory);
+}
@@ -0,0 +1,183 @@
+#include "Navigation.h"
+
+/**
+* This namespace holds the data derived from a level's tiles that is used for
+* collision and pathfinding. It is used both by the game and by the level cooker,
+* so that cooked data is always identical to data built at load time.
+*/
+namespace Navigation
+{
+    /**
+    * This anonymous namespace holds the order neighbours are checked in and the frontier
+    * used by breadthFirstSearch. The first four neighbours are above, below and to the
+    * sides, the rest are diagonal to allow for diagonal pathfinding.
+    */
+    namespace
+    {
+        const SDL_Point DIRECTIONS[8] = {
+            { 1,  0}, {-1,  0}, { 0,  1}, { 0, -1},
+            { 1, -1}, { 1,  1}, {-1, -1}, {-1,  1}
+        };
+
+        // The frontier of the breadth first search. It is kept between searches so that
+        // searching doesn't allocate once it has grown big enough. Each thread has its own
+        // because levels are cooked and prepared on other threads.
+        thread_local std::vector<SDL_Point> frontier;
+    }
+
+    /**
+    * This method returns whether or not a tile can be walked on. Tiles outside of
+    * the grid can never be walked on.
+    */
+    bool Grid::isWalkable(const int x, const int y) const
+    {
+        if (x < 0 || y < 0 || x >= width || y >= height)
+        {
+            return false;
+        }
+        return walkable[(y * width) + x];
+    }
+
+    /**
+    * This function builds the grid for a level. A tile is a wall if it is a wall on
+    * any layer.
+    */
+    void buildGrid(const LevelFile::Data& data, Grid& grid)
+    {
+        grid.width = data.width;
+        grid.height = data.height;
+        grid.walkable.assign(static_cast<std::size_t>(data.width) * data.height, 1);
+
+        for (int layer = 0; layer < data.layer_count; layer++)
+        {
+            const char* tiles = data.getLayer(layer);
+            for (std::size_t i = 0; i < grid.walkable.size(); i++)
+            {
+                if (tiles[i] == '2')
+                {
+                    grid.walkable[i] = 0;
+                }
+            }
+        }
+    }
+
+    /**
+    * This function merges the walls in the grid into as few rects as possible. The rects
+    * are in tiles, not pixels. Rows of walls are joined first, then rows with the same
+    * span are joined downwards.
+    */
+    std::vector<SDL_Rect> mergeWalls(const Grid& grid)
+    {
+        std::vector<SDL_Rect> walls;
+
+        // The index into walls of the rect that ends on the previous row, for each column it starts on.
+        std::vector<int> open_walls(grid.width, -1);
+
+        for (int y = 0; y < grid.height; y++)
+        {
+            std::vector<int> next_open_walls(grid.width, -1);
+            for (int x = 0; x < grid.width;)
+            {
+                if (grid.isWalkable(x, y))
+                {
+                    x++;
+                    continue;
+                }
+
+                // Find the end of this run of walls.
+                int start = x;
+                while (x < grid.width && !grid.isWalkable(x, y))
+                {
+                    x++;
+                }
+                int run_width = x - start;
+
+                // If the row above has a run with exactly the same span, extend it downwards.
+                int above = open_walls[start];
+                if (above != -1 && walls[above].w == run_width)
+                {
+                    walls[above].h++;
+                    next_open_walls[start] = above;
+                }
+                else
+                {
+                    walls.push_back({start, y, run_width, 1});
+                    next_open_walls[start] = walls.size() - 1;
+                }
+            }
+            open_walls.swap(next_open_walls);
+        }
+
+        return walls;
+    }
+
+    /**
+    * This function runs a breadth first search over the grid from start_tile. Every
+    * reached tile in came_from holds the index (y * width + x) of the tile it was reached
+    * from, and start_tile points to itself. It returns the number of tiles reached.
+    */
+    int breadthFirstSearch(const Grid& grid, const SDL_Point& start_tile, std::vector<int>& came_from)
+    {
+        came_from.assign(grid.walkable.size(), UNVISITED);
+        if (start_tile.x < 0 || start_tile.y < 0 || start_tile.x >= grid.width || start_tile.y >= grid.height)
+        {
+            return 0;
+        }
+
+        // Tiles are taken from the front of the frontier by moving next along it, instead
+        // of removing them, since every tile is added to it at most once.
+        frontier.clear();
+        frontier.reserve(grid.walkable.size());
+        frontier.push_back(start_tile);
+        std::size_t next = 0;
+
+        // Every path found by the algorithm starts here, so we set it to itself.
+        came_from[(start_tile.y * grid.width) + start_tile.x] = (start_tile.y * grid.width) + start_tile.x;
+        int reached = 1;
+
+        while (next < frontier.size())
+        {
+            SDL_Point current = frontier[next++];
+            int current_index = (current.y * grid.width) + current.x;
+
+            for (const auto& direction : DIRECTIONS)
+            {
+                int x = current.x + direction.x;
+                int y = current.y + direction.y;
+
+                // If the tile is traversable and it has not been visited before.
+                if (grid.isWalkable(x, y) && came_from[(y * grid.width) + x] == UNVISITED)
+                {
+                    frontier.push_back({x, y});
+                    came_from[(y * grid.width) + x] = current_index;
+                    reached++;
+                }
+            }
+        }
+        return reached;
+    }
+
+    /**
+    * This function returns the direction (0 to 7) of a neighbouring tile, in the order
+    * that breadthFirstSearch checks neighbours. It returns -1 if the tiles are not neighbours.
+    */
+    int getDirection(const SDL_Point& from, const SDL_Point& to)
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            if (from.x + DIRECTIONS[i].x == to.x && from.y + DIRECTIONS[i].y == to.y)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    /**
+    * This function returns the offset to a neighbouring tile for a direction.
+    */
+    SDL_Point getDirectionOffset(const int direction)
+    {
+        return DIRECTIONS[direction];
+    }
+}
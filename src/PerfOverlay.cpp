@@ -0,0 +1,138 @@
+#include "PerfOverlay.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+PerfOverlay::PerfOverlay() : text(Application::getFont("Resources/Fonts/GameFont.ttf", 16), "", 0, 0, false)
+{
+    int fps_limit = std::atoi(Application::getConfigMap()["screen"]["fps_limit"].c_str());
+    target_frame_time = fps_limit > 0 ? 1000.0 / fps_limit : 0.0;
+
+    // The overlay sits in the bottom left corner, with the text above the graph.
+    TTF_Font* font = Application::getFont("Resources/Fonts/GameFont.ttf", 16);
+    int line_skip = Application::getGlyphAtlas(font).getLineSkip();
+    panel_rect.w = (SAMPLE_COUNT * BAR_WIDTH) + (MARGIN * 2);
+    panel_rect.h = (LINE_COUNT * line_skip) + GRAPH_HEIGHT + (MARGIN * 3);
+    panel_rect.x = MARGIN;
+    panel_rect.y = Application::getWindowSize().y - panel_rect.h - MARGIN;
+    graph_rect = {panel_rect.x + MARGIN, panel_rect.y + panel_rect.h - MARGIN - GRAPH_HEIGHT, SAMPLE_COUNT * BAR_WIDTH, GRAPH_HEIGHT};
+    text = Text(font, "", panel_rect.x + MARGIN, panel_rect.y + MARGIN, false);
+
+    bars.reserve(SAMPLE_COUNT);
+}
+
+/**
+* This method shows the overlay if it is hidden and hides it if it is shown.
+*/
+void PerfOverlay::toggle()
+{
+    visible = !visible;
+
+    // Update the text straight away instead of showing old numbers.
+    refresh_timer = REFRESH_TIME;
+}
+
+/**
+* This method records the last frame's time and, a few times a second, updates the text.
+*/
+void PerfOverlay::update(const Stats& stats)
+{
+    const Application::FrameTimings& timings = Application::getFrameTimings();
+    frame_times[next_sample] = timings.frame / 1000.0;
+    next_sample = (next_sample + 1) % SAMPLE_COUNT;
+    sample_count = std::min(sample_count + 1, SAMPLE_COUNT);
+
+    refresh_timer += Application::getDeltaTime();
+    if (!visible || refresh_timer < REFRESH_TIME)
+    {
+        return;
+    }
+    refresh_timer = 0.0;
+
+    float sorted_times[SAMPLE_COUNT];
+    std::copy(frame_times, frame_times + sample_count, sorted_times);
+    std::sort(sorted_times, sorted_times + sample_count);
+
+    const Memory::Stats memory = Memory::getTotalStats();
+
+    char resolution[64];
+    if (timings.resolution_budget > 0.0)
+    {
+        std::snprintf(resolution, sizeof(resolution), "Resolution %d%%  budget %.2f ms", static_cast<int>(std::lround(timings.resolution_scale * 100)),
+                      timings.resolution_budget);
+    }
+    else
+    {
+        std::snprintf(resolution, sizeof(resolution), "Resolution %d%%", static_cast<int>(std::lround(timings.resolution_scale * 100)));
+    }
+
+    char buffer[512];
+    std::snprintf(buffer, sizeof(buffer),
+                  "Frame p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms\n"
+                  "Pacing error %.3f ms\n"
+                  "Events %.2f  Update %.2f  Draw %.2f  Present %.2f ms\n"
+                  "Draw calls %d  Batches %d  Culled %d\n"
+                  "%s\n"
+                  "Input latency %.1f  Aim latency %.1f ms  Events %d (%d motion)\n"
+                  "Enemies %d  Projectiles %d/%d  Pickups %d\n"
+                  "BFS %.3f ms, %d tiles reached\n"
+                  "Memory %.1f MB  peak %.1f MB  %u allocations",
+                  getPercentile(sorted_times, sample_count, 0.5), getPercentile(sorted_times, sample_count, 0.95),
+                  getPercentile(sorted_times, sample_count, 0.99), getPercentile(sorted_times, sample_count, 1.0),
+                  timings.pacing_error / 1000.0,
+                  timings.events / 1000.0, timings.update / 1000.0, timings.draw / 1000.0, timings.present / 1000.0,
+                  timings.draw_calls, timings.batches, timings.culled, resolution,
+                  timings.input_latency / 1000.0, timings.aim_latency / 1000.0, timings.input_events, timings.mouse_motions,
+                  stats.enemies, stats.projectiles, stats.enemy_projectiles, stats.pickups,
+                  stats.bfs_time / 1000.0, stats.bfs_tiles_reached,
+                  memory.live / 1048576.0, memory.peak / 1048576.0, Memory::getFrameAllocations());
+    text.setText(buffer);
+}
+
+/**
+* This method draws the overlay, if it is shown.
+*/
+void PerfOverlay::draw()
+{
+    if (!visible)
+    {
+        return;
+    }
+
+    Application::fillRects(RenderSnapshot::Layer::Interface, &panel_rect, 1, {0, 0, 0, 160});
+
+    // Draw a bar for every frame, oldest on the left. Bars are cut off at the top of the graph.
+    bars.clear();
+    for (int i = 0; i < sample_count; i++)
+    {
+        float frame_time = frame_times[(next_sample - sample_count + i + SAMPLE_COUNT) % SAMPLE_COUNT];
+        int bar_height = std::ceil(std::min(frame_time / GRAPH_MAX_TIME, 1.0f) * GRAPH_HEIGHT);
+        bars.push_back({graph_rect.x + ((SAMPLE_COUNT - sample_count + i) * BAR_WIDTH), graph_rect.y + GRAPH_HEIGHT - bar_height,
+                        BAR_WIDTH, bar_height});
+    }
+    Application::fillRects(RenderSnapshot::Layer::Interface, bars.data(), bars.size(), {0, 200, 0, 255});
+
+    // Draw a line at the frame time the game is aiming for.
+    if (target_frame_time > 0.0 && target_frame_time < GRAPH_MAX_TIME)
+    {
+        int line_y = graph_rect.y + GRAPH_HEIGHT - (target_frame_time / GRAPH_MAX_TIME * GRAPH_HEIGHT);
+        Application::drawLine(RenderSnapshot::Layer::Interface, {graph_rect.x, line_y}, {graph_rect.x + graph_rect.w, line_y}, {200, 0, 0, 255});
+    }
+
+    text.draw();
+}
+
+/**
+* This method returns a frame time percentile, in milliseconds, from sorted frame times.
+*/
+float PerfOverlay::getPercentile(const float* sorted_times, const int count, const float percentile)
+{
+    if (count == 0)
+    {
+        return 0.0;
+    }
+    int index = std::ceil(percentile * count) - 1;
+    return sorted_times[std::max(0, std::min(index, count - 1))];
+}
@@ -17,44 +17,13 @@ Player::Player() : ammo_counter(Application::getFont("Resources/Fonts/GameFont.t
     weapon_rect.h *= 2;
 }
 
-/**
-* This method respawns the player by resetting some attributes.
-*/
-void Player::respawn()
-{
-    ammo = {
-        {Weapon::Handgun,         25},
-        {Weapon::Shotgun,          0},
-        {Weapon::AssaultRifle,     0},
-        {Weapon::Minigun,          0},
-        {Weapon::PlasmaRifle,      0}
-    };
-
-    health = MAX_HEALTH;
-
-    shooting = false;
-    current_weapon = Weapon::Handgun;
-    weapon_index = 0;
-    weapons = {Weapon::Handgun};
-
-    updateAmmoCounter();
-    weapon_texture = Application::getTexture("Resources/Images/Handgun.png");
-    SDL_QueryTexture(weapon_texture, nullptr, nullptr, &weapon_rect.w, &weapon_rect.h);
-    weapon_rect.x = 20;
-    weapon_rect.y = 60;
-    weapon_rect.w *= 2;
-    weapon_rect.h *= 2;
-
-    updateHealthCount();
-}
-
 /**
 * This method handles the key presses that are relevant to the player.
 * This mostly includes movement.
 */
-void Player::handleKeyPresses()
+void Player::handleKeyPresses(const SDL_Event& event)
 {
-    switch (Application::getEvent().key.keysym.sym)
+    switch (event.key.keysym.sym)
     {
     case SDLK_a:
         movement.x = -SPEED;
@@ -77,9 +46,9 @@ void Player::handleKeyPresses()
 * This method handles the key releases that are relevant to the player.
 * This mostly includes movement.
 */
-void Player::handleKeyReleases()
+void Player::handleKeyReleases(const SDL_Event& event)
 {
-    switch (Application::getEvent().key.keysym.sym)
+    switch (event.key.keysym.sym)
     {
     case SDLK_a:
     case SDLK_d:
@@ -102,50 +71,27 @@ void Player::update(const std::vector<SDL_Rect>& solids)
 {
     // Collisions for the X axis.
     rect.x += std::round(movement.x * Application::getDeltaTime());
-    for (const auto& solid : solids)
-    {
-        if (SDL_HasIntersection(&solid, &rect))
-        {
-            // If the player is moving to the right.
-            if (movement.x > 0)
-            {
-                rect.x = solid.x - rect.w;
-            }
-            // If the player is moving to the left.
-            else if (movement.x < 0)
-            {
-                rect.x = solid.x + solid.w;
-            }
-        }
-    }
+    Telemetry::add(Telemetry::Counter::CollisionTests, solids.size());
+    Tools::resolveCollisionsX(rect, movement.x, solids.data(), solids.size());
 
     // Collisions for the Y axis.
     rect.y += std::round(movement.y * Application::getDeltaTime());
-    for (const auto& solid : solids)
-    {
-        if (SDL_HasIntersection(&solid, &rect))
-        {
-            // If the player is moving down.
-            if (movement.y > 0)
-            {
-                rect.y = solid.y - rect.h;
-            }
-            // If the player is moving up.
-            else if (movement.y < 0)
-            {
-                rect.y = solid.y + solid.h;
-            }
-        }
-    }
+    Telemetry::add(Telemetry::Counter::CollisionTests, solids.size());
+    Tools::resolveCollisionsY(rect, movement.y, solids.data(), solids.size());
 
     // Center the camera on the player.
     Application::getCamera().x = (Application::getWindowSize().x / 2) - rect.x;
     Application::getCamera().y = (Application::getWindowSize().y / 2) - rect.y;
 
-    // Make sure the player faces the mouse.
-    angle = Tools::angleBetweenPoints(rect.x + (rect.w / 2), rect.y + (rect.h / 2),
-                                      Application::getMousePosition().x - Application::getCamera().x,
-                                      Application::getMousePosition().y - Application::getCamera().y) - 180;
+    // Make sure the player faces the mouse. If the mouse is right on the player's centre
+    // there is no direction, so the player keeps facing the way they were.
+    const Maths::Vec2 mouse = {static_cast<float>(Application::getMousePosition().x - Application::getCamera().x),
+                               static_cast<float>(Application::getMousePosition().y - Application::getCamera().y)};
+    const Maths::Vec2 mouse_aim = Maths::getDirection(Maths::toVec2(getCentre()), mouse);
+    if (mouse_aim.x != 0.0 || mouse_aim.y != 0.0)
+    {
+        aim = mouse_aim;
+    }
 
     shoot_delay += Application::getDeltaTime();
 }
@@ -156,9 +102,19 @@ void Player::update(const std::vector<SDL_Rect>& solids)
 void Player::draw()
 {
     SDL_Rect draw_rect = Application::convertToCameraView(rect);
-    SDL_RenderCopyEx(Application::getRenderer(), texture, nullptr, &draw_rect, angle, nullptr, SDL_FLIP_NONE);
+
+    // Face the mouse as it was just before the frame was drawn, which with late latching can
+    // be newer than where the player aimed when they were updated. Shots still go that way.
+    const Maths::Vec2 draw_mouse = {static_cast<float>(Application::getDrawMousePosition().x - Application::getCamera().x),
+                                    static_cast<float>(Application::getDrawMousePosition().y - Application::getCamera().y)};
+    Maths::Vec2 draw_aim = Maths::getDirection(Maths::toVec2(getCentre()), draw_mouse);
+    if (draw_aim.x == 0.0 && draw_aim.y == 0.0)
+    {
+        draw_aim = aim;
+    }
+    Application::drawTexture(RenderSnapshot::Layer::Player, texture, draw_rect, Maths::getAngle(draw_aim));
     ammo_counter.draw();
-    SDL_RenderCopy(Application::getRenderer(), weapon_texture, nullptr, &weapon_rect);
+    Application::drawTexture(RenderSnapshot::Layer::Weapon, weapon_texture, weapon_rect);
     health_count.draw();
 }
 
@@ -185,11 +141,11 @@ SDL_Rect& Player::getRect()
 }
 
 /**
-* This method changes the player's current weapon.
+* This method changes the player's current weapon by how far the mouse wheel was turned.
 */
-void Player::changeWeapon()
+void Player::changeWeapon(const SDL_Event& event)
 {
-    weapon_index += Application::getEvent().wheel.y;
+    weapon_index += event.wheel.y;
     if (weapon_index < 0)
     {
         weapon_index = weapons.size() - 1;
@@ -200,32 +156,9 @@ void Player::changeWeapon()
     }
     current_weapon = weapons[weapon_index];
 
-    // Update the ammo counter on the HUD.
+    // Update the ammo counter and weapon icon on the HUD.
     updateAmmoCounter();
-
-    switch (current_weapon)
-    {
-    case Weapon::Handgun:
-        weapon_texture = Application::getTexture("Resources/Images/Handgun.png");
-        break;
-    case Weapon::Shotgun:
-        weapon_texture = Application::getTexture("Resources/Images/Shotgun.png");
-        break;
-    case Weapon::AssaultRifle:
-        weapon_texture = Application::getTexture("Resources/Images/AssaultRifle.png");
-        break;
-    case Weapon::Minigun:
-        weapon_texture = Application::getTexture("Resources/Images/Minigun.png");
-        break;
-    case Weapon::PlasmaRifle:
-        weapon_texture = Application::getTexture("Resources/Images/PlasmaRifle.png");
-        break;
-    default:
-        break;
-    }
-    SDL_QueryTexture(weapon_texture, nullptr, nullptr, &weapon_rect.w, &weapon_rect.h);
-    weapon_rect.w *= 2;
-    weapon_rect.h *= 2;
+    updateWeaponIcon();
 }
 
 /**
@@ -352,11 +285,11 @@ void Player::damage(const int damage)
 }
 
 /**
-* This method gets the player's angle.
+* This method gets the direction the player is aiming in.
 */
-int Player::getAngle()
+const Maths::Vec2& Player::getAim()
 {
-    return angle;
+    return aim;
 }
 
 /**
@@ -372,9 +305,7 @@ bool Player::isDead()
 */
 void Player::updateAmmoCounter()
 {
-    std::stringstream ss;
-    ss << "Ammo: " << ammo[current_weapon];
-    ammo_counter.setText(ss.str());
+    ammo_counter.setText("Ammo: " + std::to_string(ammo[current_weapon]));
 }
 
 /**
@@ -382,7 +313,66 @@ void Player::updateAmmoCounter()
 */
 void Player::updateHealthCount()
 {
-    std::stringstream ss;
-    ss << "Health: " << health;
-    health_count.setText(ss.str());
+    health_count.setText("Health: " + std::to_string(health));
+}
+
+/**
+* This method updates the weapon icon on the HUD.
+*/
+void Player::updateWeaponIcon()
+{
+    switch (current_weapon)
+    {
+    case Weapon::Handgun:
+        weapon_texture = Application::getTexture("Resources/Images/Handgun.png");
+        break;
+    case Weapon::Shotgun:
+        weapon_texture = Application::getTexture("Resources/Images/Shotgun.png");
+        break;
+    case Weapon::AssaultRifle:
+        weapon_texture = Application::getTexture("Resources/Images/AssaultRifle.png");
+        break;
+    case Weapon::Minigun:
+        weapon_texture = Application::getTexture("Resources/Images/Minigun.png");
+        break;
+    case Weapon::PlasmaRifle:
+        weapon_texture = Application::getTexture("Resources/Images/PlasmaRifle.png");
+        break;
+    default:
+        break;
+    }
+    SDL_QueryTexture(weapon_texture, nullptr, nullptr, &weapon_rect.w, &weapon_rect.h);
+    weapon_rect.w *= 2;
+    weapon_rect.h *= 2;
+}
+
+/**
+* This method gets the current state of the player.
+*/
+Player::State Player::getState()
+{
+    return {rect, health, ammo, weapons, weapon_index, shoot_delay};
+}
+
+/**
+* This method sets the state of the player and updates the HUD to match. The player
+* stops moving and shooting until the keys and buttons are pressed again.
+*/
+void Player::setState(const State& state)
+{
+    rect = state.rect;
+    health = state.health;
+    ammo = state.ammo;
+    weapons = state.weapons;
+    weapon_index = state.weapon_index;
+    current_weapon = weapons[weapon_index];
+    shoot_delay = state.shoot_delay;
+
+    // Keys and buttons held before the state was set would otherwise carry on into it.
+    shooting = false;
+    movement = {0.0, 0.0};
+
+    updateAmmoCounter();
+    updateWeaponIcon();
+    updateHealthCount();
 }
@@ -0,0 +1,285 @@
+#include "Profiler.h"
+#include "Log.h"
+
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <thread>
+
+/**
+* This namespace times sections of a frame (zones) and keeps track of values that change
+* each frame (counters). It should be used through the macros in the header, so that it
+* compiles to nothing when PROFILER_ENABLED isn't defined. A capture can be started at any
+* time, which streams every frame to a Chrome trace file that can be opened in Perfetto or
+* chrome://tracing. Only one thread is profiled, the main thread unless setThread is used,
+* and zones on other threads are ignored.
+*/
+namespace Profiler
+{
+    /**
+    * This anonymous namespace holds the frame being recorded, the last complete frame and
+    * the current capture.
+    */
+    namespace
+    {
+        std::atomic<std::thread::id> profiled_thread;
+        Frame current_frame;
+        Frame last_frame;
+        int depth = 0;
+
+        double ticks_per_microsecond = 1.0;
+
+        std::ofstream capture_file;
+        std::uint64_t capture_start = 0;
+        bool first_capture_event = true;
+
+        /**
+        * This function starts a new event in the trace file.
+        */
+        std::ofstream& beginEvent()
+        {
+            capture_file << (first_capture_event ? "\n" : ",\n");
+            first_capture_event = false;
+            return capture_file;
+        }
+
+        /**
+        * This function returns the time of a tick in the trace, in microseconds since the
+        * capture started.
+        */
+        double getTraceTime(const std::uint64_t ticks)
+        {
+            return toMicroseconds(ticks - capture_start);
+        }
+
+        /**
+        * This function writes a frame to the trace file.
+        */
+        void writeFrame(const Frame& frame)
+        {
+            // Anything that started before the capture would have a negative time.
+            if (frame.start >= capture_start)
+            {
+                beginEvent() << "{\"name\":\"Frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":"
+                             << getTraceTime(frame.start) << "}";
+            }
+
+            for (const auto& zone : frame.zones)
+            {
+                if (zone.start < capture_start)
+                {
+                    continue;
+                }
+                beginEvent() << "{\"name\":\"" << zone.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"
+                             << getTraceTime(zone.start) << ",\"dur\":" << toMicroseconds(zone.end - zone.start) << "}";
+            }
+
+            for (const auto& counter : frame.counters)
+            {
+                beginEvent() << "{\"name\":\"" << counter.name << "\",\"ph\":\"C\",\"pid\":1,\"tid\":1,\"ts\":"
+                             << getTraceTime(frame.end) << ",\"args\":{\"value\":" << counter.value << "}}";
+            }
+        }
+
+        /**
+        * This function returns a counter in the current frame, adding it if it is new. It
+        * returns nullptr if there are too many counters.
+        */
+        CounterEvent* findCounter(const char* name)
+        {
+            for (auto& counter : current_frame.counters)
+            {
+                if (counter.name == name || std::strcmp(counter.name, name) == 0)
+                {
+                    return &counter;
+                }
+            }
+            if (current_frame.counters.size() >= MAX_COUNTERS)
+            {
+                return nullptr;
+            }
+            current_frame.counters.push_back({name, 0.0});
+            return &current_frame.counters.back();
+        }
+    }
+
+    /**
+    * Start timing the zone. Nothing is recorded off the profiled thread or if the frame is full.
+    */
+    Zone::Zone(const char* name)
+    {
+        index = -1;
+        if (std::this_thread::get_id() != profiled_thread.load(std::memory_order_relaxed) || current_frame.zones.size() >= MAX_ZONES)
+        {
+            return;
+        }
+        index = current_frame.zones.size();
+        current_frame.zones.push_back({name, getTime(), 0, depth});
+        depth++;
+    }
+
+    /**
+    * Stop timing the zone.
+    */
+    Zone::~Zone()
+    {
+        if (index != -1)
+        {
+            current_frame.zones[index].end = getTime();
+            depth--;
+        }
+    }
+
+    /**
+    * This function sets up the profiler. It must be called from the main thread before
+    * anything is profiled.
+    */
+    void startUp()
+    {
+        profiled_thread = std::this_thread::get_id();
+        ticks_per_microsecond = SDL_GetPerformanceFrequency() / 1000000.0;
+
+        current_frame.zones.reserve(MAX_ZONES);
+        current_frame.counters.reserve(MAX_COUNTERS);
+        last_frame.zones.reserve(MAX_ZONES);
+        last_frame.counters.reserve(MAX_COUNTERS);
+        current_frame.start = getTime();
+    }
+
+    /**
+    * This function makes the thread that calls it the one that is profiled, such as when
+    * the game is updated on its own thread.
+    */
+    void setThread()
+    {
+        profiled_thread = std::this_thread::get_id();
+    }
+
+    /**
+    * This function ends the current frame and starts the next one. If a capture is running
+    * the frame that just ended is written to it.
+    */
+    void markFrame()
+    {
+        current_frame.end = getTime();
+        std::swap(current_frame, last_frame);
+
+        if (capture_file.is_open())
+        {
+            writeFrame(last_frame);
+        }
+
+        current_frame.zones.clear();
+        current_frame.counters.clear();
+        current_frame.start = last_frame.end;
+        depth = 0;
+    }
+
+    /**
+    * This function throws away what has been recorded for the current frame and starts it
+    * again from now, so that time spent not running frames, such as while the game is idle,
+    * isn't counted as part of it.
+    */
+    void restartFrame()
+    {
+        current_frame.zones.clear();
+        current_frame.counters.clear();
+        current_frame.start = getTime();
+        depth = 0;
+    }
+
+    /**
+    * This function sets the value of a counter for the current frame.
+    */
+    void setCounter(const char* name, const double value)
+    {
+        CounterEvent* counter = findCounter(name);
+        if (counter != nullptr)
+        {
+            counter->value = value;
+        }
+    }
+
+    /**
+    * This function adds to the value of a counter for the current frame. Counters start
+    * every frame at 0.
+    */
+    void addCounter(const char* name, const double amount)
+    {
+        CounterEvent* counter = findCounter(name);
+        if (counter != nullptr)
+        {
+            counter->value += amount;
+        }
+    }
+
+    /**
+    * This function returns everything recorded during the last complete frame.
+    */
+    const Frame& getLastFrame()
+    {
+        return last_frame;
+    }
+
+    /**
+    * This function returns the current time in performance counter ticks.
+    */
+    std::uint64_t getTime()
+    {
+        return SDL_GetPerformanceCounter();
+    }
+
+    /**
+    * This function converts performance counter ticks to microseconds.
+    */
+    double toMicroseconds(const std::uint64_t ticks)
+    {
+        return ticks / ticks_per_microsecond;
+    }
+
+    /**
+    * This function starts streaming frames to a Chrome trace file.
+    */
+    void startCapture(const std::string& file_name)
+    {
+        if (capture_file.is_open())
+        {
+            stopCapture();
+        }
+
+        capture_file.open(file_name);
+        if (!capture_file)
+        {
+            LOG_WARNING(Diagnostics, "Unable to start profiler capture: " << file_name);
+            return;
+        }
+
+        LOG_INFO(Diagnostics, "Starting profiler capture: " << file_name);
+        capture_file << std::fixed << std::setprecision(3);
+        capture_file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        capture_start = getTime();
+        first_capture_event = true;
+    }
+
+    /**
+    * This function finishes the trace file of the current capture.
+    */
+    void stopCapture()
+    {
+        if (capture_file.is_open())
+        {
+            LOG_INFO(Diagnostics, "Stopping profiler capture.");
+            capture_file << "\n]}\n";
+            capture_file.close();
+        }
+    }
+
+    /**
+    * This function returns whether or not a capture is running.
+    */
+    bool isCapturing()
+    {
+        return capture_file.is_open();
+    }
+}
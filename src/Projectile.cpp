@@ -2,8 +2,12 @@
 
 /**
 * Create a projectile with a texture, a start position, a set damage, a speed and a spread.
+* The direction must be a unit vector, and the spread is in degrees either side of it. The
+* spread is drawn from the given stream, so that the player's and the enemies' shots don't
+* change each other.
 */
-Projectile::Projectile(SDL_Texture* texture, const int x, const int y, const int direction, const int damage, const int speed, const int spread)
+Projectile::Projectile(SDL_Texture* texture, const int x, const int y, const Maths::Vec2& direction, const int damage, const int speed, const int spread,
+                       const Random::Stream stream)
 {
     this->texture = texture;
     this->damage = damage;
@@ -13,20 +17,36 @@ Projectile::Projectile(SDL_Texture* texture, const int x, const int y, const int
     rect.x = x - (rect.w / 2);
     rect.y = y - (rect.h / 2);
 
-    angle = direction;
+    // Apply spread to projectile. Volleys work out their spread together and pass none.
+    normal = direction;
+    if (spread > 0)
+    {
+        normal = Maths::rotate(normal, Maths::getRotation(Random::get(stream).getInt(-spread, spread)));
+    }
 
-    // Apply spread to projectile.
-    angle += Tools::getRandomInt(-spread, spread);
+    normal = normal * this->speed;
 
-    // Convert the angle to radians.
-    normal.x = std::cos(angle * 0.0174533);
-    normal.y = std::sin(angle * 0.0174533);
+    Telemetry::add(Telemetry::Counter::ProjectilesSpawned);
+}
 
-    // Normalize the vector.
-    normal = Tools::normalizeVector(normal);
+/**
+* Create a projectile from a saved state.
+*/
+Projectile::Projectile(const State& state)
+{
+    texture = state.texture;
+    rect = state.rect;
+    normal = state.normal;
+    damage = state.damage;
+    speed = state.speed;
+}
 
-    normal.x *= this->speed;
-    normal.y *= this->speed;
+/**
+* This method gets the current state of the projectile.
+*/
+Projectile::State Projectile::getState()
+{
+    return {texture, rect, normal, damage, speed};
 }
 
 /**
@@ -46,7 +66,7 @@ void Projectile::draw()
 {
     // Apply the camera to the projectile.
     SDL_Rect draw_rect = Application::convertToCameraView(rect);
-    SDL_RenderCopyEx(Application::getRenderer(), texture, nullptr, &draw_rect, angle, nullptr, SDL_FLIP_NONE);
+    Application::drawTexture(RenderSnapshot::Layer::Projectiles, texture, draw_rect, Maths::getAngle(normal));
 }
 
 /**
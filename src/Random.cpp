@@ -0,0 +1,153 @@
+#include "Random.h"
+
+#include <chrono>
+
+/**
+* This namespace holds the game's random numbers. Each part of the game draws from its own
+* stream, so that, for example, the spread of the player's shots doesn't change the spread
+* of the boss's volleys. Streams are only independent of each other's draws though, so
+* anything the player does that changes what the enemies do, such as killing one or being
+* seen by one, still changes the numbers they draw. Every stream is seeded from one seed,
+* so a game can be played again exactly.
+*/
+namespace Random
+{
+    /**
+    * This anonymous namespace holds the generator for every stream.
+    */
+    namespace
+    {
+        const int STREAM_COUNT = static_cast<int>(Stream::Count);
+
+        /**
+        * This struct makes every stream's generator, seeded from the clock.
+        */
+        struct Streams
+        {
+            Generator generators[STREAM_COUNT];
+
+            Streams()
+            {
+                const std::uint32_t clock_seed = std::chrono::system_clock::now().time_since_epoch().count();
+                for (int i = 0; i < STREAM_COUNT; i++)
+                {
+                    generators[i].seed(clock_seed, i);
+                }
+            }
+        };
+
+        Streams streams;
+
+        /**
+        * This function works out the threshold that getBounded rejects numbers below, so
+        * that every number in the range is equally likely.
+        */
+        std::uint32_t getThreshold(const std::uint32_t range)
+        {
+            return (0u - range) % range;
+        }
+
+        /**
+        * This function turns 32 random bits into a number from 0 to range - 1 without a
+        * division, using Lemire's multiply and shift. Numbers whose low bits are below the
+        * threshold are rejected, which is rare, and the next bits are tried instead.
+        */
+        std::uint32_t getBounded(Generator& generator, const std::uint32_t range, const std::uint32_t threshold)
+        {
+            std::uint64_t product = static_cast<std::uint64_t>(generator.next()) * range;
+            while (static_cast<std::uint32_t>(product) < threshold)
+            {
+                product = static_cast<std::uint64_t>(generator.next()) * range;
+            }
+            return product >> 32;
+        }
+    }
+
+    Generator::Generator(const std::uint64_t seed, const std::uint64_t stream)
+    {
+        this->seed(seed, stream);
+    }
+
+    /**
+    * This method restarts the generator from a seed and stream.
+    */
+    void Generator::seed(const std::uint64_t seed, const std::uint64_t stream)
+    {
+        // The increment must be odd, and each one gives a different sequence.
+        state = 0;
+        increment = (stream << 1) | 1;
+        next();
+        state += seed;
+        next();
+    }
+
+    /**
+    * This method returns the next 32 random bits.
+    */
+    std::uint32_t Generator::next()
+    {
+        const std::uint64_t old_state = state;
+        state = (old_state * 6364136223846793005ull) + increment;
+
+        const std::uint32_t shifted = ((old_state >> 18) ^ old_state) >> 27;
+        const std::uint32_t rotation = old_state >> 59;
+        return (shifted >> rotation) | (shifted << ((0u - rotation) & 31));
+    }
+
+    /**
+    * This method returns a random number from a range, including both ends.
+    */
+    int Generator::getInt(const int from, const int to)
+    {
+        const std::uint32_t range = static_cast<std::uint32_t>(to - from) + 1;
+        return from + static_cast<int>(getBounded(*this, range, getThreshold(range)));
+    }
+
+    /**
+    * This method fills an array with random numbers from a range, including both ends.
+    * This is quicker than calling getInt for each one, such as for every pellet in a volley.
+    */
+    void Generator::getInts(int* values, const std::size_t count, const int from, const int to)
+    {
+        const std::uint32_t range = static_cast<std::uint32_t>(to - from) + 1;
+        const std::uint32_t threshold = getThreshold(range);
+        for (std::size_t i = 0; i < count; i++)
+        {
+            values[i] = from + static_cast<int>(getBounded(*this, range, threshold));
+        }
+    }
+
+    /**
+    * This method returns a random number from a range, including from but not to.
+    */
+    float Generator::getFloat(const float from, const float to)
+    {
+        // The top 24 bits fill a float's mantissa exactly, giving a number from 0 to 1.
+        const float unit = (next() >> 8) * (1.0f / 16777216.0f);
+        return from + ((to - from) * unit);
+    }
+
+    /**
+    * This function seeds every stream from one seed. Until it is called the seed comes
+    * from the clock.
+    */
+    void seed(const std::uint32_t seed)
+    {
+        for (int i = 0; i < STREAM_COUNT; i++)
+        {
+            streams.generators[i].seed(seed, i);
+        }
+    }
+
+    /**
+    * This function returns the generator for a stream. Streams must only be used by the
+    * thread that updates the game, which is the simulation thread when the game is threaded
+    * and the main thread otherwise. Spawning a level's enemies in Level::setLayout is fine,
+    * since that happens on the updating thread, but nothing that draws or that runs in
+    * Level::prepare, which the level loader calls on its own thread, may use them.
+    */
+    Generator& get(const Stream stream)
+    {
+        return streams.generators[static_cast<int>(stream)];
+    }
+}
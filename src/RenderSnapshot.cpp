@@ -0,0 +1,475 @@
+#include "RenderSnapshot.h"
+#include "Application.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+/**
+* This anonymous namespace holds the layout of render snapshot files and helpers for
+* reading and writing them. A file is the header, then every sprite the snapshot uses,
+* then the commands, vertices, indices and rects as they are kept in memory. Everything is
+* stored in the byte order of the machine that wrote it.
+*/
+namespace
+{
+    const char MAGIC[4] = {'R', 'C', 'M', 'D'};
+    const std::uint32_t VERSION = 1;
+
+    const char* LAYER_NAMES[static_cast<int>(RenderSnapshot::Layer::Count)] = {
+        "Map",
+        "Pickups",
+        "Enemies",
+        "Projectiles",
+        "Player",
+        "Weapon",
+        "Interface"
+    };
+
+    // Limits on the size of anything read from a file, so a broken file can't allocate everything.
+    const std::uint32_t MAX_STRING = 4096;
+    const std::uint32_t MAX_COUNT = 1 << 24;
+
+    struct Header
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t tick;
+        SDL_Rect viewport;
+        std::int32_t culled;
+        std::uint32_t sprite_count;
+        std::uint32_t command_count;
+        std::uint32_t vertex_count;
+        std::uint32_t index_count;
+        std::uint32_t rect_count;
+    };
+
+    template <typename T>
+    void writeValue(std::ostream& file, const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T, typename Allocator>
+    void writeArray(std::ostream& file, const std::vector<T, Allocator>& values)
+    {
+        file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+    }
+
+    template <typename T>
+    bool readValue(std::ifstream& file, T& value)
+    {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    template <typename T, typename Allocator>
+    bool readArray(std::ifstream& file, std::vector<T, Allocator>& values, const std::uint32_t count)
+    {
+        if (count > MAX_COUNT)
+        {
+            return false;
+        }
+        values.resize(count);
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(T)));
+    }
+}
+
+/**
+* This method empties the snapshot so that the next frame can be recorded into it.
+* Sprites that are entirely outside of the viewport are culled. The scale is the
+* resolution the world layers should be drawn at, as a fraction of the viewport's.
+*/
+void RenderSnapshot::clear(const std::uint64_t tick, const SDL_Rect& viewport, const float scale)
+{
+    this->tick = tick;
+    this->viewport = viewport;
+    this->scale = scale;
+    input_time = 0;
+    aim_time = 0;
+    statistics = Statistics();
+    commands.clear();
+    order.clear();
+    vertices.clear();
+    indices.clear();
+    rects.clear();
+}
+
+/**
+* This method records a sprite, rotated about its centre by an angle in degrees clockwise.
+*/
+void RenderSnapshot::addSprite(const Layer layer, const std::uint16_t sprite, const SDL_Rect& destination, const float angle)
+{
+    // A rotated sprite can reach past its rect, but never by more than half its longest side.
+    SDL_Rect bounds = destination;
+    if (angle != 0.0f)
+    {
+        const int reach = (std::max(destination.w, destination.h) + 1) / 2;
+        bounds = {destination.x - reach, destination.y - reach, destination.w + (reach * 2), destination.h + (reach * 2)};
+    }
+    if (!SDL_HasIntersection(&bounds, &viewport))
+    {
+        statistics.culled++;
+        return;
+    }
+
+    Command command = {};
+    command.type = Type::Sprite;
+    command.layer = layer;
+    command.sprite = sprite;
+    command.destination = destination;
+    command.angle = angle;
+    commands.push_back(command);
+}
+
+/**
+* This method records triangles from a sprite, such as a line of text.
+*/
+void RenderSnapshot::addGeometry(const Layer layer, const std::uint16_t sprite, const SDL_Vertex* vertices, const int vertex_count,
+                                 const int* indices, const int index_count)
+{
+    Command command = {};
+    command.type = Type::Geometry;
+    command.layer = layer;
+    command.sprite = sprite;
+    command.first = this->indices.size();
+    command.count = index_count;
+    commands.push_back(command);
+
+    const int first_vertex = this->vertices.size();
+    this->vertices.insert(this->vertices.end(), vertices, vertices + vertex_count);
+    for (int i = 0; i < index_count; i++)
+    {
+        this->indices.push_back(first_vertex + indices[i]);
+    }
+}
+
+/**
+* This method records filled rects in one colour, blended by the colour's alpha.
+*/
+void RenderSnapshot::addRects(const Layer layer, const SDL_Rect* rects, const int count, const SDL_Color& colour)
+{
+    Command command = {};
+    command.type = Type::Rects;
+    command.layer = layer;
+    command.colour = colour;
+    command.first = this->rects.size();
+    command.count = count;
+    commands.push_back(command);
+
+    this->rects.insert(this->rects.end(), rects, rects + count);
+}
+
+/**
+* This method records a line in one colour.
+*/
+void RenderSnapshot::addLine(const Layer layer, const SDL_Point& start, const SDL_Point& end, const SDL_Color& colour)
+{
+    Command command = {};
+    command.type = Type::Line;
+    command.layer = layer;
+    command.destination = {start.x, start.y, end.x, end.y};
+    command.colour = colour;
+    commands.push_back(command);
+}
+
+/**
+* This method works out the order the commands are drawn in and the statistics. It must
+* be called once everything has been recorded. If batch is false, the commands on each
+* layer are left in the order they were recorded.
+*/
+void RenderSnapshot::sort(const bool batch)
+{
+    // Sorting the keys rather than the commands keeps the sort small, and because every key
+    // ends with the command's index, commands that tie stay in the order they were recorded.
+    order.clear();
+    for (std::size_t i = 0; i < commands.size(); i++)
+    {
+        const Command& command = commands[i];
+        const bool batched = batch && command.layer != Layer::Interface;
+        order.push_back((static_cast<std::uint64_t>(command.layer) << 56) |
+                        (static_cast<std::uint64_t>(batched ? command.sprite : 0) << 32) | i);
+    }
+    std::sort(order.begin(), order.end());
+
+    const int culled = statistics.culled;
+    statistics = Statistics();
+    statistics.culled = culled;
+    statistics.commands = commands.size();
+
+    const Command* previous = nullptr;
+    for (std::uint64_t key : order)
+    {
+        const Command& command = commands[key & 0xFFFFFFFF];
+        statistics.layer_commands[static_cast<int>(command.layer)]++;
+
+        // Shapes change the draw colour, so each one is a batch of its own.
+        if (previous == nullptr || command.type != previous->type || command.sprite != previous->sprite ||
+            command.type == Type::Rects || command.type == Type::Line)
+        {
+            statistics.batches++;
+        }
+        previous = &command;
+    }
+}
+
+/**
+* This method draws the commands on the layers from first up to, but not including,
+* end, in the order worked out by sort. Rotated sprites are drawn from the rotation
+* cache when one is given and it can.
+*/
+void RenderSnapshot::submit(SDL_Renderer* renderer, RotationCache* rotation_cache, const Layer first, const Layer end) const
+{
+    // The keys are sorted by layer first, so the layers asked for are one run of them.
+    auto begin_key = std::lower_bound(order.begin(), order.end(), static_cast<std::uint64_t>(first) << 56);
+    auto end_key = std::lower_bound(begin_key, order.end(), static_cast<std::uint64_t>(end) << 56);
+    for (auto key = begin_key; key != end_key; ++key)
+    {
+        const Command& command = commands[*key & 0xFFFFFFFF];
+        switch (command.type)
+        {
+        case Type::Sprite:
+            if (command.sprite == NO_SPRITE)
+            {
+                break;
+            }
+
+            // Rotating is slow without a GPU, so sprites that aren't rotated get a plain copy.
+            if (command.angle == 0.0f)
+            {
+                SDL_RenderCopy(renderer, Application::getSprite(command.sprite), nullptr, &command.destination);
+            }
+            else if (rotation_cache == nullptr || !rotation_cache->draw(renderer, command.sprite, command.destination, command.angle))
+            {
+                SDL_RenderCopyEx(renderer, Application::getSprite(command.sprite), nullptr, &command.destination,
+                                 command.angle, nullptr, SDL_FLIP_NONE);
+            }
+            break;
+        case Type::Geometry:
+            if (command.sprite != NO_SPRITE)
+            {
+                SDL_RenderGeometry(renderer, Application::getSprite(command.sprite), vertices.data(), vertices.size(),
+                                   &indices[command.first], command.count);
+            }
+            break;
+        case Type::Rects:
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+            SDL_SetRenderDrawColor(renderer, command.colour.r, command.colour.g, command.colour.b, command.colour.a);
+            SDL_RenderFillRects(renderer, &rects[command.first], command.count);
+            break;
+        case Type::Line:
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+            SDL_SetRenderDrawColor(renderer, command.colour.r, command.colour.g, command.colour.b, command.colour.a);
+            SDL_RenderDrawLine(renderer, command.destination.x, command.destination.y, command.destination.w, command.destination.h);
+            break;
+        }
+    }
+
+    // Shapes change how the renderer draws, so put it back for clearing the next frame.
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+}
+
+/**
+* This method writes the snapshot to a file, along with the name and size of every
+* sprite it uses, so that it can be drawn again without the game. It uses the renderer,
+* so it can only be called on the main thread. It returns false if the file couldn't
+* be written.
+*/
+bool RenderSnapshot::write(const std::string& file_name) const
+{
+    std::vector<std::uint16_t> sprites;
+    for (const Command& command : commands)
+    {
+        if (command.sprite != NO_SPRITE)
+        {
+            sprites.push_back(command.sprite);
+        }
+    }
+    std::sort(sprites.begin(), sprites.end());
+    sprites.erase(std::unique(sprites.begin(), sprites.end()), sprites.end());
+
+    std::ofstream file(file_name, std::ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+
+    Header header;
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.tick = tick;
+    header.viewport = viewport;
+    header.culled = statistics.culled;
+    header.sprite_count = sprites.size();
+    header.command_count = commands.size();
+    header.vertex_count = vertices.size();
+    header.index_count = indices.size();
+    header.rect_count = rects.size();
+    writeValue(file, header);
+
+    // Sprites that weren't loaded from a file, like the map, are written without a name
+    // and have to be made up when the snapshot is read.
+    for (std::uint16_t sprite : sprites)
+    {
+        SDL_Texture* texture = Application::getSprite(sprite);
+        const std::string name = Application::getTextureName(texture);
+        std::int32_t width = 0;
+        std::int32_t height = 0;
+        SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+
+        writeValue(file, sprite);
+        writeValue(file, width);
+        writeValue(file, height);
+        writeValue<std::uint32_t>(file, name.size());
+        file.write(name.data(), name.size());
+    }
+
+    writeArray(file, commands);
+    writeArray(file, vertices);
+    writeArray(file, indices);
+    writeArray(file, rects);
+    return static_cast<bool>(file);
+}
+
+/**
+* This method reads a snapshot written by write. Every sprite in the file is given to
+* getSprite, with its name and size, which returns the sprite id to use for it in this
+* game. The snapshot still has to be sorted before it is drawn. It returns false if the
+* file couldn't be read, leaving the snapshot empty.
+*/
+bool RenderSnapshot::read(const std::string& file_name, const std::function<std::uint16_t(const std::string&, int, int)>& getSprite)
+{
+    clear(0, {0, 0, 0, 0});
+
+    std::ifstream file(file_name, std::ios::binary);
+    Header header;
+    if (!file || !readValue(file, header) || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.sprite_count > MAX_COUNT)
+    {
+        return false;
+    }
+
+    std::vector<std::pair<std::uint16_t, std::uint16_t>> sprites;
+    for (std::uint32_t i = 0; i < header.sprite_count; i++)
+    {
+        std::uint16_t sprite;
+        std::int32_t width, height;
+        std::uint32_t name_length;
+        if (!readValue(file, sprite) || !readValue(file, width) || !readValue(file, height) || !readValue(file, name_length) ||
+            name_length > MAX_STRING)
+        {
+            return false;
+        }
+        std::string name(name_length, '\0');
+        if (!file.read(&name[0], name_length))
+        {
+            return false;
+        }
+        sprites.emplace_back(sprite, getSprite(name, width, height));
+    }
+
+    if (!readArray(file, commands, header.command_count) || !readArray(file, vertices, header.vertex_count) ||
+        !readArray(file, indices, header.index_count) || !readArray(file, rects, header.rect_count))
+    {
+        clear(0, {0, 0, 0, 0});
+        return false;
+    }
+
+    // Give every command this game's id for its sprite, and check that nothing it points
+    // to is outside of the arrays.
+    for (Command& command : commands)
+    {
+        auto sprite = std::find_if(sprites.begin(), sprites.end(), [&](const auto& ids) { return ids.first == command.sprite; });
+        command.sprite = sprite != sprites.end() ? sprite->second : NO_SPRITE;
+
+        const std::size_t size = command.type == Type::Geometry ? indices.size() : rects.size();
+        const bool has_range = command.type == Type::Geometry || command.type == Type::Rects;
+        if (command.type > Type::Line || command.layer >= Layer::Count ||
+            (has_range && (command.first > size || command.count > size - command.first)))
+        {
+            clear(0, {0, 0, 0, 0});
+            return false;
+        }
+    }
+    for (int index : indices)
+    {
+        if (index < 0 || static_cast<std::size_t>(index) >= vertices.size())
+        {
+            clear(0, {0, 0, 0, 0});
+            return false;
+        }
+    }
+
+    tick = header.tick;
+    viewport = header.viewport;
+    statistics.culled = header.culled;
+    return true;
+}
+
+/**
+* This method returns the tick of the game the snapshot was recorded on.
+*/
+std::uint64_t RenderSnapshot::getTick() const
+{
+    return tick;
+}
+
+/**
+* This method returns the part of the screen the snapshot was recorded for.
+*/
+const SDL_Rect& RenderSnapshot::getViewport() const
+{
+    return viewport;
+}
+
+/**
+* This method returns the resolution the world layers should be drawn at.
+*/
+float RenderSnapshot::getScale() const
+{
+    return scale;
+}
+
+/**
+* This method sets when the input the snapshot shows arrived, as SDL ticks, so that the
+* time until it is presented can be measured. The input time is when the oldest input
+* event the frame handled arrived, and the aim time is when the mouse position the
+* frame was drawn with was read. Either is 0 if there is nothing to measure.
+*/
+void RenderSnapshot::setInputTimes(const std::uint32_t input_time, const std::uint32_t aim_time)
+{
+    this->input_time = input_time;
+    this->aim_time = aim_time;
+}
+
+/**
+* This method returns when the oldest input event the frame handled arrived.
+*/
+std::uint32_t RenderSnapshot::getInputTime() const
+{
+    return input_time;
+}
+
+/**
+* This method returns when the mouse position the frame was drawn with was read.
+*/
+std::uint32_t RenderSnapshot::getAimTime() const
+{
+    return aim_time;
+}
+
+/**
+* This method returns the statistics worked out by sort.
+*/
+const RenderSnapshot::Statistics& RenderSnapshot::getStatistics() const
+{
+    return statistics;
+}
+
+/**
+* This function returns the name of a layer.
+*/
+const char* RenderSnapshot::getLayerName(const Layer layer)
+{
+    return LAYER_NAMES[static_cast<int>(layer)];
+}
@@ -0,0 +1,563 @@
+#include "Replay.h"
+#include "Application.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+/**
+* This namespace records the input the game uses and plays it back. A replay holds every
+* event the game state is given, with the tick it happened on, along with everything else
+* needed to play the same game again: the random seed, the level, the window size and the
+* fixed time step the game was recorded with. Playing a replay back as fast as possible is
+* a timedemo, which times every frame and checks that the game ended up in exactly the
+* same state as when it was recorded.
+*/
+namespace Replay
+{
+    /**
+    * This anonymous namespace holds the replay being recorded or played back and the
+    * helpers that encode events. Events are stored back to back, each one as the number
+    * of ticks since the event before it, its kind and then only the fields the game reads.
+    * Numbers are stored as variable length integers so that most of them take one byte.
+    */
+    namespace
+    {
+        /**
+        * This is the header at the start of every replay file. The level's file name comes
+        * straight after it, then the events. Everything is stored in the byte order of the
+        * machine that recorded the replay.
+        */
+        struct Header
+        {
+            char magic[4];
+            std::uint32_t version;
+            std::uint32_t seed;
+            float delta_time;
+            std::int32_t window_width;
+            std::int32_t window_height;
+            std::uint32_t tick_count;
+            std::uint32_t event_count;
+            std::uint64_t state_hash;
+            std::uint32_t level_length;
+            std::uint32_t events_length;
+        };
+
+        /**
+        * This enum contains every kind of event that is stored in a replay.
+        */
+        enum class Kind : std::uint8_t
+        {
+            Quit,
+            KeyDown,
+            KeyUp,
+            MouseMotion,
+            MouseButtonDown,
+            MouseButtonUp,
+            MouseWheel,
+            Count
+        };
+
+        bool recording = false;
+        bool playing = false;
+        std::string file_name;
+        Header header;
+        std::string level;
+        std::vector<std::uint8_t> events;
+
+        std::uint32_t tick = 0;
+        std::uint32_t last_event_tick = 0;
+
+        // Playback only.
+        std::size_t read_position = 0;
+        std::uint32_t events_read = 0;
+        bool event_pending = false;
+        bool read_failed = false;
+        std::uint64_t played_hash = 0;
+        bool played_to_end = false;
+        std::vector<float> work_times;
+        std::chrono::steady_clock::time_point start_time;
+        std::chrono::steady_clock::time_point end_time;
+        bool timing = false;
+
+        void writeVarint(std::uint32_t value)
+        {
+            while (value >= 0x80)
+            {
+                events.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            events.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        /**
+        * This function writes a signed number, zigzag encoded so small negative numbers stay small.
+        */
+        void writeSigned(const std::int32_t value)
+        {
+            writeVarint((static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31));
+        }
+
+        std::uint8_t readByte()
+        {
+            if (read_position >= events.size())
+            {
+                read_failed = true;
+                return 0;
+            }
+            return events[read_position++];
+        }
+
+        std::uint32_t readVarint()
+        {
+            std::uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7)
+            {
+                const std::uint8_t byte = readByte();
+                value |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    return value;
+                }
+            }
+            read_failed = true;
+            return value;
+        }
+
+        std::int32_t readSigned()
+        {
+            const std::uint32_t value = readVarint();
+            return static_cast<std::int32_t>((value >> 1) ^ (~(value & 1) + 1));
+        }
+
+        /**
+        * This function reads an event's kind and fields into an SDL_Event.
+        */
+        void readEvent(SDL_Event& event)
+        {
+            std::memset(&event, 0, sizeof(event));
+            const Kind kind = static_cast<Kind>(readByte());
+            switch (kind)
+            {
+            case Kind::Quit:
+                event.type = SDL_QUIT;
+                break;
+            case Kind::KeyDown:
+            case Kind::KeyUp:
+                event.type = kind == Kind::KeyDown ? SDL_KEYDOWN : SDL_KEYUP;
+                event.key.state = kind == Kind::KeyDown ? SDL_PRESSED : SDL_RELEASED;
+                event.key.keysym.sym = static_cast<SDL_Keycode>(readVarint());
+                event.key.repeat = readByte();
+                break;
+            case Kind::MouseMotion:
+                event.type = SDL_MOUSEMOTION;
+                event.motion.x = readSigned();
+                event.motion.y = readSigned();
+                break;
+            case Kind::MouseButtonDown:
+            case Kind::MouseButtonUp:
+                event.type = kind == Kind::MouseButtonDown ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+                event.button.state = kind == Kind::MouseButtonDown ? SDL_PRESSED : SDL_RELEASED;
+                event.button.button = readByte();
+                event.button.x = readSigned();
+                event.button.y = readSigned();
+                break;
+            case Kind::MouseWheel:
+                event.type = SDL_MOUSEWHEEL;
+                event.wheel.x = readSigned();
+                event.wheel.y = readSigned();
+                break;
+            default:
+                read_failed = true;
+                break;
+            }
+        }
+
+        /**
+        * This function reads how many ticks there are until the next event, if there is one.
+        */
+        void readNextTick()
+        {
+            event_pending = events_read < header.event_count && read_position < events.size();
+            if (event_pending)
+            {
+                last_event_tick += readVarint();
+            }
+        }
+
+        /**
+        * This function reports a replay file that can't be played.
+        */
+        [[noreturn]] void throwReplayError(const std::string& message)
+        {
+            SDL_SetError("%s: %s", file_name.c_str(), message.c_str());
+            throw Application::Error::Level;
+        }
+
+        /**
+        * This function returns a percentile, from 0 to 1, of some sorted times.
+        */
+        float getPercentile(const std::vector<float>& sorted_times, const float percentile)
+        {
+            if (sorted_times.empty())
+            {
+                return 0.0;
+            }
+            int index = std::ceil(percentile * sorted_times.size()) - 1;
+            return sorted_times[std::max(0, std::min(index, static_cast<int>(sorted_times.size()) - 1))];
+        }
+    }
+
+    /**
+    * This function starts recording. Events are kept in memory until stopRecording is called.
+    * The game must be run with the given seed and fixed time step while it is recorded.
+    */
+    void startRecording(const std::string& file_name, const std::uint32_t seed, const float delta_time,
+                        const int window_width, const int window_height)
+    {
+        Replay::file_name = file_name;
+        header = Header();
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.seed = seed;
+        header.delta_time = delta_time;
+        header.window_width = window_width;
+        header.window_height = window_height;
+
+        level.clear();
+        events.clear();
+        tick = 0;
+        last_event_tick = 0;
+        recording = true;
+        playing = false;
+
+        LOG_INFO(General, "Recording replay to: " << file_name << " (seed " << seed << ")");
+    }
+
+    /**
+    * This function writes the recording to its file and stops recording. It does nothing
+    * if nothing is being recorded.
+    */
+    void stopRecording()
+    {
+        if (!recording)
+        {
+            return;
+        }
+        recording = false;
+
+        header.tick_count = tick;
+        header.level_length = level.size();
+        header.events_length = events.size();
+
+        std::ofstream file(file_name, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(level.data(), level.size());
+        file.write(reinterpret_cast<const char*>(events.data()), events.size());
+        if (!file)
+        {
+            SDL_SetError("Unable to write replay: %s", file_name.c_str());
+            throw Application::Error::Level;
+        }
+
+        LOG_INFO(General, "Wrote replay: " << file_name << " (" << header.tick_count << " ticks, " << header.event_count
+                 << " events, " << events.size() << " bytes of events)");
+    }
+
+    /**
+    * This function returns whether or not a replay is being recorded.
+    */
+    bool isRecording()
+    {
+        return recording;
+    }
+
+    /**
+    * This function loads a replay and starts playing it back. An error is thrown if the
+    * file can't be read or isn't a replay from this version of the game. Every event is
+    * read once up front, so that a broken replay is found before anything is played.
+    */
+    void startPlayback(const std::string& file_name)
+    {
+        Replay::file_name = file_name;
+        std::ifstream file(file_name, std::ios::binary);
+        if (!file)
+        {
+            throwReplayError("unable to open replay");
+        }
+
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION)
+        {
+            throwReplayError("not a version " + std::to_string(VERSION) + " replay");
+        }
+        if (header.delta_time <= 0.0 || header.window_width <= 0 || header.window_height <= 0)
+        {
+            throwReplayError("the replay's time step or window size is invalid");
+        }
+
+        level.resize(header.level_length);
+        events.resize(header.events_length);
+        if (!file.read(&level[0], level.size()) || !file.read(reinterpret_cast<char*>(events.data()), events.size()))
+        {
+            throwReplayError("the replay is truncated");
+        }
+
+        // Check that every event can be read.
+        SDL_Event event;
+        read_position = 0;
+        read_failed = false;
+        for (std::uint32_t i = 0; i < header.event_count && !read_failed; i++)
+        {
+            readVarint();
+            readEvent(event);
+        }
+        if (read_failed || read_position != events.size())
+        {
+            throwReplayError("the replay's events are corrupt");
+        }
+
+        tick = 0;
+        last_event_tick = 0;
+        read_position = 0;
+        events_read = 0;
+        readNextTick();
+
+        played_hash = 0;
+        played_to_end = false;
+        timing = false;
+        work_times.clear();
+        work_times.reserve(header.tick_count);
+        playing = true;
+        recording = false;
+
+        LOG_INFO(General, "Playing replay: " << file_name << " (" << level << ", seed " << header.seed << ", "
+                 << header.tick_count << " ticks, " << header.event_count << " events)");
+    }
+
+    /**
+    * This function returns whether or not a replay is being played back.
+    */
+    bool isPlaying()
+    {
+        return playing;
+    }
+
+    /**
+    * This function returns whether or not every tick of the replay has been played.
+    */
+    bool isFinished()
+    {
+        return playing && tick >= header.tick_count;
+    }
+
+    /**
+    * These functions return what the replay being played back was recorded with.
+    */
+    std::uint32_t getSeed()
+    {
+        return header.seed;
+    }
+
+    float getDeltaTime()
+    {
+        return header.delta_time;
+    }
+
+    SDL_Point getWindowSize()
+    {
+        return {header.window_width, header.window_height};
+    }
+
+    const std::string& getLevel()
+    {
+        return level;
+    }
+
+    /**
+    * This function sets the level the recording starts on.
+    */
+    void setLevel(const std::string& level_file)
+    {
+        level = level_file;
+    }
+
+    /**
+    * This function records an event on the current tick. Events the game doesn't use,
+    * such as window events, are left out.
+    */
+    void recordEvent(const SDL_Event& event)
+    {
+        if (!recording)
+        {
+            return;
+        }
+
+        Kind kind;
+        switch (event.type)
+        {
+        case SDL_QUIT:
+            kind = Kind::Quit;
+            break;
+        case SDL_KEYDOWN:
+            kind = Kind::KeyDown;
+            break;
+        case SDL_KEYUP:
+            kind = Kind::KeyUp;
+            break;
+        case SDL_MOUSEMOTION:
+            kind = Kind::MouseMotion;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+            kind = Kind::MouseButtonDown;
+            break;
+        case SDL_MOUSEBUTTONUP:
+            kind = Kind::MouseButtonUp;
+            break;
+        case SDL_MOUSEWHEEL:
+            kind = Kind::MouseWheel;
+            break;
+        default:
+            return;
+        }
+
+        writeVarint(tick - last_event_tick);
+        last_event_tick = tick;
+        events.push_back(static_cast<std::uint8_t>(kind));
+
+        switch (kind)
+        {
+        case Kind::KeyDown:
+        case Kind::KeyUp:
+            writeVarint(static_cast<std::uint32_t>(event.key.keysym.sym));
+            events.push_back(event.key.repeat);
+            break;
+        case Kind::MouseMotion:
+            writeSigned(event.motion.x);
+            writeSigned(event.motion.y);
+            break;
+        case Kind::MouseButtonDown:
+        case Kind::MouseButtonUp:
+            events.push_back(event.button.button);
+            writeSigned(event.button.x);
+            writeSigned(event.button.y);
+            break;
+        case Kind::MouseWheel:
+            writeSigned(event.wheel.x);
+            writeSigned(event.wheel.y);
+            break;
+        default:
+            break;
+        }
+        header.event_count++;
+    }
+
+    /**
+    * This function gets the next event from the replay that happened on the current tick.
+    * It returns false once there are no more events on this tick.
+    */
+    bool pollEvent(SDL_Event& event)
+    {
+        if (playing && !timing)
+        {
+            // The clock starts on the first frame, so loading isn't counted.
+            start_time = std::chrono::steady_clock::now();
+            timing = true;
+        }
+
+        if (!playing || !event_pending || last_event_tick != tick)
+        {
+            return false;
+        }
+
+        readEvent(event);
+        events_read++;
+        readNextTick();
+        return true;
+    }
+
+    /**
+    * This function moves on to the next tick. While playing back, the time the frame took
+    * to work out, in microseconds, is kept for the report.
+    */
+    void endFrame(const float work_time)
+    {
+        if (recording)
+        {
+            tick++;
+        }
+        else if (playing && tick < header.tick_count)
+        {
+            work_times.push_back(work_time / 1000.0);
+            tick++;
+            end_time = std::chrono::steady_clock::now();
+        }
+    }
+
+    /**
+    * This function sets the hash of the state the game finished in. When recording it is
+    * stored in the replay, and when playing back it is checked against the stored hash.
+    */
+    void finish(const std::uint64_t state_hash)
+    {
+        if (recording)
+        {
+            header.state_hash = state_hash;
+        }
+        else if (playing)
+        {
+            played_hash = state_hash;
+            played_to_end = tick == header.tick_count;
+        }
+    }
+
+    /**
+    * This function returns whether or not the replay that was played back finished every
+    * tick in the same state it was recorded in.
+    */
+    bool hasMatched()
+    {
+        return played_to_end && played_hash == header.state_hash;
+    }
+
+    /**
+    * This function writes how long the replay took to play back, the frame time
+    * percentiles and whether or not the final state matched.
+    */
+    void writeReport(std::ostream& stream)
+    {
+        const double total_time = timing ? std::chrono::duration<double>(end_time - start_time).count() : 0.0;
+        const float mean = work_times.empty() ? 0.0 : std::accumulate(work_times.begin(), work_times.end(), 0.0f) / work_times.size();
+
+        std::vector<float> sorted_times = work_times;
+        std::sort(sorted_times.begin(), sorted_times.end());
+
+        char hash_text[64];
+        std::snprintf(hash_text, sizeof(hash_text), "%016llx", static_cast<unsigned long long>(played_hash));
+
+        stream << "Timedemo: " << file_name << " (" << level << ", seed " << header.seed << ", " << header.tick_count
+               << " ticks at " << header.delta_time * 1000.0 << " ms)" << std::endl;
+        stream << "Total time: " << total_time << " s (" << (total_time > 0.0 ? tick / total_time : 0.0) << " ticks per second)" << std::endl;
+        stream << "Frame time: " << mean << " ms mean, " << getPercentile(sorted_times, 0.5) << " ms p50, "
+               << getPercentile(sorted_times, 0.95) << " ms p95, " << getPercentile(sorted_times, 0.99) << " ms p99, "
+               << (sorted_times.empty() ? 0.0 : sorted_times.back()) << " ms max" << std::endl;
+
+        if (!played_to_end)
+        {
+            stream << "Final state: " << hash_text << ", stopped after " << tick << " of " << header.tick_count << " ticks" << std::endl;
+        }
+        else if (hasMatched())
+        {
+            stream << "Final state: " << hash_text << ", matches the recording" << std::endl;
+        }
+        else
+        {
+            std::snprintf(hash_text + 16, sizeof(hash_text) - 16, ", expected %016llx", static_cast<unsigned long long>(header.state_hash));
+            stream << "Final state: " << hash_text << ", DOES NOT match the recording" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#include "ResolutionScaler.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+* This method sets the scales the resolution can be between and the budget, in
+* milliseconds, that frames are kept under. A budget of 0 keeps the scale at max_scale.
+*/
+void ResolutionScaler::setup(const float max_scale, const float min_scale, const float budget)
+{
+    this->max_scale = std::min(std::max(max_scale, STEP), 1.0f);
+    this->min_scale = std::min(std::max(min_scale, STEP), this->max_scale);
+    this->budget = std::max(budget, 0.0f);
+    scale = this->max_scale;
+    average_time = 0.0;
+    settle_frames = SETTLE_FRAMES;
+}
+
+/**
+* This method records how long the last frame took, in milliseconds, and changes the
+* scale if it needs to.
+*/
+void ResolutionScaler::addFrame(const float frame_time)
+{
+    if (budget <= 0.0)
+    {
+        return;
+    }
+
+    average_time += (frame_time - average_time) * SMOOTHING;
+    if (settle_frames > 0)
+    {
+        settle_frames--;
+        return;
+    }
+
+    float new_scale = scale;
+    if (average_time > budget)
+    {
+        // Drop by at least a step, to where the number of pixels would fit the budget.
+        new_scale = std::min(scale * std::sqrt(budget / average_time), scale - STEP);
+        new_scale = std::floor((new_scale / STEP) + 0.001f) * STEP;
+    }
+    else if (average_time < budget * RAISE_THRESHOLD)
+    {
+        new_scale = std::round((scale + STEP) / STEP) * STEP;
+    }
+
+    new_scale = std::min(std::max(new_scale, min_scale), max_scale);
+    if (new_scale != scale)
+    {
+        scale = new_scale;
+        settle_frames = SETTLE_FRAMES;
+    }
+}
+
+/**
+* This method returns the scale the next frame should be drawn at.
+*/
+float ResolutionScaler::getScale() const
+{
+    return scale;
+}
+
+/**
+* This method returns the budget, in milliseconds, or 0 if the scale never changes.
+*/
+float ResolutionScaler::getBudget() const
+{
+    return budget;
+}
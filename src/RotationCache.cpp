@@ -0,0 +1,156 @@
+#include "RotationCache.h"
+#include "Application.h"
+
+#include <algorithm>
+#include <cmath>
+
+/**
+* The angle count is how many rotations each sprite is rendered at, and max_bytes is
+* roughly how much video memory all of the atlases can take.
+*/
+RotationCache::RotationCache(const int angle_count, const std::int64_t max_bytes)
+    : angle_count(std::max(angle_count, 1)), max_bytes(max_bytes)
+{
+    columns = std::ceil(std::sqrt(static_cast<float>(this->angle_count)));
+    rows = (this->angle_count + columns - 1) / columns;
+}
+
+RotationCache::~RotationCache()
+{
+    for (Entry& entry : entries)
+    {
+        destroyAtlas(entry);
+    }
+}
+
+/**
+* This method draws a sprite rotated about its centre by an angle in degrees clockwise,
+* rounded to the nearest angle in the cache. It returns false, without drawing anything,
+* if the sprite can't be cached.
+*/
+bool RotationCache::draw(SDL_Renderer* renderer, const std::uint16_t sprite, const SDL_Rect& destination, const float angle)
+{
+    SDL_Texture* texture = Application::getSprite(sprite);
+    auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry)
+    {
+        return entry.sprite == sprite && entry.width == destination.w && entry.height == destination.h;
+    });
+
+    if (entry == entries.end())
+    {
+        entries.push_back({sprite, texture, destination.w, destination.h, 0, nullptr});
+        entry = entries.end() - 1;
+        createAtlas(renderer, *entry);
+    }
+    else if (entry->texture != texture)
+    {
+        // The sprite id has been given to another texture since the atlas was made.
+        destroyAtlas(*entry);
+        entry->texture = texture;
+        createAtlas(renderer, *entry);
+    }
+
+    if (entry->atlas == nullptr)
+    {
+        return false;
+    }
+
+    int index = static_cast<int>(std::lround(angle * angle_count / 360.0f)) % angle_count;
+    if (index < 0)
+    {
+        index += angle_count;
+    }
+
+    // The sprite sits in the middle of its cell, so the cell is drawn around the destination.
+    const SDL_Rect source = {(index % columns) * entry->cell_size, (index / columns) * entry->cell_size, entry->cell_size, entry->cell_size};
+    const SDL_Rect cell = {destination.x - ((entry->cell_size - destination.w) / 2), destination.y - ((entry->cell_size - destination.h) / 2),
+                           entry->cell_size, entry->cell_size};
+    SDL_RenderCopy(renderer, entry->atlas, &source, &cell);
+    return true;
+}
+
+/**
+* This method returns how many bytes of video memory the atlases take.
+*/
+std::int64_t RotationCache::getBytes() const
+{
+    return bytes;
+}
+
+/**
+* This method renders every rotation of a sprite into a new atlas.
+*/
+void RotationCache::createAtlas(SDL_Renderer* renderer, Entry& entry)
+{
+    // A cell has to fit the sprite's diagonal, with a pixel spare on each side so that
+    // filtering doesn't pick up the next cell.
+    entry.cell_size = std::ceil(std::sqrt(static_cast<float>((entry.width * entry.width) + (entry.height * entry.height)))) + 2;
+    const std::int64_t atlas_bytes = getAtlasBytes(entry.cell_size);
+    if (entry.texture == nullptr || entry.width <= 0 || entry.height <= 0 || entry.cell_size > MAX_CELL_SIZE ||
+        bytes + atlas_bytes > max_bytes)
+    {
+        return;
+    }
+
+    entry.atlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, columns * entry.cell_size, rows * entry.cell_size);
+    if (entry.atlas == nullptr)
+    {
+        LOG_WARNING(Resource, "Unable to create a rotation atlas, the sprite will be rotated as it is drawn: " << SDL_GetError());
+        return;
+    }
+    SDL_SetTextureBlendMode(entry.atlas, SDL_BLENDMODE_BLEND);
+    bytes += atlas_bytes;
+    Memory::addExternal(Memory::Tag::Texture, atlas_bytes);
+
+    // The atlas is made part way through drawing a frame, so everything the renderer was
+    // set to is put back afterwards.
+    SDL_Texture* target = SDL_GetRenderTarget(renderer);
+    float scale_x, scale_y;
+    SDL_RenderGetScale(renderer, &scale_x, &scale_y);
+    Uint8 red, green, blue, alpha;
+    SDL_GetRenderDrawColor(renderer, &red, &green, &blue, &alpha);
+    SDL_BlendMode blend_mode;
+    SDL_GetTextureBlendMode(entry.texture, &blend_mode);
+
+    SDL_SetRenderTarget(renderer, entry.atlas);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    // Copy the sprite's pixels as they are, rather than blending them onto the empty atlas,
+    // so that they blend the same way as the sprite when the atlas is drawn.
+    SDL_SetTextureBlendMode(entry.texture, SDL_BLENDMODE_NONE);
+    for (int i = 0; i < angle_count; i++)
+    {
+        const SDL_Rect destination = {((i % columns) * entry.cell_size) + ((entry.cell_size - entry.width) / 2),
+                                      ((i / columns) * entry.cell_size) + ((entry.cell_size - entry.height) / 2), entry.width, entry.height};
+        SDL_RenderCopyEx(renderer, entry.texture, nullptr, &destination, i * 360.0 / angle_count, nullptr, SDL_FLIP_NONE);
+    }
+
+    SDL_SetTextureBlendMode(entry.texture, blend_mode);
+    SDL_SetRenderTarget(renderer, target);
+    SDL_RenderSetScale(renderer, scale_x, scale_y);
+    SDL_SetRenderDrawColor(renderer, red, green, blue, alpha);
+}
+
+/**
+* This method returns how many bytes an atlas with a cell size takes.
+*/
+std::int64_t RotationCache::getAtlasBytes(const int cell_size) const
+{
+    return static_cast<std::int64_t>(columns) * rows * cell_size * cell_size * 4;
+}
+
+/**
+* This method destroys an entry's atlas.
+*/
+void RotationCache::destroyAtlas(Entry& entry)
+{
+    if (entry.atlas != nullptr)
+    {
+        const std::int64_t atlas_bytes = getAtlasBytes(entry.cell_size);
+        bytes -= atlas_bytes;
+        Memory::addExternal(Memory::Tag::Texture, -atlas_bytes);
+        SDL_DestroyTexture(entry.atlas);
+        entry.atlas = nullptr;
+    }
+}
@@ -0,0 +1,195 @@
+#include "StressState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+StressState::StressState(const Settings& settings) : settings(settings)
+{
+}
+
+/**
+* This method generates every level up front, so that generating them isn't timed, and
+* starts playing the first one.
+*/
+void StressState::startUp()
+{
+    std::vector<std::string> level_sequence;
+    for (const int size : settings.sizes)
+    {
+        for (const int enemies : settings.enemy_counts)
+        {
+            Scenario scenario;
+            scenario.size = size;
+            scenario.enemies = enemies;
+            scenario.file_name = "stress_" + std::to_string(size) + "_" + std::to_string(enemies) + ".lvl";
+            LevelGenerator::write(scenario.file_name, getLevelSettings(scenario));
+
+            scenarios.push_back(scenario);
+            level_sequence.push_back(scenario.file_name);
+        }
+    }
+
+    if (scenarios.empty())
+    {
+        SDL_SetError("The stress run has no levels to play");
+        throw Application::Error::Level;
+    }
+
+    report.open(REPORT_FILE);
+    report << "size,enemies,frames,mean_frame_ms,mean_work_ms,p50_work_ms,p95_work_ms,p99_work_ms,max_work_ms,mean_update_ms,mean_draw_ms\n";
+
+    frame_times.reserve(settings.frames);
+    work_times.reserve(settings.frames);
+    update_times.reserve(settings.frames);
+    draw_times.reserve(settings.frames);
+
+    game = std::make_unique<GameState>(level_sequence);
+    game->startUp();
+
+    LOG_INFO(Diagnostics, "Stress run started: " << scenarios.size() << " levels, " << settings.frames << " frames each");
+}
+
+/**
+* This method ignores every input except for quitting, so that every run plays out the same.
+*/
+void StressState::handleEvents()
+{
+    for (const SDL_Event& event : Application::getInput().getEvents())
+    {
+        if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE)
+        {
+            Application::quit();
+        }
+    }
+}
+
+void StressState::update()
+{
+    game->update();
+
+    // The timings are for the frame before this one, which was played on the same level
+    // unless this is the first frame.
+    frame++;
+    if (frame > settings.warmup_frames)
+    {
+        const Application::FrameTimings& timings = Application::getFrameTimings();
+        frame_times.push_back(timings.frame / 1000.0);
+        work_times.push_back((timings.events + timings.update + timings.draw + timings.present) / 1000.0);
+        update_times.push_back(timings.update / 1000.0);
+        draw_times.push_back(timings.draw / 1000.0);
+    }
+
+    if (frame >= settings.warmup_frames + settings.frames)
+    {
+        finishScenario();
+    }
+}
+
+void StressState::draw()
+{
+    game->draw();
+}
+
+/**
+* This method stops the game and deletes the levels that were generated for the run.
+*/
+void StressState::shutDown()
+{
+    if (game)
+    {
+        game->shutDown();
+        game.reset();
+    }
+
+    for (const auto& scenario : scenarios)
+    {
+        if (std::remove(scenario.file_name.c_str()) != 0)
+        {
+            LOG_WARNING(Diagnostics, "Unable to delete stress level: " << scenario.file_name);
+        }
+    }
+    scenarios.clear();
+}
+
+/**
+* This method works out the settings used to generate the level for a scenario. There is
+* roughly one room for every 512 tiles, and half of the enemies are zombies.
+*/
+LevelGenerator::Settings StressState::getLevelSettings(const Scenario& scenario) const
+{
+    LevelGenerator::Settings level_settings;
+    level_settings.title = "Stress " + std::to_string(scenario.size) + "x" + std::to_string(scenario.size) + ", " +
+                           std::to_string(scenario.enemies) + " enemies";
+    level_settings.width = scenario.size;
+    level_settings.height = scenario.size;
+    level_settings.seed = settings.seed;
+    level_settings.room_count = std::max(1, (scenario.size * scenario.size) / 512);
+    level_settings.pickup_density = 0.01;
+
+    level_settings.zombies = scenario.enemies / 2;
+    level_settings.demons = scenario.enemies / 4;
+    level_settings.hounds = scenario.enemies / 5;
+    level_settings.bosses = scenario.enemies - level_settings.zombies - level_settings.demons - level_settings.hounds;
+    return level_settings;
+}
+
+/**
+* This method reports the results of the current scenario and moves on to the next,
+* or quits if it was the last one.
+*/
+void StressState::finishScenario()
+{
+    const Scenario& scenario = scenarios[scenario_index];
+    const float count = std::max<std::size_t>(work_times.size(), 1);
+
+    const float mean_frame = std::accumulate(frame_times.begin(), frame_times.end(), 0.0f) / count;
+    const float mean_work = std::accumulate(work_times.begin(), work_times.end(), 0.0f) / count;
+    const float mean_update = std::accumulate(update_times.begin(), update_times.end(), 0.0f) / count;
+    const float mean_draw = std::accumulate(draw_times.begin(), draw_times.end(), 0.0f) / count;
+
+    std::sort(work_times.begin(), work_times.end());
+    const float p50 = getPercentile(work_times, 0.5);
+    const float p95 = getPercentile(work_times, 0.95);
+    const float p99 = getPercentile(work_times, 0.99);
+    const float max = work_times.empty() ? 0.0 : work_times.back();
+
+    report << scenario.size << "," << scenario.enemies << "," << work_times.size() << "," << mean_frame << "," << mean_work << ","
+           << p50 << "," << p95 << "," << p99 << "," << max << "," << mean_update << "," << mean_draw << "\n";
+    report.flush();
+
+    LOG_INFO(Diagnostics, "Stress " << scenario.size << "x" << scenario.size << ", " << scenario.enemies << " enemies: "
+             << mean_work << " ms mean, " << p50 << " ms p50, " << p95 << " ms p95, " << p99 << " ms p99, " << max << " ms max ("
+             << mean_update << " ms update, " << mean_draw << " ms draw)");
+
+    frame = 0;
+    frame_times.clear();
+    work_times.clear();
+    update_times.clear();
+    draw_times.clear();
+
+    scenario_index++;
+    if (scenario_index == scenarios.size())
+    {
+        LOG_INFO(Diagnostics, "Stress run finished, results written to: " << REPORT_FILE);
+        Application::quit();
+    }
+    else
+    {
+        game->changeLevel(scenario_index);
+    }
+}
+
+/**
+* This method returns a percentile, from 0 to 1, of some sorted times.
+*/
+float StressState::getPercentile(const std::vector<float>& sorted_times, const float percentile)
+{
+    if (sorted_times.empty())
+    {
+        return 0.0;
+    }
+    int index = std::ceil(percentile * sorted_times.size()) - 1;
+    return sorted_times[std::max(0, std::min(index, static_cast<int>(sorted_times.size()) - 1))];
+}
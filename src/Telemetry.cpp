@@ -0,0 +1,182 @@
+#include "Telemetry.h"
+#include "SPSCQueue.h"
+#include "Memory.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+
+/**
+* This namespace counts how much work the game does each frame, such as how many collision
+* tests were made or how many projectiles were spawned. Every frame the counts are pushed
+* onto a lock-free queue as a row, and a writer thread writes the rows to a CSV file, so
+* the game never waits on the file. Counters can only be added to from the thread the game
+* is updated on. Counter::Allocations is taken from Memory, which counts allocations on
+* every thread.
+*/
+namespace Telemetry
+{
+    /**
+    * This anonymous namespace holds the counters, the queue of rows and the writer thread.
+    */
+    namespace
+    {
+        const int COUNTER_COUNT = static_cast<int>(Counter::Count);
+        const std::size_t QUEUE_SIZE = 1024;
+
+        const char* COUNTER_NAMES[COUNTER_COUNT] = {
+            "collision_tests",
+            "line_of_sight_rays",
+            "bfs_nodes",
+            "projectiles_spawned",
+            "projectiles_culled",
+            "draw_calls",
+            "texture_loads",
+            "allocations"
+        };
+
+        /**
+        * This struct is a single row of the CSV file.
+        */
+        struct Row
+        {
+            std::uint64_t frame;
+            float frame_time;
+            std::uint32_t counters[COUNTER_COUNT];
+        };
+
+        std::uint32_t counters[COUNTER_COUNT] = {};
+        std::uint32_t last_frame_counters[COUNTER_COUNT] = {};
+        std::uint64_t frame_number = 0;
+        std::uint64_t dropped_rows = 0;
+
+        SPSCQueue<Row, QUEUE_SIZE> queue;
+        std::thread writer;
+        std::atomic<bool> writing{false};
+
+        /**
+        * This function runs on the writer thread. It writes rows as they are queued until
+        * it is stopped, then writes any that are left.
+        */
+        void writeRows(std::ofstream file)
+        {
+            Row row;
+            while (true)
+            {
+                bool stopping = !writing.load(std::memory_order_acquire);
+                bool wrote = false;
+                while (queue.pop(row))
+                {
+                    file << row.frame << "," << row.frame_time;
+                    for (int i = 0; i < COUNTER_COUNT; i++)
+                    {
+                        file << "," << row.counters[i];
+                    }
+                    file << "\n";
+                    wrote = true;
+                }
+
+                if (stopping)
+                {
+                    break;
+                }
+                if (!wrote)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            }
+        }
+    }
+
+    /**
+    * This function returns the name of a counter, as used in the CSV header.
+    */
+    const char* getName(const Counter counter)
+    {
+        return COUNTER_NAMES[static_cast<int>(counter)];
+    }
+
+    /**
+    * This function adds to a counter for the current frame.
+    */
+    void add(const Counter counter, const std::uint32_t amount)
+    {
+        counters[static_cast<int>(counter)] += amount;
+    }
+
+    /**
+    * This function returns the value of a counter in the last complete frame.
+    */
+    std::uint32_t getLastFrame(const Counter counter)
+    {
+        return last_frame_counters[static_cast<int>(counter)];
+    }
+
+    /**
+    * This function starts the writer thread, which writes every frame after this to a CSV file.
+    */
+    void startUp(const std::string& file_name)
+    {
+        std::ofstream file(file_name);
+        if (!file)
+        {
+            LOG_WARNING(Diagnostics, "Unable to write telemetry: " << file_name);
+            return;
+        }
+
+        file << "frame,frame_time_us";
+        for (int i = 0; i < COUNTER_COUNT; i++)
+        {
+            file << "," << COUNTER_NAMES[i];
+        }
+        file << "\n";
+
+        LOG_INFO(Diagnostics, "Writing telemetry: " << file_name);
+        writing = true;
+        writer = std::thread(writeRows, std::move(file));
+    }
+
+    /**
+    * This function ends the current frame. If the writer thread is running, the frame's
+    * counters are queued to be written. The frame is dropped if the queue is full.
+    */
+    void endFrame(const float frame_time)
+    {
+        counters[static_cast<int>(Counter::Allocations)] = Memory::getFrameAllocations();
+
+        if (writing.load(std::memory_order_relaxed))
+        {
+            Row row;
+            row.frame = frame_number;
+            row.frame_time = frame_time;
+            std::copy(counters, counters + COUNTER_COUNT, row.counters);
+            if (!queue.push(row))
+            {
+                dropped_rows++;
+            }
+        }
+
+        std::copy(counters, counters + COUNTER_COUNT, last_frame_counters);
+        std::fill(counters, counters + COUNTER_COUNT, 0);
+        frame_number++;
+    }
+
+    /**
+    * This function writes every queued frame and stops the writer thread.
+    */
+    void shutDown()
+    {
+        if (writer.joinable())
+        {
+            writing = false;
+            writer.join();
+            if (dropped_rows > 0)
+            {
+                LOG_WARNING(Diagnostics, "Telemetry dropped " << dropped_rows << " frames because the queue was full.");
+            }
+        }
+    }
+}
@@ -1,49 +1,115 @@
 #include "Text.h"
 
+#include <algorithm>
+
 Text::Text(TTF_Font* font, const std::string& text, const int x, const int y, const bool centered, const int width)
 {
-    this->font = font;
+    this->atlas = &Application::getGlyphAtlas(font);
     this->centered = centered;
     this->width = width;
 
-    setText(text);
-
     rect.x = x;
     rect.y = y;
+    setText(text);
+
     if (centered)
     {
         rect.x -= rect.w / 2;
         rect.y -= rect.h / 2;
+        layOut();
     }
 }
 
-void Text::setText(const std::string& text)
+void Text::setText(const std::string_view text)
 {
-    SDL_Surface* text_surface;
-    if (width != 0)
+    // Only lay the text out again if it has actually changed.
+    if (text == this->text && !vertices.empty())
     {
-        text_surface = TTF_RenderText_Blended_Wrapped(font, text.c_str(), {255, 255, 255, 255}, width);
-    }
-    else
-    {
-        text_surface = TTF_RenderText_Blended(font, text.c_str(), {255, 255, 255, 255});
+        return;
     }
+    Memory::TagScope tag_scope(Memory::Tag::Text);
+    this->text.assign(text);
+    layOut();
+}
 
-    if (texture != nullptr)
+void Text::draw()
+{
+    if (!indices.empty())
     {
-        SDL_DestroyTexture(texture);
+        Application::drawGeometry(RenderSnapshot::Layer::Interface, atlas->getTexture(), vertices.data(), vertices.size(), indices.data(), indices.size());
     }
-    texture = SDL_CreateTextureFromSurface(Application::getRenderer(), text_surface);
-    SDL_QueryTexture(texture, nullptr, nullptr, &rect.w, &rect.h);
-    SDL_FreeSurface(text_surface);
 }
 
-void Text::draw()
+/**
+* This method builds a quad for every character of the text from the font's glyph atlas.
+* It is only called when the text changes.
+*/
+void Text::layOut()
 {
-    SDL_RenderCopy(Application::getRenderer(), texture, nullptr, &rect);
+    vertices.clear();
+    indices.clear();
+    rect.w = 0;
+    rect.h = atlas->getLineSkip();
+
+    SDL_Point pen = {0, 0};
+    for (std::size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] == '\n')
+        {
+            pen.x = 0;
+            pen.y += atlas->getLineSkip();
+            continue;
+        }
+
+        // If the text wraps, move the next word down a line if it doesn't fit on this one.
+        if (width != 0 && pen.x != 0 && i > 0 && text[i - 1] == ' ')
+        {
+            int word_width = 0;
+            for (std::size_t j = i; j < text.size() && text[j] != ' ' && text[j] != '\n'; j++)
+            {
+                word_width += atlas->getGlyph(text[j]).advance;
+            }
+            if (pen.x + word_width > width)
+            {
+                pen.x = 0;
+                pen.y += atlas->getLineSkip();
+            }
+        }
+
+        addGlyph(atlas->getGlyph(text[i]), rect.x + pen.x, rect.y + pen.y);
+
+        if (i + 1 < text.size())
+        {
+            pen.x += atlas->getAdvance(text[i], text[i + 1]);
+        }
+        else
+        {
+            pen.x += atlas->getGlyph(text[i]).advance;
+        }
+        rect.w = std::max(rect.w, pen.x);
+        rect.h = std::max(rect.h, pen.y + atlas->getLineSkip());
+    }
 }
 
-Text::~Text()
+/**
+* This method adds the quad for a single glyph.
+*/
+void Text::addGlyph(const GlyphAtlas::Glyph& glyph, const int x, const int y)
 {
-    SDL_DestroyTexture(texture);
+    const float u1 = static_cast<float>(glyph.source.x) / atlas->getWidth();
+    const float v1 = static_cast<float>(glyph.source.y) / atlas->getHeight();
+    const float u2 = static_cast<float>(glyph.source.x + glyph.source.w) / atlas->getWidth();
+    const float v2 = static_cast<float>(glyph.source.y + glyph.source.h) / atlas->getHeight();
+    const float x1 = x;
+    const float y1 = y;
+    const float x2 = x + glyph.source.w;
+    const float y2 = y + glyph.source.h;
+    const SDL_Color colour = {255, 255, 255, 255};
+
+    const int first = vertices.size();
+    vertices.push_back({{x1, y1}, colour, {u1, v1}});
+    vertices.push_back({{x2, y1}, colour, {u2, v1}});
+    vertices.push_back({{x2, y2}, colour, {u2, v2}});
+    vertices.push_back({{x1, y2}, colour, {u1, v2}});
+    indices.insert(indices.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
 }
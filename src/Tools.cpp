@@ -25,42 +25,50 @@ namespace Tools
     }
 
     /**
-    * This function calculates the angle between two points.
+    * This function moves a rect back out of every solid it overlaps along the x axis.
+    * Only the sign of velocity is used, to know which side of a solid the rect came from.
     */
-    int angleBetweenPoints(const int x1, const int y1, const int x2, const int y2)
+    void resolveCollisionsX(SDL_Rect& rect, const float velocity, const SDL_Rect* solids, const std::size_t solid_count)
     {
-        return ((std::atan2(y1 - y2, x1 - x2) * 180.0000) / 3.1416);
-    }
-
-    /**
-    * This function returns a normalized vector.
-    */
-    FloatVector normalizeVector(const SDL_Point& vec)
-    {
-        float length = std::sqrt((vec.x * vec.x) + (vec.y * vec.y));
-        return {static_cast<float>(vec.x) / length, static_cast<float>(vec.y) / length};
-    }
-
-    FloatVector normalizeVector(const FloatVector& vec)
-    {
-        float length = std::sqrt((vec.x * vec.x) + (vec.y * vec.y));
-        return {vec.x / length, vec.y / length};
+        for (std::size_t i = 0; i < solid_count; i++)
+        {
+            if (SDL_HasIntersection(&solids[i], &rect))
+            {
+                // If the rect is moving to the right.
+                if (velocity > 0)
+                {
+                    rect.x = solids[i].x - rect.w;
+                }
+                // If the rect is moving to the left.
+                else if (velocity < 0)
+                {
+                    rect.x = solids[i].x + solids[i].w;
+                }
+            }
+        }
     }
 
     /**
-    * This function returns a random number from a range.
+    * This function moves a rect back out of every solid it overlaps along the y axis.
+    * Only the sign of velocity is used, to know which side of a solid the rect came from.
     */
-    int getRandomInt(const int from, const int to)
+    void resolveCollisionsY(SDL_Rect& rect, const float velocity, const SDL_Rect* solids, const std::size_t solid_count)
     {
-        static std::default_random_engine engine(std::chrono::system_clock::now().time_since_epoch().count());
-        std::uniform_int_distribution<int> dist(from, to);
-        return dist(engine);
-    }
-
-    float getRandomFloat(const float from, const float to)
-    {
-        static std::default_random_engine engine(std::chrono::system_clock::now().time_since_epoch().count());
-        std::uniform_real_distribution<float> dist(from, to);
-        return dist(engine);
+        for (std::size_t i = 0; i < solid_count; i++)
+        {
+            if (SDL_HasIntersection(&solids[i], &rect))
+            {
+                // If the rect is moving down.
+                if (velocity > 0)
+                {
+                    rect.y = solids[i].y - rect.h;
+                }
+                // If the rect is moving up.
+                else if (velocity < 0)
+                {
+                    rect.y = solids[i].y + solids[i].h;
+                }
+            }
+        }
     }
 }
@@ -0,0 +1,596 @@
+#include "Level.h"
+#include "Maths.h"
+#include "Random.h"
+#include "Tools.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <random>
+
+/**
+* This tool times the game's hot paths without opening a window: pathfinding, line of
+* sight, collision, projectile removal and the maths in Tools. Levels are generated from a
+* fixed seed, so every run measures the same work. Each benchmark is run at several sizes
+* and the results are written as JSON, with the time per call and the time per item (such
+* as per tile or per wall) so that it is easy to see how each one scales.
+*
+* Usage: Benchmarks [output.json] [--min-time seconds]
+*
+* If no output file is given, the JSON is written to the console.
+*/
+namespace
+{
+    const std::uint32_t SEED = 12345;
+    const float WALL_DENSITY = 0.2;
+
+    double min_time = 0.2;
+
+    // Results are added to this so that the compiler can't skip the work.
+    volatile std::int64_t sink = 0;
+
+    /**
+    * This struct is the result of running a benchmark at one size.
+    */
+    struct Result
+    {
+        int size;
+        std::uint64_t iterations;
+        double ns_per_op;
+        double ns_per_item;
+    };
+
+    /**
+    * This struct is every result for one benchmark.
+    */
+    struct Benchmark
+    {
+        std::string name;
+        std::string item;
+        std::vector<Result> results;
+    };
+
+    std::vector<Benchmark> benchmarks;
+
+    /**
+    * This function runs a benchmark at one size. The benchmark is given a number of
+    * iterations to run and returns how many nanoseconds they took, so that it can leave
+    * any setup out. The number of iterations is doubled until they take at least min_time.
+    * items_per_op is how many items (such as tiles) a single iteration works on.
+    */
+    void run(const std::string& name, const std::string& item, const int size, const double items_per_op,
+             const std::function<double(std::uint64_t)>& benchmark)
+    {
+        // Warm the caches up before timing anything.
+        benchmark(1);
+
+        std::uint64_t iterations = 1;
+        double elapsed = 0.0;
+        while (true)
+        {
+            elapsed = benchmark(iterations);
+            if (elapsed >= min_time * 1000000000.0 || iterations >= (1ull << 40))
+            {
+                break;
+            }
+            iterations *= 2;
+        }
+
+        Result result;
+        result.size = size;
+        result.iterations = iterations;
+        result.ns_per_op = elapsed / iterations;
+        result.ns_per_item = result.ns_per_op / std::max(items_per_op, 1.0);
+
+        if (benchmarks.empty() || benchmarks.back().name != name)
+        {
+            benchmarks.push_back({name, item, {}});
+        }
+        benchmarks.back().results.push_back(result);
+
+        std::cerr << name << " [" << size << "]: " << result.ns_per_op << " ns/op, "
+                  << result.ns_per_item << " ns/" << item << std::endl;
+    }
+
+    /**
+    * This function returns the nanoseconds between two times.
+    */
+    double getNanoseconds(const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end)
+    {
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    /**
+    * This function generates a square level. The edges are walls, WALL_DENSITY of the
+    * other tiles are walls and the player starts in the middle.
+    */
+    LevelFile::Data generateLevel(const int size, std::mt19937& random)
+    {
+        LevelFile::Data data;
+        data.title = "Benchmark " + std::to_string(size);
+        data.width = size;
+        data.height = size;
+        data.layer_count = 1;
+        data.tile_buffer.assign(static_cast<std::size_t>(size) * size, '1');
+
+        std::uniform_real_distribution<float> chance(0.0, 1.0);
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                if (x == 0 || y == 0 || x == size - 1 || y == size - 1 || chance(random) < WALL_DENSITY)
+                {
+                    data.tile_buffer[(y * size) + x] = '2';
+                }
+            }
+        }
+
+        data.tile_buffer[((size / 2) * size) + (size / 2)] = '1';
+        data.objects.push_back({size / 2, size / 2, 'A'});
+        return data;
+    }
+
+    /**
+    * This function works out everything Level::prepare would for a generated level, except
+    * for the tile images which aren't needed.
+    */
+    std::shared_ptr<const LevelLayout> makeLayout(LevelFile::Data data)
+    {
+        auto layout = std::make_shared<LevelLayout>();
+        layout->file_name = data.title;
+        layout->data = std::move(data);
+
+        Navigation::buildGrid(layout->data, layout->grid);
+        for (const auto& wall : Navigation::mergeWalls(layout->grid))
+        {
+            layout->wall_rects.push_back({wall.x * Level::TILE_SIZE, wall.y * Level::TILE_SIZE,
+                                          wall.w * Level::TILE_SIZE, wall.h * Level::TILE_SIZE});
+        }
+
+        layout->start_tile = {layout->data.width / 2, layout->data.height / 2};
+        Navigation::breadthFirstSearch(layout->grid, layout->start_tile, layout->start_paths);
+        return layout;
+    }
+
+    /**
+    * This function picks random tiles that can be walked on.
+    */
+    std::vector<SDL_Point> getWalkableTiles(const Navigation::Grid& grid, const int count, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> x_distribution(0, grid.width - 1);
+        std::uniform_int_distribution<int> y_distribution(0, grid.height - 1);
+
+        std::vector<SDL_Point> tiles;
+        while (static_cast<int>(tiles.size()) < count)
+        {
+            SDL_Point tile = {x_distribution(random), y_distribution(random)};
+            if (grid.isWalkable(tile.x, tile.y))
+            {
+                tiles.push_back(tile);
+            }
+        }
+        return tiles;
+    }
+
+    /**
+    * This function times a breadth first search over the whole level. The start changes
+    * every time, so the paths cooked from the player's start are never used.
+    */
+    void benchmarkBreadthFirstSearch(const std::vector<int>& sizes)
+    {
+        for (int size : sizes)
+        {
+            std::mt19937 random(SEED);
+            Level level;
+            level.setLayout(makeLayout(generateLevel(size, random)));
+            const std::vector<SDL_Point> starts = getWalkableTiles(level.getLayout()->grid, 16, random);
+
+            run("Level::breadthFirstSearch", "tile", size, size * size, [&](std::uint64_t iterations)
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    level.breadthFirstSearch(starts[i % starts.size()]);
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + level.getBFSTilesReached();
+                return getNanoseconds(start, end);
+            });
+        }
+    }
+
+    /**
+    * This function times building paths back to the start of a search from random tiles.
+    */
+    void benchmarkGetPathToTile(const std::vector<int>& sizes)
+    {
+        for (int size : sizes)
+        {
+            std::mt19937 random(SEED);
+            Level level;
+            level.setLayout(makeLayout(generateLevel(size, random)));
+            const SDL_Point start_tile = getWalkableTiles(level.getLayout()->grid, 1, random)[0];
+            level.breadthFirstSearch(start_tile);
+
+            // Only tiles that can reach the start make a real path.
+            std::vector<SDL_Point> ends;
+            TilePath path;
+            double total_length = 0.0;
+            for (const auto& tile : getWalkableTiles(level.getLayout()->grid, 1024, random))
+            {
+                level.getPathToTile(tile, path);
+                if (path.size() > 2)
+                {
+                    ends.push_back(tile);
+                    total_length += path.size();
+                }
+            }
+            if (ends.empty())
+            {
+                continue;
+            }
+
+            run("Level::getPathToTile", "path tile", size, total_length / ends.size(), [&](std::uint64_t iterations)
+            {
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    level.getPathToTile(ends[i % ends.size()], path);
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + path.size();
+                return getNanoseconds(start, end);
+            });
+        }
+    }
+
+    /**
+    * This function times the line of sight checks enemies make to the player. The lines
+    * are between tiles up to 10 tiles apart, which is about how far apart they are in game.
+    */
+    void benchmarkLineOfSight(const std::vector<int>& sizes)
+    {
+        for (int size : sizes)
+        {
+            std::mt19937 random(SEED);
+            Level level;
+            level.setLayout(makeLayout(generateLevel(size, random)));
+
+            std::vector<std::pair<SDL_Point, SDL_Point>> lines;
+            std::uniform_int_distribution<int> offset(-10, 10);
+            for (const auto& tile : getWalkableTiles(level.getLayout()->grid, 256, random))
+            {
+                SDL_Point from = {(tile.x * Level::TILE_SIZE) + (Level::TILE_SIZE / 2), (tile.y * Level::TILE_SIZE) + (Level::TILE_SIZE / 2)};
+                SDL_Point to = {from.x + (offset(random) * Level::TILE_SIZE), from.y + (offset(random) * Level::TILE_SIZE)};
+                lines.push_back({from, to});
+            }
+
+            run("Level::hasLineOfSight", "wall", size, level.getWallRects().size(), [&](std::uint64_t iterations)
+            {
+                int visible = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    const auto& line = lines[i % lines.size()];
+                    visible += level.hasLineOfSight(line.first, line.second);
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + visible;
+                return getNanoseconds(start, end);
+            });
+        }
+    }
+
+    /**
+    * This function times moving a rect out of the solids it has walked into, the way the
+    * player and enemies do every frame.
+    */
+    void benchmarkCollisions(const std::vector<int>& solid_counts)
+    {
+        for (int solid_count : solid_counts)
+        {
+            std::mt19937 random(SEED);
+            std::uniform_int_distribution<int> position(0, 4096);
+            std::uniform_int_distribution<int> length(10, 200);
+
+            std::vector<SDL_Rect> solids;
+            for (int i = 0; i < solid_count; i++)
+            {
+                solids.push_back({position(random), position(random), length(random), length(random)});
+            }
+
+            std::vector<SDL_Rect> rects;
+            for (int i = 0; i < 256; i++)
+            {
+                rects.push_back({position(random), position(random), 40, 40});
+            }
+
+            run("Tools::resolveCollisions", "solid", solid_count, solid_count, [&](std::uint64_t iterations)
+            {
+                std::int64_t total = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    SDL_Rect rect = rects[i % rects.size()];
+                    Tools::resolveCollisionsX(rect, 1.0, solids.data(), solids.size());
+                    Tools::resolveCollisionsY(rect, -1.0, solids.data(), solids.size());
+                    total += rect.x + rect.y;
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + total;
+                return getNanoseconds(start, end);
+            });
+        }
+    }
+
+    /**
+    * This function times removing every projectile that has hit a wall. The projectiles
+    * are spread over the level, so about as many are in walls as there are walls.
+    */
+    void benchmarkProjectileRemoval(const std::vector<int>& projectile_counts)
+    {
+        for (int projectile_count : projectile_counts)
+        {
+            std::mt19937 random(SEED);
+            Level level;
+            level.setLayout(makeLayout(generateLevel(64, random)));
+
+            std::uniform_int_distribution<int> position(0, (64 * Level::TILE_SIZE) - 1);
+            ProjectileVector all_projectiles;
+            for (int i = 0; i < projectile_count; i++)
+            {
+                all_projectiles.emplace_back(Projectile::State{nullptr, {position(random), position(random), 8, 8}, {0.0, 0.0}, 20, 1000});
+            }
+
+            ProjectileVector projectiles;
+            projectiles.reserve(all_projectiles.size());
+            run("Level::removeProjectilesInWalls", "projectile", projectile_count, projectile_count, [&](std::uint64_t iterations)
+            {
+                // The projectiles have to be put back every time, which isn't timed.
+                double elapsed = 0.0;
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    projectiles.assign(all_projectiles.begin(), all_projectiles.end());
+                    auto start = std::chrono::steady_clock::now();
+                    level.removeProjectilesInWalls(projectiles);
+                    auto end = std::chrono::steady_clock::now();
+                    elapsed += getNanoseconds(start, end);
+                }
+                sink = sink + projectiles.size();
+                return elapsed;
+            });
+        }
+    }
+
+    /**
+    * This function times splitting a layer of a level into rows.
+    */
+    void benchmarkSplitString(const std::vector<int>& sizes)
+    {
+        for (int size : sizes)
+        {
+            std::mt19937 random(SEED);
+            const LevelFile::Data data = generateLevel(size, random);
+
+            std::string layer;
+            for (int y = 0; y < size; y++)
+            {
+                layer.append(data.getLayer(0) + (y * size), size);
+                layer += '\n';
+            }
+
+            run("Tools::splitString", "character", size, layer.size(), [&](std::uint64_t iterations)
+            {
+                std::size_t rows = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    rows += Tools::splitString(layer, '\n').size();
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + rows;
+                return getNanoseconds(start, end);
+            });
+        }
+    }
+
+    /**
+    * This function times the vector maths used to move enemies and projectiles, one
+    * vector at a time and in batches of each size.
+    */
+    void benchmarkMaths(const std::vector<int>& batch_sizes)
+    {
+        std::mt19937 random(SEED);
+        std::uniform_int_distribution<int> position(-1000, 1000);
+
+        std::vector<Maths::Vec2> points;
+        for (int i = 0; i < 1024; i++)
+        {
+            points.push_back({static_cast<float>(position(random)), static_cast<float>(position(random))});
+        }
+
+        run("Maths::normalize", "vector", 1, 1, [&](std::uint64_t iterations)
+        {
+            float total = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                Maths::Vec2 normal = Maths::normalize(points[i % points.size()]);
+                total += normal.x + normal.y;
+            }
+            auto end = std::chrono::steady_clock::now();
+            sink = sink + static_cast<std::int64_t>(total);
+            return getNanoseconds(start, end);
+        });
+
+        run("Maths::getDirection", "vector", 1, 1, [&](std::uint64_t iterations)
+        {
+            float total = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                Maths::Vec2 direction = Maths::getDirection(points[i % points.size()], points[(i + 1) % points.size()]);
+                total += direction.x + direction.y;
+            }
+            auto end = std::chrono::steady_clock::now();
+            sink = sink + static_cast<std::int64_t>(total);
+            return getNanoseconds(start, end);
+        });
+
+        run("Maths::getAngle", "angle", 1, 1, [&](std::uint64_t iterations)
+        {
+            float total = 0.0;
+            auto start = std::chrono::steady_clock::now();
+            for (std::uint64_t i = 0; i < iterations; i++)
+            {
+                total += Maths::getAngle(points[i % points.size()]);
+            }
+            auto end = std::chrono::steady_clock::now();
+            sink = sink + static_cast<std::int64_t>(total);
+            return getNanoseconds(start, end);
+        });
+
+        for (int batch_size : batch_sizes)
+        {
+            std::vector<Maths::Vec2> vectors(batch_size);
+            std::vector<Maths::Vec2> directions(batch_size);
+
+            run("Maths::normalize (batch)", "vector", batch_size, batch_size, [&](std::uint64_t iterations)
+            {
+                float total = 0.0;
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    std::copy(points.begin(), points.begin() + batch_size, vectors.begin());
+                    Maths::normalize(vectors.data(), vectors.size());
+                    total += vectors[i % vectors.size()].x;
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + static_cast<std::int64_t>(total);
+                return getNanoseconds(start, end);
+            });
+
+            run("Maths::getDirections", "vector", batch_size, batch_size, [&](std::uint64_t iterations)
+            {
+                float total = 0.0;
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    Maths::getDirections(points.data(), points.data() + 1, directions.data(), directions.size());
+                    total += directions[i % directions.size()].x;
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + static_cast<std::int64_t>(total);
+                return getNanoseconds(start, end);
+            });
+        }
+    }
+
+    /**
+    * This function times drawing a volley of random numbers, such as the spread of every
+    * pellet fired by the shotgun, one at a time and all together.
+    */
+    void benchmarkRandom(const std::vector<int>& volley_sizes)
+    {
+        for (int volley_size : volley_sizes)
+        {
+            Random::Generator generator(SEED);
+            std::vector<int> values(volley_size);
+
+            run("Random::Generator::getInt", "number", volley_size, volley_size, [&](std::uint64_t iterations)
+            {
+                std::int64_t total = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    for (int j = 0; j < volley_size; j++)
+                    {
+                        total += generator.getInt(-25, 25);
+                    }
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + total;
+                return getNanoseconds(start, end);
+            });
+
+            run("Random::Generator::getInts", "number", volley_size, volley_size, [&](std::uint64_t iterations)
+            {
+                std::int64_t total = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (std::uint64_t i = 0; i < iterations; i++)
+                {
+                    generator.getInts(values.data(), values.size(), -25, 25);
+                    total += values[i % values.size()];
+                }
+                auto end = std::chrono::steady_clock::now();
+                sink = sink + total;
+                return getNanoseconds(start, end);
+            });
+        }
+    }
+
+    /**
+    * This function writes every result as JSON.
+    */
+    void writeResults(std::ostream& out)
+    {
+        out << "{\n  \"seed\": " << SEED << ",\n  \"min_time_s\": " << min_time << ",\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i < benchmarks.size(); i++)
+        {
+            const Benchmark& benchmark = benchmarks[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {\"name\": \"" << benchmark.name << "\", \"item\": \"" << benchmark.item << "\", \"results\": [";
+            for (std::size_t j = 0; j < benchmark.results.size(); j++)
+            {
+                const Result& result = benchmark.results[j];
+                out << (j == 0 ? "\n" : ",\n");
+                out << "      {\"size\": " << result.size << ", \"iterations\": " << result.iterations
+                    << ", \"ns_per_op\": " << result.ns_per_op << ", \"ns_per_item\": " << result.ns_per_item << "}";
+            }
+            out << "\n    ]}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string output_file;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            min_time = std::atof(argv[++i]);
+        }
+        else
+        {
+            output_file = argv[i];
+        }
+    }
+
+    benchmarkBreadthFirstSearch({32, 64, 128, 256, 512, 1024});
+    benchmarkGetPathToTile({32, 64, 128, 256, 512, 1024});
+    benchmarkLineOfSight({16, 32, 64, 128, 256});
+    benchmarkCollisions({16, 64, 256, 1024, 4096});
+    benchmarkProjectileRemoval({64, 256, 1024, 4096});
+    benchmarkSplitString({32, 128, 512, 2048});
+    benchmarkMaths({8, 64, 1023});
+    benchmarkRandom({1, 5, 64});
+
+    if (output_file.empty())
+    {
+        writeResults(std::cout);
+        return 0;
+    }
+
+    std::ofstream file(output_file);
+    if (!file)
+    {
+        std::cerr << "Unable to write " << output_file << std::endl;
+        return 1;
+    }
+    writeResults(file);
+    return 0;
+}
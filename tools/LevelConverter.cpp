@@ -0,0 +1,46 @@
+#include "LevelFile.h"
+
+/**
+* This tool compiles a hand-written ".lvl" file into the binary ".lvlb" format.
+*
+* Usage: LevelConverter <input.lvl> [output.lvlb]
+*
+* If no output file is given, the output is written next to the input with the
+* extension changed to ".lvlb".
+*/
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input.lvl> [output.lvlb]" << std::endl;
+        return 1;
+    }
+
+    std::string input_file = argv[1];
+    std::string output_file;
+    if (argc > 2)
+    {
+        output_file = argv[2];
+    }
+    else
+    {
+        output_file = input_file.substr(0, input_file.find_last_of('.')) + LevelFile::BINARY_EXTENSION;
+    }
+
+    try
+    {
+        LevelFile::Data data;
+        LevelFile::loadText(input_file, data);
+        LevelFile::writeBinary(output_file, data);
+
+        std::cout << input_file << " -> " << output_file << " (" << data.width << "x" << data.height << ", "
+                  << data.layer_count << " layers, " << data.objects.size() << " objects)" << std::endl;
+    }
+    catch (const Application::Error& error)
+    {
+        std::cerr << "Unable to convert " << input_file << ": " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+#include "LevelCook.h"
+
+#include <algorithm>
+
+/**
+* This tool cooks a level. It works out the collision and navigation data for the
+* level ahead of time and writes it to a sidecar file next to the level, which the
+* game uses instead of working it out while loading. It also checks that everything
+* in the level can be reached from the player's start.
+*
+* Usage: LevelCooker <level.lvl|level.lvlb> [output.lvlc]
+*/
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <level.lvl|level.lvlb> [output.lvlc]" << std::endl;
+        return 1;
+    }
+
+    std::string input_file = argv[1];
+    std::string output_file = argc > 2 ? argv[2] : LevelCook::getSidecarName(input_file);
+
+    try
+    {
+        LevelFile::Data level;
+        LevelFile::load(input_file, level);
+
+        LevelCook::Data cooked;
+        LevelCook::cook(level, cooked);
+
+        // Don't write anything for a level that can't be played.
+        std::vector<std::string> problems = LevelCook::validate(level, cooked);
+        if (!problems.empty())
+        {
+            for (const auto& problem : problems)
+            {
+                std::cerr << input_file << ": " << problem << std::endl;
+            }
+            return 1;
+        }
+
+        LevelCook::write(output_file, cooked);
+
+        std::cout << input_file << " -> " << output_file << " (" << cooked.walls.size() << " walls, "
+                  << std::count(cooked.start_directions.begin(), cooked.start_directions.end(), LevelCook::UNREACHABLE)
+                  << " unreachable tiles)" << std::endl;
+    }
+    catch (const Application::Error& error)
+    {
+        std::cerr << "Unable to cook " << input_file << ": " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
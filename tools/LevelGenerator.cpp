@@ -0,0 +1,135 @@
+#include "LevelGenerator.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+* This tool generates a level for stress testing. The same options and seed always make
+* exactly the same level.
+*
+* Usage: LevelGenerator <output.lvl|output.lvlb> [options]
+*
+* Options:
+*   --size <width>x<height>   The size of the level in tiles, up to 4096x4096 (default 64x64).
+*   --seed <number>           The seed the level is generated from (default 12345).
+*   --walls <density>         The chance of a tile in a room being a wall (default 0.1).
+*   --rooms <count>           The number of rooms, or 0 for one open room (default 0).
+*   --room-size <min>-<max>   The smallest and largest rooms (default 6-16).
+*   --corridor-width <tiles>  The width of the corridors between rooms (default 2).
+*   --zombies <count>         The number of each enemy (default 0).
+*   --demons <count>
+*   --hounds <count>
+*   --bosses <count>
+*   --pickups <density>       The chance of a tile having a pickup on it (default 0).
+*   --title <title>           The title of the level.
+*/
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <output.lvl|output.lvlb> [--size WxH] [--seed N] [--walls D] [--rooms N] "
+                  << "[--room-size MIN-MAX] [--corridor-width N] [--zombies N] [--demons N] [--hounds N] [--bosses N] "
+                  << "[--pickups D] [--title T]" << std::endl;
+        return 1;
+    }
+
+    std::string output_file = argv[1];
+    LevelGenerator::Settings settings;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Missing value for " << argv[i] << std::endl;
+            return 1;
+        }
+
+        const char* option = argv[i];
+        const char* value = argv[++i];
+        if (std::strcmp(option, "--size") == 0)
+        {
+            if (std::sscanf(value, "%dx%d", &settings.width, &settings.height) != 2)
+            {
+                std::cerr << "Sizes are written as <width>x<height>: " << value << std::endl;
+                return 1;
+            }
+        }
+        else if (std::strcmp(option, "--seed") == 0)
+        {
+            settings.seed = std::strtoul(value, nullptr, 10);
+        }
+        else if (std::strcmp(option, "--walls") == 0)
+        {
+            settings.wall_density = std::atof(value);
+        }
+        else if (std::strcmp(option, "--rooms") == 0)
+        {
+            settings.room_count = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--room-size") == 0)
+        {
+            if (std::sscanf(value, "%d-%d", &settings.min_room_size, &settings.max_room_size) != 2)
+            {
+                std::cerr << "Room sizes are written as <min>-<max>: " << value << std::endl;
+                return 1;
+            }
+        }
+        else if (std::strcmp(option, "--corridor-width") == 0)
+        {
+            settings.corridor_width = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--zombies") == 0)
+        {
+            settings.zombies = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--demons") == 0)
+        {
+            settings.demons = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--hounds") == 0)
+        {
+            settings.hounds = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--bosses") == 0)
+        {
+            settings.bosses = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--pickups") == 0)
+        {
+            settings.pickup_density = std::atof(value);
+        }
+        else if (std::strcmp(option, "--title") == 0)
+        {
+            settings.title = value;
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << option << std::endl;
+            return 1;
+        }
+    }
+
+    try
+    {
+        LevelFile::Data data;
+        LevelGenerator::generate(settings, data);
+        if (LevelFile::isBinary(output_file))
+        {
+            LevelFile::writeBinary(output_file, data);
+        }
+        else
+        {
+            LevelFile::writeText(output_file, data);
+        }
+
+        std::cout << output_file << " (" << data.width << "x" << data.height << ", seed " << settings.seed << ", "
+                  << data.objects.size() << " objects)" << std::endl;
+    }
+    catch (const Application::Error& error)
+    {
+        std::cerr << "Unable to generate " << output_file << ": " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include "Application.h"
+#include "RenderSnapshot.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+/**
+* This tool draws a render snapshot written by the game (press F12 while playing) over and
+* over and times it, so that changes to how frames are drawn can be measured without
+* playing the game. The snapshot is drawn with its commands in the order they were
+* recorded, then sorted into batches, and then sorted with rotated sprites drawn from a
+* rotation cache instead of SDL_RenderCopyEx. The time per frame and the statistics for
+* each are written as JSON.
+*
+* Usage: RenderBenchmark <frame.rcmd> [output.json] [--frames count] [--rotations count] [--software]
+*
+* --rotations sets how many angles the rotation cache uses (64 by default, 0 to skip it)
+* and --software uses SDL's software renderer, as machines without a GPU would.
+*
+* It has to be run from the game's folder, so that the textures the snapshot uses can be
+* loaded. Textures that weren't loaded from a file, like the map and the glyph atlases,
+* are replaced with blank ones of the same size.
+*/
+namespace
+{
+    const int WARM_UP_FRAMES = 10;
+
+    int frame_count = 500;
+    int rotation_count = 64;
+
+    /**
+    * This struct is the result of drawing the snapshot in one order.
+    */
+    struct Result
+    {
+        std::string order;
+        int rotations;
+        RenderSnapshot::Statistics statistics;
+        double mean_ms;
+        double p50_ms;
+        double p95_ms;
+        double max_ms;
+    };
+
+    std::vector<SDL_Texture*> blank_textures;
+
+    /**
+    * This function returns the sprite id for a texture in the snapshot, loading it if it
+    * has a file or making a blank texture of the same size if it doesn't.
+    */
+    std::uint16_t getSprite(const std::string& name, const int width, const int height)
+    {
+        if (!name.empty() && std::ifstream(name))
+        {
+            return Application::getSpriteId(Application::getTexture(name));
+        }
+
+        SDL_Renderer* renderer = Application::getRenderer();
+        SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                                 std::max(width, 1), std::max(height, 1));
+        if (texture == nullptr)
+        {
+            std::cerr << "Unable to make a " << width << "x" << height << " texture for " << (name.empty() ? "an unnamed sprite" : name)
+                      << ": " << SDL_GetError() << std::endl;
+            return RenderSnapshot::NO_SPRITE;
+        }
+        SDL_SetRenderTarget(renderer, texture);
+        SDL_SetRenderDrawColor(renderer, 96, 96, 96, 255);
+        SDL_RenderClear(renderer);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+        SDL_SetRenderTarget(renderer, nullptr);
+
+        blank_textures.push_back(texture);
+        return Application::addSprite(texture);
+    }
+
+    /**
+    * This function draws the snapshot frame_count times in one order and times each frame,
+    * from clearing the screen to presenting it. The rotation cache is filled while the
+    * frames are warming up, so making it isn't timed.
+    */
+    Result run(RenderSnapshot& snapshot, const bool batch, RotationCache* rotation_cache)
+    {
+        SDL_Renderer* renderer = Application::getRenderer();
+        snapshot.sort(batch);
+
+        std::vector<double> frame_times;
+        frame_times.reserve(frame_count);
+        for (int i = 0; i < WARM_UP_FRAMES + frame_count; i++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            SDL_RenderClear(renderer);
+            snapshot.submit(renderer, rotation_cache);
+            SDL_RenderPresent(renderer);
+            auto end = std::chrono::steady_clock::now();
+
+            // Keep the window responsive while the frames are drawn.
+            SDL_Event event;
+            while (SDL_PollEvent(&event))
+            {
+            }
+
+            if (i >= WARM_UP_FRAMES)
+            {
+                frame_times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+        }
+
+        Result result;
+        result.order = batch ? "batched" : "recorded";
+        result.rotations = rotation_cache != nullptr ? rotation_count : 0;
+        result.statistics = snapshot.getStatistics();
+        std::sort(frame_times.begin(), frame_times.end());
+        double total = 0.0;
+        for (double frame_time : frame_times)
+        {
+            total += frame_time;
+        }
+        result.mean_ms = total / frame_times.size();
+        result.p50_ms = frame_times[(frame_times.size() - 1) / 2];
+        result.p95_ms = frame_times[(frame_times.size() - 1) * 95 / 100];
+        result.max_ms = frame_times.back();
+
+        std::cerr << result.order << (rotation_cache != nullptr ? ", pre-rotated" : "") << ": " << result.statistics.commands << " commands in " << result.statistics.batches
+                  << " batches, " << result.mean_ms << " ms mean, " << result.p95_ms << " ms p95" << std::endl;
+        return result;
+    }
+
+    /**
+    * This function writes every result as JSON.
+    */
+    void writeResults(std::ostream& out, const std::string& file_name, const RenderSnapshot& snapshot, const std::vector<Result>& results)
+    {
+        const RenderSnapshot::Statistics& statistics = snapshot.getStatistics();
+        out << "{\n  \"file\": \"" << file_name << "\",\n  \"tick\": " << snapshot.getTick() << ",\n  \"frames\": " << frame_count
+            << ",\n  \"commands\": " << statistics.commands << ",\n  \"culled\": " << statistics.culled << ",\n  \"layers\": {";
+        for (int i = 0; i < static_cast<int>(RenderSnapshot::Layer::Count); i++)
+        {
+            out << (i == 0 ? "" : ", ") << "\"" << RenderSnapshot::getLayerName(static_cast<RenderSnapshot::Layer>(i)) << "\": "
+                << statistics.layer_commands[i];
+        }
+        out << "},\n  \"results\": [";
+        for (std::size_t i = 0; i < results.size(); i++)
+        {
+            const Result& result = results[i];
+            out << (i == 0 ? "\n" : ",\n");
+            out << "    {\"order\": \"" << result.order << "\", \"rotations\": " << result.rotations
+                << ", \"batches\": " << result.statistics.batches
+                << ", \"mean_ms\": " << result.mean_ms << ", \"p50_ms\": " << result.p50_ms << ", \"p95_ms\": " << result.p95_ms
+                << ", \"max_ms\": " << result.max_ms << "}";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string snapshot_file;
+    std::string output_file;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            frame_count = std::max(std::atoi(argv[++i]), 1);
+        }
+        else if (std::strcmp(argv[i], "--rotations") == 0 && i + 1 < argc)
+        {
+            rotation_count = std::max(std::atoi(argv[++i]), 0);
+        }
+        else if (std::strcmp(argv[i], "--software") == 0)
+        {
+            SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
+        }
+        else if (snapshot_file.empty())
+        {
+            snapshot_file = argv[i];
+        }
+        else
+        {
+            output_file = argv[i];
+        }
+    }
+
+    if (snapshot_file.empty())
+    {
+        std::cerr << "Usage: RenderBenchmark <frame.rcmd> [output.json] [--frames count] [--rotations count] [--software]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results;
+    RenderSnapshot snapshot;
+    try
+    {
+        // The window starts small and is made the size of the snapshot's viewport once the
+        // snapshot has been read, since reading it needs the renderer.
+        Application::startUp("Render Benchmark", 640, 480, 0, false);
+        if (!snapshot.read(snapshot_file, getSprite))
+        {
+            std::cerr << "Unable to read a render snapshot from " << snapshot_file << std::endl;
+            Application::shutDown();
+            return 1;
+        }
+        SDL_SetWindowSize(Application::getWindow(), std::max(snapshot.getViewport().w, 1), std::max(snapshot.getViewport().h, 1));
+
+        results.push_back(run(snapshot, false, nullptr));
+        results.push_back(run(snapshot, true, nullptr));
+        if (rotation_count > 0)
+        {
+            RotationCache rotation_cache(rotation_count);
+            results.push_back(run(snapshot, true, &rotation_cache));
+        }
+
+        for (SDL_Texture* texture : blank_textures)
+        {
+            Application::removeSprite(texture);
+            SDL_DestroyTexture(texture);
+        }
+        Application::shutDown();
+    }
+    catch (const Application::Error&)
+    {
+        std::cerr << "Error: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    if (output_file.empty())
+    {
+        writeResults(std::cout, snapshot_file, snapshot, results);
+        return 0;
+    }
+
+    std::ofstream file(output_file);
+    if (!file)
+    {
+        std::cerr << "Unable to write " << output_file << std::endl;
+        return 1;
+    }
+    writeResults(file, snapshot_file, snapshot, results);
+    return 0;
+}